@@ -148,6 +148,7 @@ PApplication::~PApplication()
 
 void PApplication::Init()
 {
+	InitServices();
 	if (!_KeyBindMgr)
 	{
 		_KeyBindMgr.reset(new PGlobalKeyBindManager());
@@ -165,14 +166,6 @@ void PApplication::Init()
 			HandleChatKeyBind<PMessageHandler::Passives>);
 		_KeyBindMgr->RestoreKeyBinds();
 	}
-	if (!_NetManager) _NetManager = new QNetworkAccessManager(this);
-	if (!_JSEngine)
-	{
-		_JSEngine = new QQmlEngine(this);
-		_JSEngine->globalObject().setProperty("application", _JSEngine->newQObject(this));
-	}
-	if (!_MessageHandler)_MessageHandler = new PMessageHandler(this);
-	if (!_MessageModel) _MessageModel = new PMessageModel(this); // This must happen after _LogScanner
 	if (!_MainWindow)
 	{
 		_MainWindow = new PMainWindow();
@@ -182,7 +175,23 @@ void PApplication::Init()
 	{
 		_OverlayController = new POverlayController(this);
 		_OverlayController->Initialize();
+		// Key binds limited to the game follow the overlay, which is up while the game is focused.
+		connect(_OverlayController, &POverlayController::GameActiveChanged, _KeyBindMgr.data(), 
+			&PGlobalKeyBindManager::SetGameFocused);
+		_KeyBindMgr->SetGameFocused(_OverlayController->IsGameActive());
 	}
+}
+
+void PApplication::InitServices()
+{
+	if (!_NetManager) _NetManager = new QNetworkAccessManager(this);
+	if (!_JSEngine)
+	{
+		_JSEngine = new QQmlEngine(this);
+		_JSEngine->globalObject().setProperty("application", _JSEngine->newQObject(this));
+	}
+	if (!_MessageHandler)_MessageHandler = new PMessageHandler(this);
+	if (!_MessageModel) _MessageModel = new PMessageModel(this); // This must happen after _LogScanner
 	qRegisterMetaType<PMessage::Channel>("PLogMessage::Channel");
 	qRegisterMetaType<PMessage::Channels>("PLogMessage::Channels");
 	QMetaType::registerConverter<PMessage::Channel, QJSValue>(ChannelsToValue);
@@ -68,10 +68,17 @@ public:
 	~PApplication();
 
 	/**
-	 * Initializes the application.
+	 * Initializes the application. This creates the services through InitServices, the key binds, the main
+	 * window and the overlay.
 	 */
 	void Init();
 
+	/**
+	 * Creates the services that the widgets rely on without creating any of the user interface. Init calls this
+	 * first, and tests call it alone so widgets can be created without the main window or global key binds.
+	 */
+	void InitServices();
+
 	/**
 	 * Retrieves the message handler.
 	 * @return
@@ -46,6 +46,11 @@ void PChatDockWidget::LoadState(const QSettings& settings)
 		_ChatWidget->SetChannels(channels);
 		setWindowTitle(settings.value(QStringLiteral("Title")).toString());
 	}
+	_ChatWidget->SetCollapseRepeats(settings.value(QStringLiteral("CollapseRepeats"), false).toBool());
+	_ChatWidget->SetRepeatWindow(settings.value(QStringLiteral("RepeatWindow"), 60).toInt());
+	_ChatWidget->SetFilter(settings.value(QStringLiteral("Filter")).toString());
+	_ChatWidget->SetScrollback(settings.value(QStringLiteral("Scrollback"), 1000).toInt());
+	_ChatWidget->SetWhisperViewLimit(settings.value(QStringLiteral("WhisperViewLimit"), 20).toInt());
 }
 
 void PChatDockWidget::SaveState(QSettings& settings) const
@@ -55,6 +60,11 @@ void PChatDockWidget::SaveState(QSettings& settings) const
 		settings.setValue(QStringLiteral("Title"), windowTitle());
 		settings.setValue(QStringLiteral("Channels"), static_cast<int>(_ChatWidget->GetChannels()));
 	}
+	settings.setValue(QStringLiteral("CollapseRepeats"), _ChatWidget->IsCollapsingRepeats());
+	settings.setValue(QStringLiteral("RepeatWindow"), _ChatWidget->GetRepeatWindow());
+	settings.setValue(QStringLiteral("Filter"), _ChatWidget->GetFilter());
+	settings.setValue(QStringLiteral("Scrollback"), _ChatWidget->GetScrollback());
+	settings.setValue(QStringLiteral("WhisperViewLimit"), _ChatWidget->GetWhisperViewLimit());
 }
 
 void PChatDockWidget::Configure()
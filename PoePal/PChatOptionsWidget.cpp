@@ -56,6 +56,11 @@ void PChatOptionsWidget::SetWidget(PChatDockWidget *widget)
 	ui._GuildCheck->setChecked(channels.testFlag(PMessage::Guild));
 	ui._PartyCheck->setChecked(channels.testFlag(PMessage::Party));
 	ui._LocalCheck->setChecked(channels.testFlag(PMessage::Local));
+	ui._CollapseCheck->setChecked(chatWidget->IsCollapsingRepeats());
+	ui._RepeatWindowSpin->setValue(chatWidget->GetRepeatWindow());
+	ui._FilterEdit->setText(chatWidget->GetFilter());
+	ui._ScrollbackSpin->setValue(chatWidget->GetScrollback());
+	ui._WhisperViewSpin->setValue(chatWidget->GetWhisperViewLimit());
 }
 
 void PChatOptionsWidget::SaveToWidget()
@@ -75,6 +80,11 @@ void PChatOptionsWidget::SaveToWidget()
 	if (ui._LocalCheck->isChecked()) channels.setFlag(PMessage::Local);
 	if (ui._WhisperCheck->isChecked()) channels.setFlag(PMessage::Whisper);
 	chatWidget->SetChannels(channels);
+	chatWidget->SetRepeatWindow(ui._RepeatWindowSpin->value());
+	chatWidget->SetCollapseRepeats(ui._CollapseCheck->isChecked());
+	chatWidget->SetFilter(ui._FilterEdit->text());
+	chatWidget->SetScrollback(ui._ScrollbackSpin->value());
+	chatWidget->SetWhisperViewLimit(ui._WhisperViewSpin->value());
 }
 
 void PChatOptionsWidget::SetChannelViewMode(PMessage::Channel channel, QCheckBox *check, 
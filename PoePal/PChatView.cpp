@@ -0,0 +1,676 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PChatView.h"
+#include "PMessage.h"
+#include <QApplication>
+#include <QClipboard>
+#include <QKeyEvent>
+#include <QPainter>
+#include <QPointer>
+#include <QScrollBar>
+#include <QStringBuilder>
+#include <QTextCharFormat>
+#include <QWheelEvent>
+#include <QtMath>
+#include <algorithm>
+
+namespace
+{
+	/**
+	 * The space around the rows, in pixels.
+	 */
+	const int _Margin = 4;
+
+	/**
+	 * The maximum number of row layouts kept in the cache.
+	 */
+	const int _LayoutCacheSize = 256;
+
+	/**
+	 * The maximum number of rendered messages shared between the views.
+	 */
+	const int _RenderCacheSize = 4096;
+
+	/**
+	 * The maximum number of timestamp strings kept, one per minute.
+	 */
+	const int _TimestampCacheSize = 1440;
+
+	/**
+	 * How the sender of a chat message is shown for a channel and direction.
+	 */
+	struct ChannelFormat
+	{
+		/**
+		 * The text put before the sender, the channel prefix and whisper direction.
+		 */
+		QString _Prefix;
+
+		/**
+		 * The format of the prefix and sender.
+		 */
+		QTextCharFormat _SenderFormat;
+	};
+
+	/**
+	 * A message rendered to text and formats, shared by every view showing it.
+	 */
+	struct RenderedMessage
+	{
+		/**
+		 * The message that was rendered. This is cleared if the message is deleted, so a message allocated in
+		 * its place isn't shown with its text.
+		 */
+		QPointer<PMessage> _Message;
+
+		/**
+		 * The text of the message.
+		 */
+		QString _Text;
+
+		/**
+		 * The formats applied to the text.
+		 */
+		QVector<QTextLayout::FormatRange> _Formats;
+	};
+
+	/**
+	 * Retrieves how the sender of a chat message is shown.
+	 * The table is built once, so rendering a message doesn't need to look up colors or translations.
+	 * @param[in] channel
+	 *   The channel of the message.
+	 * @param[in] incoming
+	 *   true if the message was received, false if it was sent.
+	 * @return
+	 *   The format for the channel and direction.
+	 */
+	const ChannelFormat & GetChannelFormat(PMessage::Channel channel, bool incoming)
+	{
+		static QHash<QPair<PMessage::Channel, bool>, ChannelFormat> formats;
+		if (formats.isEmpty())
+		{
+			QHash<PMessage::Channel, QColor> colors{
+				{PMessage::Global, QColor("firebrick")},
+				{PMessage::Trade, QColor("goldenrod")},
+				{PMessage::Guild, QColor("gray")},
+				{PMessage::Party, QColor("cyan")},
+				{PMessage::Local, QColor("limegreen")},
+				{PMessage::Whisper, QColor("mediumpurple")}
+			};
+			auto channels = PMessage::GetChannels();
+			channels.append(PMessage::InvalidChannel);
+			for (const auto &ch : channels)
+			{
+				for (auto in : {true, false})
+				{
+					ChannelFormat format;
+					auto prefix = PMessage::GetPrefixFromChannel(ch);
+					if (ch != PMessage::InvalidChannel && !prefix.isNull()) format._Prefix += prefix;
+					if (ch == PMessage::Whisper) format._Prefix += in ? PChatView::tr("From ") : PChatView::tr("To ");
+					format._SenderFormat.setFontWeight(QFont::Bold);
+					// Without a color, the sender is drawn in the text color of the view.
+					if (colors.contains(ch)) format._SenderFormat.setForeground(colors.value(ch));
+					formats.insert(qMakePair(ch, in), format);
+				}
+			}
+		}
+		return formats[qMakePair(channel, incoming)];
+	}
+
+	/**
+	 * Retrieves the timestamp shown for a time.
+	 * Timestamps only show the minute, so they are formatted once per minute.
+	 * @param[in] time
+	 *   The time.
+	 * @return
+	 *   The timestamp text.
+	 */
+	QString GetTimestamp(const QDateTime &time)
+	{
+		static QCache<qint64, QString> timestamps(_TimestampCacheSize);
+		auto minute = time.toMSecsSinceEpoch() / 60000;
+		auto timestamp = timestamps.object(minute);
+		if (timestamp) return *timestamp;
+		timestamp = new QString(time.toString("[hh:mm] "));
+		timestamps.insert(minute, timestamp);
+		return *timestamp;
+	}
+
+	/**
+	 * Renders a message to text and formats.
+	 * @param[in] message
+	 *   The message to render.
+	 * @param[out] rendered
+	 *   Receives the rendered message.
+	 */
+	void RenderMessage(PMessage *message, RenderedMessage &rendered)
+	{
+		if (message->GetSubtype() == PMessage::Chat)
+		{
+			const auto &format = GetChannelFormat(message->GetChannel(), message->IsIncoming());
+			rendered._Text = GetTimestamp(message->GetTime()) % format._Prefix % message->GetFullSender();
+			QTextLayout::FormatRange sender;
+			sender.start = 0;
+			sender.length = rendered._Text.length();
+			sender.format = format._SenderFormat;
+			rendered._Formats.append(sender);
+			rendered._Text += QStringLiteral(" : ");
+		}
+		rendered._Text += message->GetContents();
+	}
+
+	/**
+	 * Retrieves the messages rendered by any view, indexed by the message.
+	 * A message shown in several views is only rendered once. The messages are not indexed by their place in the
+	 * message store, since importing older messages moves them.
+	 */
+	QCache<const PMessage *, RenderedMessage> * GetRenderedMessages()
+	{
+		static QCache<const PMessage *, RenderedMessage> rendered(_RenderCacheSize);
+		return &rendered;
+	}
+}
+
+PChatView::PChatView(QWidget *parent /*= nullptr*/):
+QAbstractScrollArea(parent)
+{
+	_Layouts.setMaxCost(_LayoutCacheSize);
+	setFocusPolicy(Qt::StrongFocus);
+	setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+	viewport()->setCursor(Qt::IBeamCursor);
+	verticalScrollBar()->setSingleStep(1);
+	// Batches work out their own repaint once they end.
+	connect(verticalScrollBar(), &QScrollBar::valueChanged, this, [this]()
+	{
+		if (_BatchDepth == 0) viewport()->update();
+	});
+	connect(verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int value)
+	{
+		if (value == 0 && verticalScrollBar()->maximum() > 0 && _BatchDepth == 0) emit ScrolledToTop();
+	});
+}
+
+PChatView::~PChatView()
+{
+}
+
+int PChatView::AppendMessage(PMessage *message)
+{
+	Row row;
+	row._Message = message;
+	return AppendRow(row);
+}
+
+int PChatView::AppendMarker(const QString &text)
+{
+	Row row;
+	row._Text = text;
+	return AppendRow(row);
+}
+
+void PChatView::BeginBatch()
+{
+	if (_BatchDepth++ > 0) return;
+	_BatchWasAtBottom = IsAtBottom();
+	_BatchFirstRowId = _FirstRowId;
+	_BatchEndRowId = _FirstRowId + _Rows.length();
+}
+
+void PChatView::EndBatch()
+{
+	if (_BatchDepth <= 0 || --_BatchDepth > 0) return;
+	_BatchDepth++;
+	UpdateScrollBar();
+	// Follow new messages unless the user scrolled away or is selecting text.
+	bool follow = _BatchWasAtBottom && !HasSelection();
+	if (follow) ScrollToBottom();
+	_BatchDepth--;
+	int appended = _FirstRowId + _Rows.length() - _BatchEndRowId;
+	if (follow && _FirstRowId == _BatchFirstRowId && appended > 0)
+	{
+		int added = 0;
+		for (int idx = _Rows.length() - appended; idx < _Rows.length(); ++idx)
+		{
+			added += qCeil(GetLayout(idx)->boundingRect().height());
+		}
+		int height = viewport()->height();
+		if (added + _Margin < height)
+		{
+			// Rows are anchored to the bottom, so what is on screen only moves up. Shift those pixels and paint
+			// just the new rows rather than every visible row.
+			viewport()->scroll(0, -added);
+			viewport()->update(0, height - added - _Margin, viewport()->width(), added + _Margin);
+			return;
+		}
+	}
+	viewport()->update();
+}
+
+void PChatView::PrependMessages(const QVector<PMessage *> &messages)
+{
+	if (messages.isEmpty()) return;
+	auto wasAtBottom = IsAtBottom();
+	QVector<Row> rows(messages.length());
+	for (int m = 0; m < messages.length(); ++m) rows[m]._Message = messages.at(m);
+	rows.append(_Rows);
+	_Rows.swap(rows);
+	_FirstRowId -= messages.length();
+	// Until the next paint, hit testing goes by what is on screen, so the rows there keep their places.
+	for (auto &painted : _PaintedRows) painted.first += messages.length();
+	auto value = verticalScrollBar()->value();
+	_BatchDepth++;
+	UpdateScrollBar();
+	if (wasAtBottom) ScrollToBottom();
+	else verticalScrollBar()->setValue(value + messages.length());
+	_BatchDepth--;
+	viewport()->update();
+}
+
+void PChatView::RemoveFirstRows(int count)
+{
+	count = qMin(count, _Rows.length());
+	if (count <= 0) return;
+	auto wasAtBottom = IsAtBottom();
+	auto value = verticalScrollBar()->value();
+	// The IDs of removed rows are reused if older rows are prepended later, so their layouts must go.
+	for (int id = _FirstRowId; id < _FirstRowId + count; ++id) _Layouts.remove(id);
+	_Rows.remove(0, count);
+	_FirstRowId += count;
+	// Until the next paint, hit testing goes by what is on screen, so the rows there keep their places and the
+	// removed ones can no longer be hit.
+	for (auto iter = _PaintedRows.begin(); iter != _PaintedRows.end();)
+	{
+		iter->first -= count;
+		if (iter->first < 0) iter = _PaintedRows.erase(iter);
+		else ++iter;
+	}
+	auto hadSelection = HasSelection();
+	auto start = qMin(_SelectionAnchor, _SelectionPos);
+	auto end = qMax(_SelectionAnchor, _SelectionPos);
+	if (hadSelection && end._RowId < _FirstRowId) _SelectionAnchor = _SelectionPos = TextPosition();
+	else if (hadSelection && start._RowId < _FirstRowId)
+	{
+		start._RowId = _FirstRowId;
+		start._Pos = 0;
+		_SelectionAnchor = start;
+		_SelectionPos = end;
+	}
+	_BatchDepth++;
+	UpdateScrollBar();
+	if (wasAtBottom) ScrollToBottom();
+	else verticalScrollBar()->setValue(qMax(0, value - count));
+	_BatchDepth--;
+	viewport()->update();
+	if (hadSelection && !HasSelection()) emit CopyAvailable(false);
+}
+
+void PChatView::Clear()
+{
+	_FirstRowId += _Rows.length();
+	_Rows.clear();
+	_Layouts.clear();
+	_PaintedRows.clear();
+	auto hadSelection = HasSelection();
+	_SelectionAnchor = _SelectionPos = TextPosition();
+	UpdateScrollBar();
+	viewport()->update();
+	if (hadSelection) emit CopyAvailable(false);
+}
+
+PMessage * PChatView::GetFirstMessage() const
+{
+	for (const auto &row : _Rows)
+	{
+		if (row._Message) return row._Message;
+	}
+	return nullptr;
+}
+
+int PChatView::GetFirstRowId() const
+{
+	return _FirstRowId;
+}
+
+int PChatView::GetRowCount() const
+{
+	return _Rows.length();
+}
+
+bool PChatView::HasRow(int rowId) const
+{
+	return rowId >= _FirstRowId && rowId < _FirstRowId + _Rows.length();
+}
+
+void PChatView::SetRepeatCount(int rowId, int count)
+{
+	if (!HasRow(rowId)) return;
+	_Rows[rowId - _FirstRowId]._RepeatCount = count;
+	_Layouts.remove(rowId);
+	viewport()->update();
+}
+
+PMessage * PChatView::GetMessageAt(const QPoint &pos) const
+{
+	auto textPos = GetTextPositionAt(pos);
+	if (!HasRow(textPos._RowId)) return nullptr;
+	return _Rows.at(textPos._RowId - _FirstRowId)._Message;
+}
+
+bool PChatView::HasSelection() const
+{
+	return _SelectionAnchor._RowId >= 0 && (_SelectionAnchor._RowId != _SelectionPos._RowId || 
+		_SelectionAnchor._Pos != _SelectionPos._Pos);
+}
+
+QString PChatView::GetSelectedText() const
+{
+	if (!HasSelection()) return QString();
+	auto start = qMin(_SelectionAnchor, _SelectionPos);
+	auto end = qMax(_SelectionAnchor, _SelectionPos);
+	QStringList lines;
+	QString text;
+	QVector<QTextLayout::FormatRange> formats;
+	for (int id = qMax(start._RowId, _FirstRowId); id <= end._RowId && HasRow(id); ++id)
+	{
+		FormatRow(_Rows.at(id - _FirstRowId), text, formats);
+		int from = id == start._RowId ? start._Pos : 0;
+		int to = id == end._RowId ? end._Pos : text.length();
+		lines.append(text.mid(from, to - from));
+	}
+	return lines.join('\n');
+}
+
+bool PChatView::IsAtBottom() const
+{
+	return verticalScrollBar()->value() >= verticalScrollBar()->maximum();
+}
+
+void PChatView::Copy()
+{
+	if (HasSelection()) QApplication::clipboard()->setText(GetSelectedText());
+}
+
+void PChatView::SelectAll()
+{
+	if (_Rows.isEmpty()) return;
+	QString text;
+	QVector<QTextLayout::FormatRange> formats;
+	FormatRow(_Rows.last(), text, formats);
+	_SelectionAnchor._RowId = _FirstRowId;
+	_SelectionAnchor._Pos = 0;
+	_SelectionPos._RowId = _FirstRowId + _Rows.length() - 1;
+	_SelectionPos._Pos = text.length();
+	viewport()->update();
+	emit CopyAvailable(HasSelection());
+}
+
+void PChatView::ScrollToBottom()
+{
+	verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+}
+
+int PChatView::AppendRow(const Row &row)
+{
+	BeginBatch();
+	_Rows.append(row);
+	EndBatch();
+	return _FirstRowId + _Rows.length() - 1;
+}
+
+void PChatView::paintEvent(QPaintEvent *evt)
+{
+	QPainter painter(viewport());
+	_PaintedRows.clear();
+	if (_Rows.isEmpty()) return;
+	auto start = qMin(_SelectionAnchor, _SelectionPos);
+	auto end = qMax(_SelectionAnchor, _SelectionPos);
+	auto hasSelection = HasSelection();
+	auto clip = evt->rect();
+	auto paintRow = [&](int idx, QTextLayout *layout, int top)
+	{
+		// Rows outside the damaged area are still recorded for hit testing, but not drawn.
+		_PaintedRows.append(qMakePair(idx, top));
+		if (top > clip.bottom() || top + qCeil(layout->boundingRect().height()) < clip.top()) return;
+		QVector<QTextLayout::FormatRange> selections;
+		int rowId = _FirstRowId + idx;
+		if (hasSelection && rowId >= start._RowId && rowId <= end._RowId)
+		{
+			QTextLayout::FormatRange selection;
+			selection.start = rowId == start._RowId ? start._Pos : 0;
+			selection.length = (rowId == end._RowId ? end._Pos : layout->text().length()) - selection.start;
+			selection.format.setBackground(palette().highlight());
+			selection.format.setForeground(palette().highlightedText());
+			selections.append(selection);
+		}
+		painter.setPen(palette().text().color());
+		layout->draw(&painter, QPointF(_Margin, top), selections);
+	};
+	int height = viewport()->height();
+	if (IsAtBottom())
+	{
+		// Keep the last row at the bottom of the view, like a chat window.
+		int bottom = height - _Margin;
+		for (int idx = _Rows.length() - 1; idx >= 0 && bottom > 0; --idx)
+		{
+			auto layout = GetLayout(idx);
+			bottom -= qCeil(layout->boundingRect().height());
+			paintRow(idx, layout, bottom);
+		}
+		std::reverse(_PaintedRows.begin(), _PaintedRows.end());
+	}
+	else
+	{
+		int top = _Margin;
+		for (int idx = verticalScrollBar()->value(); idx < _Rows.length() && top < height; ++idx)
+		{
+			auto layout = GetLayout(idx);
+			paintRow(idx, layout, top);
+			top += qCeil(layout->boundingRect().height());
+		}
+	}
+}
+
+void PChatView::resizeEvent(QResizeEvent *evt)
+{
+	QAbstractScrollArea::resizeEvent(evt);
+	auto wasAtBottom = IsAtBottom();
+	UpdateScrollBar();
+	if (wasAtBottom) ScrollToBottom();
+}
+
+void PChatView::mousePressEvent(QMouseEvent *evt)
+{
+	if (evt->button() != Qt::LeftButton)
+	{
+		QAbstractScrollArea::mousePressEvent(evt);
+		return;
+	}
+	auto hadSelection = HasSelection();
+	_SelectionAnchor = _SelectionPos = GetTextPositionAt(evt->pos());
+	_Selecting = _SelectionAnchor._RowId >= 0;
+	if (_Selecting && !_Rows.at(_SelectionAnchor._RowId - _FirstRowId)._Message)
+	{
+		// Markers are clicked rather than selected.
+		auto rowId = _SelectionAnchor._RowId;
+		_SelectionAnchor = _SelectionPos = TextPosition();
+		_Selecting = false;
+		emit MarkerClicked(rowId);
+	}
+	viewport()->update();
+	if (hadSelection) emit CopyAvailable(false);
+}
+
+void PChatView::mouseMoveEvent(QMouseEvent *evt)
+{
+	if (!_Selecting) return;
+	auto pos = GetTextPositionAt(evt->pos());
+	if (pos._RowId < 0) return;
+	_SelectionPos = pos;
+	viewport()->update();
+}
+
+void PChatView::mouseReleaseEvent(QMouseEvent *evt)
+{
+	if (!_Selecting) return;
+	_Selecting = false;
+	emit CopyAvailable(HasSelection());
+}
+
+void PChatView::wheelEvent(QWheelEvent *evt)
+{
+	// When everything fits, or the view is already at the top, the scroll bar won't move, so ask for older
+	// messages directly.
+	if (evt->angleDelta().y() > 0 && verticalScrollBar()->value() == 0) emit ScrolledToTop();
+	QAbstractScrollArea::wheelEvent(evt);
+}
+
+void PChatView::keyPressEvent(QKeyEvent *evt)
+{
+	if (evt == QKeySequence::Copy) Copy();
+	else if (evt == QKeySequence::SelectAll) SelectAll();
+	else QAbstractScrollArea::keyPressEvent(evt);
+}
+
+void PChatView::changeEvent(QEvent *evt)
+{
+	QAbstractScrollArea::changeEvent(evt);
+	if (evt->type() == QEvent::FontChange || evt->type() == QEvent::PaletteChange || 
+		evt->type() == QEvent::StyleChange)
+	{
+		_Layouts.clear();
+		UpdateScrollBar();
+		viewport()->update();
+	}
+}
+
+void PChatView::FormatRow(const Row &row, QString &text, QVector<QTextLayout::FormatRange> &formats) const
+{
+	text.clear();
+	formats.clear();
+	auto message = row._Message;
+	if (!message)
+	{
+		text = row._Text;
+		QTextLayout::FormatRange marker;
+		marker.start = 0;
+		marker.length = text.length();
+		marker.format.setFontItalic(true);
+		marker.format.setFontUnderline(true);
+		marker.format.setForeground(QColor("gray"));
+		formats.append(marker);
+		return;
+	}
+	// The rendered text only depends on the message, so it is shared by every view and copied here.
+	auto cache = GetRenderedMessages();
+	const RenderedMessage *rendered = cache->object(message);
+	if (!rendered || rendered->_Message != message)
+	{
+		auto uncached = new RenderedMessage;
+		uncached->_Message = message;
+		RenderMessage(message, *uncached);
+		cache->insert(message, uncached);
+		rendered = uncached;
+	}
+	text = rendered->_Text;
+	formats = rendered->_Formats;
+	if (row._RepeatCount > 1)
+	{
+		QTextLayout::FormatRange repeat;
+		repeat.start = text.length() + 1;
+		text += ' ' + tr("(repeated x%1)").arg(row._RepeatCount);
+		repeat.length = text.length() - repeat.start;
+		repeat.format.setForeground(QColor("gray"));
+		formats.append(repeat);
+	}
+}
+
+QTextLayout * PChatView::GetLayout(int idx) const
+{
+	int width = GetTextWidth();
+	if (width != _LayoutWidth)
+	{
+		_Layouts.clear();
+		_LayoutWidth = width;
+	}
+	int rowId = _FirstRowId + idx;
+	auto layout = _Layouts.object(rowId);
+	if (layout) return layout;
+	QString text;
+	QVector<QTextLayout::FormatRange> formats;
+	FormatRow(_Rows.at(idx), text, formats);
+	layout = new QTextLayout(text, font(), viewport());
+	layout->setFormats(formats);
+	QTextOption option;
+	option.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+	layout->setTextOption(option);
+	layout->setCacheEnabled(true);
+	layout->beginLayout();
+	qreal y = 0;
+	forever
+	{
+		auto line = layout->createLine();
+		if (!line.isValid()) break;
+		line.setLineWidth(width);
+		line.setPosition(QPointF(0, y));
+		y += line.height();
+	}
+	layout->endLayout();
+	_Layouts.insert(rowId, layout);
+	return layout;
+}
+
+int PChatView::GetTextWidth() const
+{
+	return qMax(1, viewport()->width() - 2 * _Margin);
+}
+
+void PChatView::UpdateScrollBar()
+{
+	// The scroll bar counts rows, so the last position is the first row of the last page.
+	int height = viewport()->height() - 2 * _Margin;
+	int fit = 0;
+	int used = 0;
+	for (int idx = _Rows.length() - 1; idx >= 0; --idx)
+	{
+		used += qCeil(GetLayout(idx)->boundingRect().height());
+		if (used > height && fit > 0) break;
+		++fit;
+	}
+	verticalScrollBar()->setRange(0, qMax(0, _Rows.length() - fit));
+	verticalScrollBar()->setPageStep(qMax(1, fit));
+}
+
+PChatView::TextPosition PChatView::GetTextPositionAt(const QPoint &pos) const
+{
+	TextPosition textPos;
+	for (const auto &painted : _PaintedRows)
+	{
+		auto layout = GetLayout(painted.first);
+		auto rect = layout->boundingRect();
+		int top = painted.second;
+		if (pos.y() < top || pos.y() >= top + qCeil(rect.height())) continue;
+		textPos._RowId = _FirstRowId + painted.first;
+		for (int l = 0; l < layout->lineCount(); ++l)
+		{
+			auto line = layout->lineAt(l);
+			if (pos.y() >= top + line.y() + line.height() && l < layout->lineCount() - 1) continue;
+			textPos._Pos = line.xToCursor(pos.x() - _Margin);
+			break;
+		}
+		break;
+	}
+	return textPos;
+}
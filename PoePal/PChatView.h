@@ -0,0 +1,407 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QAbstractScrollArea>
+#include <QCache>
+#include <QTextLayout>
+#include <QVector>
+
+class PMessage;
+
+/**
+ * Displays a list of chat messages.
+ * Only the rows that are visible are laid out and painted, and the layouts of recently painted rows are kept
+ * in a small cache, so the cost of painting does not depend on how many messages the view holds. The view
+ * scrolls a row at a time. Each row is given an ID when it is added that stays the same as rows are added or
+ * removed around it.
+ */
+class PChatView : public QAbstractScrollArea
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * Creates a new chat view.
+	 * @param[in] parent
+	 *   The parent of the view.
+	 */
+	PChatView(QWidget *parent = nullptr);
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~PChatView();
+
+	/**
+	 * Adds a message to the end of the view.
+	 * @param[in] message
+	 *   The message to add.
+	 * @return
+	 *   The ID of the new row.
+	 */
+	int AppendMessage(PMessage *message);
+
+	/**
+	 * Adds a marker row to the end of the view, which shows text rather than a message.
+	 * Clicking on the marker sends MarkerClicked.
+	 * @param[in] text
+	 *   The text of the marker.
+	 * @return
+	 *   The ID of the new row.
+	 */
+	int AppendMarker(const QString &text);
+
+	/**
+	 * Starts a batch of changes.
+	 * Until EndBatch is called, adding rows does not update the scroll bar or repaint the view, so a batch of
+	 * rows is only laid out and scrolled once.
+	 */
+	void BeginBatch();
+
+	/**
+	 * Ends a batch of changes, updating the scroll bar and repainting the view once.
+	 */
+	void EndBatch();
+
+	/**
+	 * Adds messages to the beginning of the view.
+	 * The rows that are visible stay where they are.
+	 * @param[in] messages
+	 *   The messages to add, oldest first.
+	 */
+	void PrependMessages(const QVector<PMessage *> &messages);
+
+	/**
+	 * Removes rows from the beginning of the view.
+	 * @param[in] count
+	 *   The number of rows to remove.
+	 */
+	void RemoveFirstRows(int count);
+
+	/**
+	 * Removes all messages from the view.
+	 */
+	void Clear();
+
+	/**
+	 * Retrieves the oldest message in the view.
+	 * @return
+	 *   The message in the first row that shows a message or null if there are no messages.
+	 */
+	PMessage * GetFirstMessage() const;
+
+	/**
+	 * Retrieves the ID of the first row.
+	 * @return
+	 *   The ID of the first row, which is also the ID the next prepended row will be one less than.
+	 */
+	int GetFirstRowId() const;
+
+	/**
+	 * Retrieves the number of rows in the view.
+	 * @return
+	 *   The number of rows.
+	 */
+	int GetRowCount() const;
+
+	/**
+	 * Checks whether a row is still in the view.
+	 * @param[in] rowId
+	 *   The ID of the row.
+	 * @return
+	 *   true if the row is in the view, false otherwise.
+	 */
+	bool HasRow(int rowId) const;
+
+	/**
+	 * Sets the number of times the message in a row was received, which is shown after the message.
+	 * @param[in] rowId
+	 *   The ID of the row.
+	 * @param[in] count
+	 *   The number of times the message was received.
+	 */
+	void SetRepeatCount(int rowId, int count);
+
+	/**
+	 * Retrieves the message shown at a position.
+	 * @param[in] pos
+	 *   The position in viewport coordinates.
+	 * @return
+	 *   The message or null if there is no message at the position.
+	 */
+	PMessage * GetMessageAt(const QPoint &pos) const;
+
+	/**
+	 * Indicates whether any text is selected.
+	 * @return
+	 *   true if text is selected, false otherwise.
+	 */
+	bool HasSelection() const;
+
+	/**
+	 * Retrieves the selected text.
+	 * @return
+	 *   The selected text, with a line for each row.
+	 */
+	QString GetSelectedText() const;
+
+	/**
+	 * Indicates whether the view is scrolled to the last row.
+	 * @return
+	 *   true if the last row is visible at the bottom, false otherwise.
+	 */
+	bool IsAtBottom() const;
+
+public slots:
+
+	/**
+	 * Copies the selected text to the clipboard.
+	 */
+	void Copy();
+
+	/**
+	 * Selects all of the text.
+	 */
+	void SelectAll();
+
+	/**
+	 * Scrolls to the last row.
+	 */
+	void ScrollToBottom();
+
+signals:
+
+	/**
+	 * Signal sent when text is selected or deselected.
+	 * @param[in] available
+	 *   true if there is selected text to copy, false otherwise.
+	 */
+	void CopyAvailable(bool available);
+
+	/**
+	 * Signal sent when a marker row is clicked.
+	 * @param[in] rowId
+	 *   The ID of the marker row.
+	 */
+	void MarkerClicked(int rowId);
+
+	/**
+	 * Signal sent when the user scrolls to the top of the view, so older messages can be added.
+	 */
+	void ScrolledToTop();
+
+protected:
+
+	/**
+	 * Overrides QAbstractScrollArea#paintEvent
+	 */
+	virtual void paintEvent(QPaintEvent *evt) override;
+
+	/**
+	 * Overrides QAbstractScrollArea#resizeEvent
+	 */
+	virtual void resizeEvent(QResizeEvent *evt) override;
+
+	/**
+	 * Overrides QAbstractScrollArea#mousePressEvent
+	 */
+	virtual void mousePressEvent(QMouseEvent *evt) override;
+
+	/**
+	 * Overrides QAbstractScrollArea#mouseMoveEvent
+	 */
+	virtual void mouseMoveEvent(QMouseEvent *evt) override;
+
+	/**
+	 * Overrides QAbstractScrollArea#mouseReleaseEvent
+	 */
+	virtual void mouseReleaseEvent(QMouseEvent *evt) override;
+
+	/**
+	 * Overrides QAbstractScrollArea#wheelEvent
+	 */
+	virtual void wheelEvent(QWheelEvent *evt) override;
+
+	/**
+	 * Overrides QAbstractScrollArea#keyPressEvent
+	 */
+	virtual void keyPressEvent(QKeyEvent *evt) override;
+
+	/**
+	 * Overrides QAbstractScrollArea#changeEvent
+	 */
+	virtual void changeEvent(QEvent *evt) override;
+
+private:
+
+	/**
+	 * A row in the view.
+	 */
+	struct Row
+	{
+		/**
+		 * The message shown in the row or null if the row is a marker.
+		 */
+		PMessage *_Message = nullptr;
+
+		/**
+		 * The text of a marker row.
+		 */
+		QString _Text;
+
+		/**
+		 * The number of times the message was received.
+		 */
+		int _RepeatCount = 1;
+	};
+
+	/**
+	 * A position within the text of the rows.
+	 */
+	struct TextPosition
+	{
+		/**
+		 * The ID of the row or -1 if the position is invalid.
+		 */
+		int _RowId = -1;
+
+		/**
+		 * The position within the text of the row.
+		 */
+		int _Pos = 0;
+
+		/**
+		 * Compares two positions.
+		 */
+		bool operator<(const TextPosition &other) const
+		{
+			return _RowId < other._RowId || (_RowId == other._RowId && _Pos < other._Pos);
+		}
+	};
+
+	/**
+	 * Builds the text and formatting of a row.
+	 * @param[in] row
+	 *   The row.
+	 * @param[out] text
+	 *   The text of the row.
+	 * @param[out] formats
+	 *   The formatting of ranges of the text.
+	 */
+	void FormatRow(const Row &row, QString &text, QVector<QTextLayout::FormatRange> &formats) const;
+
+	/**
+	 * Retrieves the layout of a row, laying it out if it is not cached.
+	 * The layout may be removed from the cache by the next call, so it must not be kept.
+	 * @param[in] idx
+	 *   The index of the row.
+	 * @return
+	 *   The layout of the row.
+	 */
+	QTextLayout * GetLayout(int idx) const;
+
+	/**
+	 * Retrieves the width available to the text of the rows.
+	 * @return
+	 *   The text width.
+	 */
+	int GetTextWidth() const;
+
+	/**
+	 * Updates the range of the scroll bar after rows are added or removed or the view is resized.
+	 */
+	void UpdateScrollBar();
+
+	/**
+	 * Adds a row to the end of the view.
+	 * @param[in] row
+	 *   The row to add.
+	 * @return
+	 *   The ID of the new row.
+	 */
+	int AppendRow(const Row &row);
+
+	/**
+	 * Finds the text position at a point.
+	 * @param[in] pos
+	 *   The point in viewport coordinates.
+	 * @return
+	 *   The text position, which is invalid if there is no row at the point.
+	 */
+	TextPosition GetTextPositionAt(const QPoint &pos) const;
+
+	/**
+	 * The rows in the view.
+	 */
+	QVector<Row> _Rows;
+
+	/**
+	 * The ID of the first row. The ID of a row is its index plus this.
+	 */
+	int _FirstRowId = 0;
+
+	/**
+	 * The layouts of the recently painted rows, indexed by row ID.
+	 */
+	mutable QCache<int, QTextLayout> _Layouts;
+
+	/**
+	 * The width the cached layouts were laid out for.
+	 */
+	mutable int _LayoutWidth = -1;
+
+	/**
+	 * The index and top of each row painted in the last paint, used to find the rows under the mouse.
+	 */
+	QVector<QPair<int, int>> _PaintedRows;
+
+	/**
+	 * The position where the selection started.
+	 */
+	TextPosition _SelectionAnchor;
+
+	/**
+	 * The position where the selection ends.
+	 */
+	TextPosition _SelectionPos;
+
+	/**
+	 * Indicates whether the mouse is selecting text.
+	 */
+	bool _Selecting = false;
+
+	/**
+	 * The number of batches of changes that have been started and not ended.
+	 */
+	int _BatchDepth = 0;
+
+	/**
+	 * Indicates whether the view was scrolled to the end when the current batch started.
+	 */
+	bool _BatchWasAtBottom = false;
+
+	/**
+	 * The ID of the first row when the current batch started.
+	 */
+	int _BatchFirstRowId = 0;
+
+	/**
+	 * The ID just past the last row when the current batch started.
+	 */
+	int _BatchEndRowId = 0;
+};
@@ -16,66 +16,35 @@
 #include "PChatWidget.h"
 #include "PApplication.h"
 #include "PChatOptionsDlg.h"
+#include "PChatView.h"
+#include "PMessageBus.h"
 #include "PMessageHandler.h"
 #include "PMainWindow.h"
 #include <QKeyEvent>
 #include <QMenu>
 #include <QProxyStyle>
-#include <QScrollBar>
 #include <QSettings>
 #include <QStringBuilder>
 #include <QStyleOptionTab>
 #include <QTabBar>
-#include <QTextBlock>
+#include <algorithm>
 
-/**
- * Class associates a text block with a message.
- */
-class PTextBlockMessageData : public QTextBlockUserData
+namespace
 {
-public:
-
 	/**
-	 * Creates a new data pointing to a given message.
-	 * @param[in] message
-	 *   The message to which the text block will point.
+	 * The time between updates of the display, in milliseconds.
 	 */
-	PTextBlockMessageData(PMessage *message);
+	const int _FrameInterval = 16;
 
 	/**
-	 * Destructor.
+	 * The maximum number of messages waiting to be displayed. Beyond this, the oldest are skipped.
 	 */
-	virtual ~PTextBlockMessageData();
-
-	/**
-	 * Retrieves the log message.
-	 * @return
-	 *   The log message.
-	 */
-	PMessage * GetLogMessage() const;
-
-private:
+	const int _MaxPendingMessages = 500;
 
 	/**
-	 * The log message being lined with a text block.
+	 * The number of messages loaded at a time when scrolling back through the history.
 	 */
-	QPointer<PMessage> _Message;
-};
-
-PTextBlockMessageData::PTextBlockMessageData(PMessage *message):
-_Message(message)
-{
-
-}
-
-PTextBlockMessageData::~PTextBlockMessageData()
-{
-
-}
-
-PMessage * PTextBlockMessageData::GetLogMessage() const
-{
-	return _Message.data();
+	const int _PageSize = 100;
 }
 
 class PHorizontalTabStyle : public QProxyStyle
@@ -129,6 +98,11 @@ PChatWidget::PChatWidget(PMessage::Channel defaultChannel, QWidget *parent /*= Q
 
 PChatWidget::~PChatWidget()
 {
+	if (_FilterId >= 0)
+	{
+		auto app = qobject_cast<PApplication *>(qApp);
+		if (app && app->GetMessageHandler()) app->GetMessageHandler()->RemoveFilter(_FilterId);
+	}
 }
 
 PMessage::Channel PChatWidget::GetDefaultChannel() const
@@ -160,6 +134,79 @@ QPlainTextEdit * PChatWidget::GetEntryWidget() const
 	return _EntryEdit;
 }
 
+bool PChatWidget::IsCollapsingRepeats() const
+{
+	return _CollapseRepeats;
+}
+
+void PChatWidget::SetCollapseRepeats(bool state)
+{
+	_CollapseRepeats = state;
+	if (!state)
+	{
+		_Repeats.clear();
+		_RepeatQueue.clear();
+	}
+}
+
+int PChatWidget::GetRepeatWindow() const
+{
+	return _RepeatWindow;
+}
+
+void PChatWidget::SetRepeatWindow(int seconds)
+{
+	_RepeatWindow = qMax(1, seconds);
+}
+
+QString PChatWidget::GetFilter() const
+{
+	return _Filter;
+}
+
+void PChatWidget::SetFilter(const QString &expression)
+{
+	auto trimmed = expression.trimmed();
+	if (trimmed == _Filter) return;
+	auto app = qobject_cast<PApplication *>(qApp);
+	Q_ASSERT(app);
+	auto handler = app->GetMessageHandler();
+	if (_FilterId >= 0) handler->RemoveFilter(_FilterId);
+	_Filter = trimmed;
+	_FilterId = _Filter.isEmpty() ? -1 : handler->AddFilter(_Filter);
+	if (!_DisplayView->isHidden())
+	{
+		_PendingMessages.clear();
+		_SkippedMessages = 0;
+		_DisplayView->Clear();
+		_Repeats.clear();
+		_RepeatQueue.clear();
+		PrependMessages();
+	}
+}
+
+int PChatWidget::GetScrollback() const
+{
+	return _Scrollback;
+}
+
+void PChatWidget::SetScrollback(int count)
+{
+	_Scrollback = qMax(_PageSize, count);
+	TrimScrollback();
+}
+
+int PChatWidget::GetWhisperViewLimit() const
+{
+	return _WhisperViewLimit;
+}
+
+void PChatWidget::SetWhisperViewLimit(int count)
+{
+	_WhisperViewLimit = qMax(1, count);
+	EvictWhisperViews();
+}
+
 void PChatWidget::Submit()
 {
 	auto text = _EntryEdit->toPlainText().trimmed();
@@ -212,14 +259,6 @@ bool PChatWidget::eventFilter(QObject *watched, QEvent *evt)
 			}
 		}
 	}
-	else if (watched == _DisplayEdit)
-	{
-		if (evt->type() == QEvent::ContextMenu)
-		{
-			QContextMenuEvent *contextEvent = static_cast<QContextMenuEvent *>(evt);
-			_ContextMenu->popup(contextEvent->pos());
-		}
-	}
 	return QWidget::eventFilter(watched, evt);
 }
 
@@ -231,37 +270,99 @@ bool PChatWidget::ShouldRetainFocus() const
 void PChatWidget::OnNewMessage(PMessage *message)
 {
 	if (!CheckMessage(message)) return;
-	if (_DisplayEdit->isVisible())
+	// Queue the message so that a burst of messages is displayed at once.
+	_PendingMessages.append(message);
+	// The queue is bounded even while the widget is hidden, so showing it again only displays the latest messages.
+	// Whispers are never skipped, since they are shown in their own tabs and there are few of them. The display
+	// view is only hidden explicitly in whisper tab mode, so isHidden tells the modes apart whether or not the
+	// widget itself is shown.
+	if (!_DisplayView->isHidden() && _PendingMessages.length() > _MaxPendingMessages)
 	{
-		auto wasAtEnd = _DisplayEdit->verticalScrollBar()->value() >= 
-			_DisplayEdit->verticalScrollBar()->maximum()-2;
-		auto doc = _DisplayEdit->document();
-		QTextCursor cursor(doc);
-		cursor.movePosition(QTextCursor::End);
-		if(!doc->isEmpty()) cursor.insertBlock();
-		cursor.block().setUserData(new PTextBlockMessageData(message));
-		cursor.insertHtml(FormatMessage(message));
-		if (_DisplayEdit->textCursor().selectedText().isEmpty() && wasAtEnd)
+		int excess = _PendingMessages.length() - _MaxPendingMessages;
+		_PendingMessages.remove(0, excess);
+		_SkippedMessages += excess;
+	}
+	if (!_FlushTimer.isActive()) _FlushTimer.start();
+}
+
+void PChatWidget::showEvent(QShowEvent *evt)
+{
+	QWidget::showEvent(evt);
+	FlushMessages();
+}
+
+void PChatWidget::FlushMessages()
+{
+	if (!isVisible() || (_PendingMessages.isEmpty() && _SkippedMessages == 0)) return;
+	auto messages = _PendingMessages;
+	_PendingMessages.clear();
+	_DisplayView->BeginBatch();
+	if (_SkippedMessages > 0 && !_DisplayView->isHidden())
+	{
+		_DisplayView->AppendMarker(tr("%n message(s) skipped, click to load", "", _SkippedMessages));
+	}
+	_SkippedMessages = 0;
+	for (const auto &message : messages) DisplayMessage(message);
+	_DisplayView->EndBatch();
+	TrimScrollback();
+}
+
+void PChatWidget::TrimScrollback()
+{
+	auto excess = _DisplayView->GetRowCount() - _Scrollback;
+	if (excess <= 0) return;
+	// While the user is reading older messages, leave them in place unless the display has grown far past the
+	// scrollback.
+	if (!_DisplayView->IsAtBottom() && excess < _Scrollback) return;
+	_DisplayView->RemoveFirstRows(excess);
+	// Repeats can't be collapsed into rows that are gone, and their IDs will be reused by older rows.
+	auto firstRowId = _DisplayView->GetFirstRowId();
+	for (auto iter = _Repeats.begin(); iter != _Repeats.end();)
+	{
+		if (iter->_RowId < firstRowId) iter = _Repeats.erase(iter);
+		else ++iter;
+	}
+}
+
+void PChatWidget::OnMarkerClicked(int rowId)
+{
+	// The skipped messages are all in the message store, so reload the display from there.
+	_PendingMessages.clear();
+	_SkippedMessages = 0;
+	_DisplayView->Clear();
+	_Repeats.clear();
+	_RepeatQueue.clear();
+	PrependMessages();
+}
+
+void PChatWidget::DisplayMessage(PMessage *message)
+{
+	if (!_DisplayView->isHidden())
+	{
+		if (CollapseRepeat(message)) return;
+		auto rowId = _DisplayView->AppendMessage(message);
+		if (_CollapseRepeats && message->GetSubtype() == PMessage::Chat)
 		{
-			_DisplayEdit->setTextCursor(cursor);
-			_DisplayEdit->ensureCursorVisible();
+			// The entry may be left over from a row that has since been removed, so its count starts over.
+			auto &repeat = _Repeats[qMakePair(message->GetSubject(), message->GetContents())];
+			repeat._RowId = rowId;
+			repeat._Count = 1;
+			repeat._LastSeen = message->GetTime().toMSecsSinceEpoch();
 		}
 	}
 	else
 	{
 		int numTabs = _WhisperTabs->count();
-		int idx = -1;
-		for (int t = 0; t < numTabs; ++t)
-		{
-			if (_WhisperTabs->tabBar()->tabText(t) == message->GetSubject()) idx = t;
-		}
+		PChatView *view = nullptr;
 		if (message->GetSubject().isEmpty())
 		{
-			if (numTabs > 0) idx = 0;
+			if (numTabs > 0) view = qobject_cast<PChatView *>(_WhisperTabs->widget(0));
 			else return;
 		}
-		if (idx >= 0)
+		else view = _WhisperViews.value(message->GetSubject());
+		if (view)
 		{
+			auto idx = _WhisperTabs->indexOf(view);
 			auto isSel = _WhisperTabs->currentIndex() == idx;
 			_WhisperTabs->tabBar()->moveTab(idx, 0);
 			if(isSel) _WhisperTabs->setCurrentIndex(0);
@@ -269,13 +370,14 @@ void PChatWidget::OnNewMessage(PMessage *message)
 		}
 		else
 		{
-			auto textEdit = new QPlainTextEdit(_WhisperTabs); 
-			textEdit->setReadOnly(true);
-			textEdit->setFrameStyle(QFrame::NoFrame);
-			textEdit->setContextMenuPolicy(Qt::CustomContextMenu);
-			connect(textEdit, &QPlainTextEdit::customContextMenuRequested, this,
-				&PChatWidget::OnContextMenuRequested);
-			_WhisperTabs->insertTab(0, textEdit, message->GetSubject());
+			view = new PChatView(_WhisperTabs); 
+			view->setFrameStyle(QFrame::NoFrame);
+			view->setContextMenuPolicy(Qt::CustomContextMenu);
+			connect(view, &PChatView::customContextMenuRequested, this, &PChatWidget::OnContextMenuRequested);
+			_WhisperTabs->insertTab(0, view, message->GetSubject());
+			_WhisperViews.insert(message->GetSubject(), view);
+			// This has to be live before it is selected, or selecting it would load this message a second time.
+			TouchWhisperView(view);
 			if (numTabs > 0 && message->IsIncoming())
 			{
 				if (message->GetSubtype() == PMessage::Chat)
@@ -285,15 +387,52 @@ void PChatWidget::OnNewMessage(PMessage *message)
 			}
 			else _WhisperTabs->tabBar()->setCurrentIndex(0);
 		}
-		if (message->GetSubtype() != PMessage::Chat)
+		if (message->GetSubtype() != PMessage::Chat && !message->IsWhisperFailure()) return;
+		// An emptied conversation picks the message up from the store when it is selected.
+		if (!_LiveWhisperViews.contains(view)) return;
+		view->AppendMessage(message);
+		TouchWhisperView(view);
+	}
+}
+
+void PChatWidget::TouchWhisperView(PChatView *view)
+{
+	_LiveWhisperViews.removeOne(view);
+	_LiveWhisperViews.append(view);
+	EvictWhisperViews();
+}
+
+void PChatWidget::EvictWhisperViews()
+{
+	auto current = _WhisperTabs->widget(_WhisperTabs->currentIndex());
+	for (int v = 0; v < _LiveWhisperViews.length() && _LiveWhisperViews.length() > _WhisperViewLimit;)
+	{
+		auto view = _LiveWhisperViews.at(v);
+		if (view == current)
 		{
-			if (message->GetContents() != tr("That character is not online.") &&
-				message->GetContents() != tr("The specified character does not exist.")) return;
+			++v;
+			continue;
 		}
-		auto edit = qobject_cast<QPlainTextEdit *>(_WhisperTabs->widget(0));
-		Q_ASSERT(edit);
-		edit->appendHtml(FormatMessage(message));
+		_LiveWhisperViews.removeAt(v);
+		view->Clear();
+	}
+}
+
+void PChatWidget::RebuildWhisperView(PChatView *view, const QString &subject)
+{
+	auto app = qobject_cast<PApplication *>(qApp);
+	Q_ASSERT(app);
+	auto scanner = app->GetMessageHandler();
+	// The conversation has its own index, so only the messages shown are looked at.
+	auto indexes = scanner->GetWhisperIndexes(subject);
+	QVector<PMessage *> messages;
+	for (int i = qMax(0, indexes.length() - _Scrollback); i < indexes.length(); ++i)
+	{
+		messages.append(scanner->GetMessageAt(indexes.at(i)));
 	}
+	view->Clear();
+	view->PrependMessages(messages);
+	view->ScrollToBottom();
 }
 
 void PChatWidget::OnEntryChanged()
@@ -315,7 +454,13 @@ void PChatWidget::OnChannelSelected()
 void PChatWidget::OnTabSelected()
 {
 	int sel = _WhisperTabs->tabBar()->currentIndex();
-	_WhisperTabs->tabBar()->setTabTextColor(sel, Qt::black);
+	_WhisperTabs->tabBar()->setTabTextColor(sel, QColor());
+	auto view = qobject_cast<PChatView *>(_WhisperTabs->widget(sel));
+	if (view)
+	{
+		if (!_LiveWhisperViews.contains(view)) RebuildWhisperView(view, _WhisperTabs->tabText(sel));
+		TouchWhisperView(view);
+	}
 	_WhisperTabs->setCurrentIndex(sel);
 	// Change the target of the whisper to the current tab.
 	auto text = _EntryEdit->toPlainText().trimmed();
@@ -338,22 +483,31 @@ void PChatWidget::OnTabSelected()
 	}
 }
 
+void PChatWidget::OnWhisperTabClosed(int index)
+{
+	auto view = qobject_cast<PChatView *>(_WhisperTabs->widget(index));
+	_WhisperViews.remove(_WhisperTabs->tabText(index));
+	_LiveWhisperViews.removeOne(view);
+	if (view) view->deleteLater();
+}
+
 void PChatWidget::OnContextMenuRequested(const QPoint &pos)
 {
-	_ContextMenu->popup(_DisplayEdit->mapToGlobal(pos));
-	auto cursor = _DisplayEdit->cursorForPosition(pos);
-	auto userData = static_cast<PTextBlockMessageData *>(cursor.block().userData());
-	if (userData) _ContextMenu->setProperty("subject", userData->GetLogMessage()->GetSubject());
-	else if (sender() != _DisplayEdit)
-	{
-		int idx = _WhisperTabs->indexOf(qobject_cast<QWidget *>(sender()));
-		_ContextMenu->setProperty("subject", _WhisperTabs->tabText(idx));
-	}
-	else
+	auto view = qobject_cast<PChatView *>(sender());
+	if (!view) return;
+	_ContextMenu->setProperty("view", QVariant::fromValue<QObject *>(view));
+	_CopyAction->setEnabled(view->HasSelection());
+	auto message = view->GetMessageAt(pos);
+	QString subject;
+	if (message) subject = message->GetSubject();
+	else if (view != _DisplayView) subject = _WhisperTabs->tabText(_WhisperTabs->indexOf(view));
+	_ContextMenu->setProperty("subject", subject);
+	// The player actions only make sense if there is a player.
+	for (auto action : {_FriendAction, _InviteAction, _IgnoreAction, _WhoisAction, _WhisperAction})
 	{
-		_ContextMenu->setDisabled(true);
-		_ContextMenu->setProperty("msg", QVariant());
+		action->setEnabled(!subject.isEmpty());
 	}
+	_ContextMenu->popup(view->viewport()->mapToGlobal(pos));
 }
 
 void PChatWidget::OnContextMenuTriggered(QAction *action)
@@ -368,6 +522,11 @@ void PChatWidget::OnContextMenuTriggered(QAction *action)
 	{
 		handler->SendAction(actionVar.value<PMessageHandler::Action>(), subject);
 	}
+	else if (action == _CopyAction)
+	{
+		auto view = qobject_cast<PChatView *>(_ContextMenu->property("view").value<QObject *>());
+		if (view) view->Copy();
+	}
 	else if (action == _WhisperAction)
 	{
 		auto mainWin = app->GetMainWindow();
@@ -378,8 +537,8 @@ void PChatWidget::OnContextMenuTriggered(QAction *action)
 
 bool PChatWidget::CheckMessage(PMessage *message)
 {
-	return _Channels.testFlag(message->GetChannel()) || 
-		(message->GetType() == PMessage::Info && message->GetSubtype() == PMessage::Event);
+	if (message->GetType() == PMessage::Info && message->GetSubtype() == PMessage::Event) return true;
+	return _Channels.testFlag(message->GetChannel()) && (_FilterId < 0 || message->MatchesFilter(_FilterId));
 }
 
 void PChatWidget::PrependMessages()
@@ -387,47 +546,50 @@ void PChatWidget::PrependMessages()
 	auto app = qobject_cast<PApplication *>(qApp);
 	Q_ASSERT(app);
 	auto scanner = app->GetMessageHandler();
-	QString contents;
-	auto messages = scanner->GetLogMessages();
-	int msgCount = messages.length();
-	int curr = 0;
-	for (int m = msgCount - 1; m >= 0 && curr < 100; --m, ++curr)
-	{
-		if (!CheckMessage(messages.at(m))) continue;
-		contents.prepend(FormatMessage(messages.at(m)) + "<br />");
-		_TopIdx = m;
-	}
-	contents.resize(contents.length() - 6);
-	contents.append(_DisplayEdit->document()->toHtml());
-	_DisplayEdit->clear();
-	_DisplayEdit->appendHtml(contents);
-}
-
-QString PChatWidget::FormatMessage(PMessage *message) const
-{
-	QString color = "black";
-	if (message->GetChannel() == PMessage::Global) color = "firebrick";
-	else if (message->GetChannel() == PMessage::Trade) color = "goldenrod";
-	else if (message->GetChannel() == PMessage::Guild) color = "gray";
-	else if (message->GetChannel() == PMessage::Party) color = "cyan";
-	else if (message->GetChannel() == PMessage::Local) color = "limegreen";
-	else if (message->GetChannel() == PMessage::Whisper) color = "mediumpurple";
-	QString text;
-	if (message->GetSubtype() == PMessage::Chat)
-	{
-		text += "<span style=\"color: " + color + "; font-weight: bold;\">" + 
-			message->GetTime().toString("[hh:mm] ");
-		if (message->GetChannel() != PMessage::InvalidChannel)
-		{
-			text += PMessage::GetPrefixFromChannel(message->GetChannel());
-		}
-		if (message->GetChannel() == PMessage::Whisper)
+	auto first = _DisplayView->GetFirstMessage();
+	int before = first ? first->GetStoreIndex() : scanner->GetMessageCount();
+	// Only walk back through the messages on the channels shown in this widget, a page at a time, until enough
+	// pass the filter.
+	QVector<PMessage *> messages;
+	while (messages.length() < _PageSize && before > 0)
+	{
+		auto indexes = scanner->GetMessageIndexesBefore(_Channels, true, before, _PageSize);
+		if (indexes.isEmpty()) break;
+		for (int i = indexes.length() - 1; i >= 0 && messages.length() < _PageSize; --i)
 		{
-			text += message->IsIncoming() ? tr("From ") : tr("To ");
+			before = indexes.at(i);
+			auto message = scanner->GetMessageAt(before);
+			if (CheckMessage(message)) messages.append(message);
 		}
-		text += message->GetFullSender().toHtmlEscaped() + "</span> : ";
 	}
-	return text + message->GetContents().toHtmlEscaped();
+	if (messages.isEmpty()) return;
+	std::reverse(messages.begin(), messages.end());
+	_DisplayView->PrependMessages(messages);
+}
+
+bool PChatWidget::CollapseRepeat(PMessage *message)
+{
+	if (!_CollapseRepeats || message->GetSubtype() != PMessage::Chat) return false;
+	auto now = message->GetTime().toMSecsSinceEpoch();
+	auto window = static_cast<qint64>(_RepeatWindow) * 1000;
+	// Forget the messages that haven't been seen within the window. Keys that were seen again have a later
+	// entry in the queue, so only remove them if this entry is the last time they were seen.
+	while (!_RepeatQueue.isEmpty() && _RepeatQueue.head().first < now - window)
+	{
+		auto expired = _RepeatQueue.dequeue();
+		auto iter = _Repeats.find(expired.second);
+		if (iter != _Repeats.end() && iter->_LastSeen == expired.first) _Repeats.erase(iter);
+	}
+	auto key = qMakePair(message->GetSubject(), message->GetContents());
+	_RepeatQueue.enqueue(qMakePair(now, key));
+	auto iter = _Repeats.find(key);
+	if (iter == _Repeats.end()) return false;
+	if (!_DisplayView->HasRow(iter->_RowId)) return false;
+	iter->_Count++;
+	iter->_LastSeen = now;
+	// Show the repeat count on the original row.
+	_DisplayView->SetRepeatCount(iter->_RowId, iter->_Count);
+	return true;
 }
 
 void PChatWidget::Initialize()
@@ -442,13 +604,17 @@ void PChatWidget::Initialize()
 	_WhisperTabs->tabBar()->setStyle(new PHorizontalTabStyle());
 	_WhisperTabs->setTabsClosable(true);
 	connect(_EntryEdit, &QPlainTextEdit::textChanged, this, &PChatWidget::OnEntryChanged);
-	connect(_DisplayEdit, &QWidget::customContextMenuRequested, this, &PChatWidget::OnContextMenuRequested);
+	connect(_DisplayView, &QWidget::customContextMenuRequested, this, &PChatWidget::OnContextMenuRequested);
 	connect(_WhisperTabs->tabBar(), &PVerticalTabBar::currentChanged, this, &PChatWidget::OnTabSelected);
+	connect(_WhisperTabs, &PVerticalTabWidget::tabCloseRequested, this, &PChatWidget::OnWhisperTabClosed);
 	_EntryEdit->installEventFilter(this);
 	PrependMessages();
-	auto scanner = app->GetMessageHandler();
-	_DisplayEdit->verticalScrollBar()->setValue(_DisplayEdit->verticalScrollBar()->maximum());
-	connect(scanner, &PMessageHandler::NewMessage, this, &PChatWidget::OnNewMessage);
+	_DisplayView->ScrollToBottom();
+	_FlushTimer.setSingleShot(true);
+	_FlushTimer.setInterval(_FrameInterval);
+	connect(&_FlushTimer, &QTimer::timeout, this, &PChatWidget::FlushMessages);
+	connect(_DisplayView, &PChatView::MarkerClicked, this, &PChatWidget::OnMarkerClicked);
+	connect(_DisplayView, &PChatView::ScrolledToTop, this, &PChatWidget::PrependMessages);
 	_ContextMenu = new QMenu(this);
 	_FriendAction = _ContextMenu->addAction(tr("Add Friend"));
 	_FriendAction->setProperty("action", QVariant::fromValue(PMessageHandler::Friend));
@@ -461,10 +627,7 @@ void PChatWidget::Initialize()
 	_WhisperAction = _ContextMenu->addAction(tr("Whisper"));
 	_ContextMenu->addSeparator();
 	_CopyAction = _ContextMenu->addAction(tr("Copy Text"));
-	_CopyAction->setEnabled(!_DisplayEdit->textCursor().selectedText().isEmpty());
 	connect(_ContextMenu, &QMenu::triggered, this, &PChatWidget::OnContextMenuTriggered);
-	connect(_DisplayEdit, &QPlainTextEdit::copyAvailable, _CopyAction, &QAction::setEnabled);
-	connect(_CopyAction, &QAction::triggered, _DisplayEdit, &QPlainTextEdit::copy);
 	connect(_SendBtn, &QPushButton::clicked, this, &PChatWidget::Submit);
 	UpdateForChannels();
 }
@@ -494,7 +657,19 @@ void PChatWidget::UpdateForChannels()
 	else _ChannelBtn->show();
 	bool tabbedWhisper = oneChannel && _Channels.testFlag(PMessage::Whisper);
 	_WhisperTabs->setVisible(tabbedWhisper);
-	_DisplayEdit->setVisible(!tabbedWhisper);
+	_DisplayView->setVisible(!tabbedWhisper);
+	// Only get the chat messages on the channels shown here, plus the events that are always shown.
+	PMessageBus::Subscription subscription;
+	subscription._Subtypes = {PMessage::Chat, PMessage::Event};
+	subscription._Channels = _Channels;
+	auto app = qobject_cast<PApplication *>(qApp);
+	Q_ASSERT(app);
+	auto bus = app->GetMessageHandler()->GetMessageBus();
+	if (_SubscriptionId >= 0) bus->UpdateSubscription(_SubscriptionId, subscription);
+	else
+	{
+		_SubscriptionId = bus->Subscribe(subscription, this, [this](PMessage *message) { OnNewMessage(message); });
+	}
 }
 
 PMessage::Channel PChatWidget::GetCurrentChannel() const
@@ -16,6 +16,9 @@
 #pragma once
 
 #include "PMessage.h"
+#include <QHash>
+#include <QQueue>
+#include <QTimer>
 #include <QWidget>
 #include "ui_PChatWidget.h"
 
@@ -44,6 +47,31 @@ class PChatWidget : public QWidget, public Ui::PChatWidget
 	 */
 	Q_PROPERTY(QPlainTextEdit *entryWidget READ GetEntryWidget)
 
+	/**
+	 * Indicates whether repeated chat messages are collapsed into the original message.
+	 */
+	Q_PROPERTY(bool collapseRepeats READ IsCollapsingRepeats WRITE SetCollapseRepeats)
+
+	/**
+	 * The window in seconds within which a repeated chat message is collapsed.
+	 */
+	Q_PROPERTY(int repeatWindow READ GetRepeatWindow WRITE SetRepeatWindow)
+
+	/**
+	 * The content filter chat messages must match to be shown.
+	 */
+	Q_PROPERTY(QString filter READ GetFilter WRITE SetFilter)
+
+	/**
+	 * The number of messages kept in the display. Older messages are loaded again when scrolling up.
+	 */
+	Q_PROPERTY(int scrollback READ GetScrollback WRITE SetScrollback)
+
+	/**
+	 * The number of whisper conversations kept in memory. Others are reloaded when their tab is selected.
+	 */
+	Q_PROPERTY(int whisperViewLimit READ GetWhisperViewLimit WRITE SetWhisperViewLimit)
+
 public:
 	
 	/**
@@ -95,6 +123,84 @@ public:
 	 */
 	QPlainTextEdit * GetEntryWidget() const;
 
+	/**
+	 * Indicates whether repeated chat messages are collapsed into the original message.
+	 * When this is on, a message with the same sender and contents as one shown within the repeat window
+	 * increments a counter on the original message instead of being added again.
+	 * @return
+	 *   true if repeated messages are collapsed, false otherwise.
+	 */
+	bool IsCollapsingRepeats() const;
+
+	/**
+	 * Sets whether repeated chat messages are collapsed into the original message.
+	 * @param[in] state
+	 *   true if repeated messages are to be collapsed, false otherwise.
+	 */
+	void SetCollapseRepeats(bool state);
+
+	/**
+	 * Retrieves the window within which a repeated chat message is collapsed.
+	 * The window slides: each repeat restarts it.
+	 * @return
+	 *   The repeat window in seconds.
+	 */
+	int GetRepeatWindow() const;
+
+	/**
+	 * Sets the window within which a repeated chat message is collapsed.
+	 * @param[in] seconds
+	 *   The new repeat window in seconds.
+	 */
+	void SetRepeatWindow(int seconds);
+
+	/**
+	 * Retrieves the content filter chat messages must match to be shown.
+	 * @return
+	 *   The filter expression or an empty string if all chat messages on the channels are shown.
+	 */
+	QString GetFilter() const;
+
+	/**
+	 * Sets the content filter chat messages must match to be shown.
+	 * The messages already shown are filtered again.
+	 * @param[in] expression
+	 *   The filter expression, see PMessageFilter, or an empty string to show all chat messages.
+	 */
+	void SetFilter(const QString &expression);
+
+	/**
+	 * Retrieves the number of messages kept in the display.
+	 * Beyond this, the oldest messages are removed from the display while it is scrolled to the bottom. They
+	 * remain in the message store and are paged back in when the user scrolls to the top.
+	 * @return
+	 *   The number of messages kept in the display.
+	 */
+	int GetScrollback() const;
+
+	/**
+	 * Sets the number of messages kept in the display.
+	 * @param[in] count
+	 *   The new number of messages to keep.
+	 */
+	void SetScrollback(int count);
+
+	/**
+	 * Retrieves the number of whisper conversations kept in memory.
+	 * Beyond this, the conversations that were used least recently are emptied, leaving only their tab. They
+	 * are reloaded from the message store when their tab is selected.
+	 * @return
+	 *   The number of whisper conversations kept in memory.
+	 */
+	int GetWhisperViewLimit() const;
+
+	/**
+	 * Sets the number of whisper conversations kept in memory.
+	 * @param[in] count
+	 *   The new number of conversations to keep.
+	 */
+	void SetWhisperViewLimit(int count);
+
 	/**
 	 * Submits the entered text.
 	 */
@@ -114,6 +220,11 @@ protected:
 	 */
 	virtual bool eventFilter(QObject *watched, QEvent *evt) override;
 
+	/**
+	 * Overrides QWidget#showEvent.
+	 */
+	virtual void showEvent(QShowEvent *evt) override;
+
 	/**
 	 * Indicates whether or not to take back focus when done sending a message. 
 	 * @return
@@ -145,6 +256,13 @@ private slots:
 	 */
 	void OnTabSelected();
 
+	/**
+	 * Slot called when a whisper tab is closed.
+	 * @param[in] index
+	 *   The index of the tab being closed.
+	 */
+	void OnWhisperTabClosed(int index);
+
 	/**
 	 * Slot called when a context menu is requested in the display edit.
 	 * @param[in] pos
@@ -178,18 +296,66 @@ private:
 	virtual bool CheckMessage(PMessage *message);
 	
 	/**
-	 * Prepends 100 messages to the display.
+	 * Prepends a page of messages older than the first one shown to the display.
 	 */
 	void PrependMessages();
 
 	/**
-	 * Formats the given message.
+	 * Removes the oldest messages from the display once it holds more than the scrollback.
+	 */
+	void TrimScrollback();
+
+	/**
+	 * Displays the messages that have been queued since the last frame.
+	 * Nothing is displayed while the widget is hidden; the messages are kept until it is shown.
+	 */
+	void FlushMessages();
+
+	/**
+	 * Displays a message.
 	 * @param[in] message
-	 *   The message to format.
+	 *   The message to display.
+	 */
+	void DisplayMessage(PMessage *message);
+
+	/**
+	 * Reloads the display from the message store after messages were skipped.
+	 * @param[in] rowId
+	 *   The ID of the marker row that was clicked.
+	 */
+	void OnMarkerClicked(int rowId);
+
+	/**
+	 * Marks a whisper conversation as the most recently used, emptying the least recently used conversations
+	 * if there are too many.
+	 * @param[in] view
+	 *   The view showing the conversation.
+	 */
+	void TouchWhisperView(PChatView *view);
+
+	/**
+	 * Empties the least recently used whisper conversations until there are no more than the limit.
+	 * The conversation in the current tab is never emptied.
+	 */
+	void EvictWhisperViews();
+
+	/**
+	 * Reloads an emptied whisper conversation from the message store.
+	 * @param[in] view
+	 *   The view showing the conversation.
+	 * @param[in] subject
+	 *   The player the conversation is with.
+	 */
+	void RebuildWhisperView(PChatView *view, const QString &subject);
+
+	/**
+	 * Collapses a message into an earlier identical message if it is a repeat.
+	 * @param[in] message
+	 *   The new message.
 	 * @return
-	 *   The formatted message.
+	 *   true if the message was a repeat and has been collapsed, false if it should be displayed.
 	 */
-	QString FormatMessage(PMessage *message) const;
+	bool CollapseRepeat(PMessage *message);
 
 	/**
 	 * Initializes the widget.
@@ -246,9 +412,95 @@ private:
 	PMessage::Channels _Channels;
 
 	/**
-	 * The index of the top message displayed in the widget.
+	 * The number of messages kept in the display.
+	 */
+	int _Scrollback = 1000;
+
+	/**
+	 * The ID of the widget's subscription to the message bus or -1 if it hasn't subscribed yet.
+	 */
+	int _SubscriptionId = -1;
+
+	/**
+	 * The messages received since the display was last updated.
+	 */
+	QVector<PMessage *> _PendingMessages;
+
+	/**
+	 * The number of messages that were dropped from the queue because too many were waiting.
+	 */
+	int _SkippedMessages = 0;
+
+	/**
+	 * The timer that displays the queued messages once per frame.
+	 */
+	QTimer _FlushTimer;
+
+	/**
+	 * Indicates whether repeated chat messages are collapsed.
+	 */
+	bool _CollapseRepeats = false;
+
+	/**
+	 * The window in seconds within which a repeated chat message is collapsed.
+	 */
+	int _RepeatWindow = 60;
+
+	/**
+	 * The content filter chat messages must match to be shown.
+	 */
+	QString _Filter;
+
+	/**
+	 * The ID of the content filter registered with the message handler or -1 if there is no filter.
+	 */
+	int _FilterId = -1;
+
+	/**
+	 * Information about a message that later repeats can be collapsed into.
+	 */
+	struct RepeatInfo
+	{
+		/**
+		 * The ID of the row in the display view showing the message.
+		 */
+		int _RowId = -1;
+
+		/**
+		 * The number of times the message has been received.
+		 */
+		int _Count = 1;
+
+		/**
+		 * The time the message was last received, in milliseconds since the epoch.
+		 */
+		qint64 _LastSeen = 0;
+	};
+
+	/**
+	 * The messages shown within the repeat window, indexed by sender and contents.
+	 */
+	QHash<QPair<QString, QString>, RepeatInfo> _Repeats;
+
+	/**
+	 * The keys of _Repeats in the order they were last seen, used to expire them when the window passes.
+	 */
+	QQueue<QPair<qint64, QPair<QString, QString>>> _RepeatQueue;
+
+	/**
+	 * The views in the whisper tabs, indexed by the player being whispered.
+	 */
+	QHash<QString, PChatView *> _WhisperViews;
+
+	/**
+	 * The whisper views holding their conversation, from least to most recently used.
+	 */
+	QList<PChatView *> _LiveWhisperViews;
+
+	/**
+	 * The number of whisper conversations kept in memory.
 	 */
-	int _TopIdx = 0;
+	int _WhisperViewLimit = 20;
 
 	/**
 	 * The channel selection menu.
@@ -0,0 +1,164 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PCommandQueue.h"
+#include "PInputInjector.h"
+#include <QtMath>
+
+namespace
+{
+	/**
+	 * The number of commands that can be sent back to back by default.
+	 */
+	const int _DefaultBurst = 3;
+
+	/**
+	 * The time it takes to earn another command by default, in milliseconds. This keeps macros under the game's
+	 * chat flood limit.
+	 */
+	const int _DefaultRefillInterval = 1000;
+
+	/**
+	 * The time given to the game to take a line, in milliseconds. Lines are pasted and the game reads the
+	 * clipboard when it handles the paste, so the next line can't replace the clipboard and the user's clipboard
+	 * and focus can't be given back before then.
+	 */
+	const int _PasteDelay = 50;
+}
+
+PCommandQueue::PCommandQueue(PInputInjector *injector, QObject *parent):
+QObject(parent),
+_Injector(injector)
+{
+	_Clock.start();
+	_PumpTimer.setSingleShot(true);
+	connect(&_PumpTimer, &QTimer::timeout, this, &PCommandQueue::Pump);
+	SetRateLimit(_DefaultBurst, _DefaultRefillInterval);
+}
+
+PCommandQueue::~PCommandQueue()
+{
+	delete _Injector;
+}
+
+PInputInjector * PCommandQueue::GetInjector() const
+{
+	return _Injector;
+}
+
+void PCommandQueue::SetInjector(PInputInjector *injector)
+{
+	if (injector == _Injector) return;
+	if (_BurstOpen) _Injector->EndBurst(_RestoreFocus);
+	delete _Injector;
+	_Injector = injector;
+	_BurstOpen = false;
+	_RestoreFocus = false;
+}
+
+void PCommandQueue::SetRateLimit(int burst, int refillInterval)
+{
+	_Burst = qMax(1, burst);
+	_RefillInterval = qMax(1, refillInterval);
+	_Tokens = _Burst;
+	_LastRefill = _Clock.elapsed();
+}
+
+int PCommandQueue::Enqueue(const QString &text, const QString &coalesceKey /*= QString()*/, 
+	bool retainFocus /*= true*/)
+{
+	if (!coalesceKey.isEmpty())
+	{
+		for (auto iter = _Queue.begin(); iter != _Queue.end();)
+		{
+			if (iter->_CoalesceKey != coalesceKey) ++iter;
+			else
+			{
+				auto id = iter->_Id;
+				iter = _Queue.erase(iter);
+				emit CommandStateChanged(id, Dropped);
+			}
+		}
+	}
+	Command command;
+	command._Id = _NextId++;
+	command._Text = text;
+	command._CoalesceKey = coalesceKey;
+	command._RetainFocus = retainFocus;
+	_Queue.append(command);
+	emit CommandStateChanged(command._Id, Queued);
+	Schedule(0);
+	return command._Id;
+}
+
+int PCommandQueue::GetPendingCount() const
+{
+	return _Queue.length();
+}
+
+void PCommandQueue::Clear()
+{
+	auto dropped = _Queue;
+	_Queue.clear();
+	for (const auto &command : dropped) emit CommandStateChanged(command._Id, Dropped);
+}
+
+void PCommandQueue::Pump()
+{
+	Refill();
+	if (_Queue.isEmpty() || _Tokens < 1.0)
+	{
+		// Nothing more is going out right away, so this is the end of the burst.
+		if (_BurstOpen)
+		{
+			_Injector->EndBurst(_RestoreFocus);
+			_BurstOpen = false;
+			_RestoreFocus = false;
+		}
+		if (!_Queue.isEmpty()) Schedule(qCeil((1.0 - _Tokens) * _RefillInterval));
+		return;
+	}
+	_Tokens -= 1.0;
+	auto command = _Queue.takeFirst();
+	emit CommandStateChanged(command._Id, Sending);
+	// A failed line may still have touched the clipboard, so it takes part in the burst either way.
+	_BurstOpen = true;
+	if (_Injector->SendChatLine(command._Text))
+	{
+		// The last line of the burst decides whether focus goes back.
+		_RestoreFocus = command._RetainFocus;
+		emit CommandStateChanged(command._Id, Sent);
+		emit CommandSent(command._Id, command._Text);
+	}
+	else
+	{
+		emit CommandStateChanged(command._Id, Failed);
+		emit CommandFailed(command._Id, command._Text);
+	}
+	Schedule(_PasteDelay);
+}
+
+void PCommandQueue::Refill()
+{
+	auto now = _Clock.elapsed();
+	_Tokens = qMin(static_cast<double>(_Burst), _Tokens + static_cast<double>(now - _LastRefill) / _RefillInterval);
+	_LastRefill = now;
+}
+
+void PCommandQueue::Schedule(int delay)
+{
+	if (_PumpTimer.isActive()) return;
+	_PumpTimer.start(delay);
+}
@@ -0,0 +1,245 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+class PInputInjector;
+
+/**
+ * Sends chat lines and commands to the game one at a time, at a rate the game's flood limit accepts.
+ * Lines are queued and sent from the event loop, so the caller never waits on the game and two sources sending
+ * at once can't interleave their keystrokes. Sending is limited by a token bucket: a short burst goes out right
+ * away and the rest follow at the refill rate. A queued command that sets some state, like the status message,
+ * replaces an earlier queued command that sets the same state, and focus is only handed back once the queue has
+ * nothing left to send right away.
+ */
+class PCommandQueue : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * The states a command goes through.
+	 */
+	enum State
+	{
+		Queued,			///< Waiting for its turn or for the rate limit.
+		Sending,		///< Being typed into the game.
+		Sent,			///< Delivered to the game.
+		Failed,			///< The game couldn't be reached.
+		Dropped			///< Replaced by a later command or discarded before it was sent.
+	};
+	Q_ENUM(State)
+
+	/**
+	 * Creates a new command queue.
+	 * @param[in] injector
+	 *   The backend that delivers lines to the game. The queue takes ownership of it.
+	 * @param[in] parent
+	 *   The parent of the queue.
+	 */
+	PCommandQueue(PInputInjector *injector, QObject *parent = nullptr);
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~PCommandQueue();
+
+	/**
+	 * Retrieves the backend that delivers lines to the game.
+	 * @return
+	 *   The injector.
+	 */
+	PInputInjector * GetInjector() const;
+
+	/**
+	 * Replaces the backend that delivers lines to the game.
+	 * @param[in] injector
+	 *   The new injector. The queue takes ownership of it and deletes the previous one.
+	 */
+	void SetInjector(PInputInjector *injector);
+
+	/**
+	 * Sets how fast commands may be sent.
+	 * @param[in] burst
+	 *   The number of commands that can be sent back to back after the queue has been idle.
+	 * @param[in] refillInterval
+	 *   The time it takes to earn another command once the burst is used up, in milliseconds.
+	 */
+	void SetRateLimit(int burst, int refillInterval);
+
+	/**
+	 * Queues a line to be sent.
+	 * @param[in] text
+	 *   The complete line, including any channel prefix.
+	 * @param[in] coalesceKey
+	 *   Identifies the state the line sets. A queued line with the same key is replaced by this one. Lines with
+	 *   an empty key are never replaced.
+	 * @param[in] retainFocus
+	 *   true if focus should go back to the previous window after the line is sent, false otherwise.
+	 * @return
+	 *   The ID of the command.
+	 */
+	int Enqueue(const QString &text, const QString &coalesceKey = QString(), bool retainFocus = true);
+
+	/**
+	 * Retrieves the number of commands waiting to be sent.
+	 * @return
+	 *   The number of queued commands.
+	 */
+	int GetPendingCount() const;
+
+	/**
+	 * Drops every command that hasn't been sent yet.
+	 */
+	void Clear();
+
+signals:
+
+	/**
+	 * Signal sent when a command changes state.
+	 * @param[in] id
+	 *   The ID of the command.
+	 * @param[in] state
+	 *   The new state of the command.
+	 */
+	void CommandStateChanged(int id, PCommandQueue::State state);
+
+	/**
+	 * Signal sent when a command has been delivered to the game.
+	 * @param[in] id
+	 *   The ID of the command.
+	 * @param[in] text
+	 *   The line that was sent.
+	 */
+	void CommandSent(int id, const QString &text);
+
+	/**
+	 * Signal sent when a command couldn't be delivered to the game.
+	 * @param[in] id
+	 *   The ID of the command.
+	 * @param[in] text
+	 *   The line that wasn't sent.
+	 */
+	void CommandFailed(int id, const QString &text);
+
+private slots:
+
+	/**
+	 * Slot called to send the next command, or to end the burst when there's nothing left to send right away.
+	 */
+	void Pump();
+
+private:
+
+	/**
+	 * A command waiting to be sent.
+	 */
+	struct Command
+	{
+		/**
+		 * The ID of the command.
+		 */
+		int _Id = 0;
+
+		/**
+		 * The line to send.
+		 */
+		QString _Text;
+
+		/**
+		 * Identifies the state the line sets, or empty if it can't be replaced.
+		 */
+		QString _CoalesceKey;
+
+		/**
+		 * Indicates whether focus goes back to the previous window after the line is sent.
+		 */
+		bool _RetainFocus = true;
+	};
+
+	/**
+	 * Adds the tokens earned since the last refill.
+	 */
+	void Refill();
+
+	/**
+	 * Schedules the next pump, unless one is already scheduled.
+	 * @param[in] delay
+	 *   The time to wait, in milliseconds.
+	 */
+	void Schedule(int delay);
+
+	/**
+	 * The backend that delivers lines to the game.
+	 */
+	PInputInjector *_Injector = nullptr;
+
+	/**
+	 * The commands waiting to be sent, oldest first.
+	 */
+	QList<Command> _Queue;
+
+	/**
+	 * The ID given to the next command.
+	 */
+	int _NextId = 1;
+
+	/**
+	 * The number of commands that can be sent back to back after the queue has been idle.
+	 */
+	int _Burst = 0;
+
+	/**
+	 * The time it takes to earn another command, in milliseconds.
+	 */
+	int _RefillInterval = 0;
+
+	/**
+	 * The number of commands that can be sent right now. Fractions accumulate between refills.
+	 */
+	double _Tokens = 0;
+
+	/**
+	 * The time of the last refill.
+	 */
+	qint64 _LastRefill = 0;
+
+	/**
+	 * The clock the rate limit is measured with.
+	 */
+	QElapsedTimer _Clock;
+
+	/**
+	 * Indicates whether a line has been sent since the last burst ended.
+	 */
+	bool _BurstOpen = false;
+
+	/**
+	 * Indicates whether focus should go back to the previous window when the burst ends.
+	 */
+	bool _RestoreFocus = false;
+
+	/**
+	 * The timer that drives the queue.
+	 */
+	QTimer _PumpTimer;
+};
@@ -0,0 +1,90 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PCommandStatsWidget.h"
+#include "PApplication.h"
+#include "PCommandTracker.h"
+#include "PMessageHandler.h"
+
+namespace
+{
+	/**
+	 * Retrieves the command tracker of the application.
+	 */
+	PCommandTracker * GetTracker()
+	{
+		auto app = qobject_cast<PApplication *>(qApp);
+		Q_ASSERT(app);
+		auto handler = app->GetMessageHandler();
+		Q_ASSERT(handler);
+		return handler->GetCommandTracker();
+	}
+}
+
+PCommandStatsWidget::PCommandStatsWidget(QWidget *parent)
+	: QDockWidget(parent)
+{
+	ui.setupUi(this);
+	auto tracker = GetTracker();
+	connect(tracker, &PCommandTracker::StatisticsChanged, this, &PCommandStatsWidget::OnStatisticsChanged);
+	connect(ui._ResetBtn, &QPushButton::clicked, tracker, &PCommandTracker::Reset);
+}
+
+PCommandStatsWidget::~PCommandStatsWidget()
+{
+}
+
+void PCommandStatsWidget::Refresh()
+{
+	auto tracker = GetTracker();
+	auto bounds = PCommandTracker::GetBucketBounds();
+	ui._StatsTree->clear();
+	for (const auto &type : tracker->GetCommandTypes())
+	{
+		auto stats = tracker->GetStatistics(type);
+		auto item = new QTreeWidgetItem(ui._StatsTree);
+		item->setText(0, type);
+		item->setText(1, QString::number(stats._Confirmed));
+		item->setText(2, QString::number(stats._Failed));
+		item->setText(3, QString::number(stats._Unconfirmed));
+		if (stats._Confirmed > 0)
+		{
+			item->setText(4, QString::number(stats._Total / stats._Confirmed));
+			item->setText(5, QString::number(stats._Min));
+			item->setText(6, QString::number(stats._Max));
+		}
+		// One child per histogram bucket, with the count in the confirmed column.
+		for (int b = 0; b < stats._Buckets.length(); ++b)
+		{
+			auto bucketItem = new QTreeWidgetItem(item);
+			bucketItem->setText(0, b < bounds.length() ? tr("Up to %1 ms").arg(bounds.at(b)) : 
+				tr("Over %1 ms").arg(bounds.last()));
+			bucketItem->setText(1, QString::number(stats._Buckets.at(b)));
+		}
+	}
+	ui._InFlightLabel->setText(tr("Awaiting echo: %1").arg(tracker->GetInFlightCount()));
+}
+
+void PCommandStatsWidget::showEvent(QShowEvent *evt)
+{
+	QDockWidget::showEvent(evt);
+	Refresh();
+}
+
+void PCommandStatsWidget::OnStatisticsChanged()
+{
+	// Hidden docks catch up when they are shown.
+	if (isVisible()) Refresh();
+}
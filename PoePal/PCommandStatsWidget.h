@@ -0,0 +1,64 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QDockWidget>
+#include "ui_PCommandStatsWidget.h"
+
+/**
+ * Dock widget showing how long the commands sent to the game take to show up in the log.
+ */
+class PCommandStatsWidget : public QDockWidget
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * Creates a new instance of this widget.
+	 */
+	PCommandStatsWidget(QWidget *parent = Q_NULLPTR);
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~PCommandStatsWidget();
+
+public slots:
+
+	/**
+	 * Fills the tree with the current statistics.
+	 */
+	void Refresh();
+
+protected:
+
+	/**
+	 * Overrides QDockWidget#showEvent.
+	 */
+	virtual void showEvent(QShowEvent *evt) override;
+
+private slots:
+
+	/**
+	 * Slot called when the statistics change.
+	 */
+	void OnStatisticsChanged();
+
+private:
+
+	Ui::PCommandStatsWidget ui;
+};
@@ -0,0 +1,237 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PCommandTracker.h"
+#include "PCommandQueue.h"
+#include "PMessageBus.h"
+#include <algorithm>
+
+namespace
+{
+	/**
+	 * The time an echo has to show up before its command is counted as unconfirmed, in milliseconds.
+	 */
+	const int _EchoTimeout = 10000;
+
+	/**
+	 * The time between checks for commands whose echo hasn't shown up, in milliseconds.
+	 */
+	const int _ExpireInterval = 1000;
+}
+
+PCommandTracker::PCommandTracker(PCommandQueue *queue, PMessageBus *bus, QObject *parent):
+QObject(parent)
+{
+	_Clock.start();
+	_ExpireTimer.setInterval(_ExpireInterval);
+	connect(&_ExpireTimer, &QTimer::timeout, this, &PCommandTracker::OnExpireTimer);
+	connect(queue, &PCommandQueue::CommandSent, this, &PCommandTracker::OnCommandSent);
+	connect(queue, &PCommandQueue::CommandFailed, this, &PCommandTracker::OnCommandFailed);
+	// Echoes are either the line itself in its channel or a notice from the game.
+	PMessageBus::Subscription subscription;
+	subscription._Subtypes = {PMessage::Chat, PMessage::Event};
+	for (auto channel : PMessage::GetChannels()) subscription._Channels |= channel;
+	bus->Subscribe(subscription, this, [this](PMessage *message) { OnNewMessage(message); });
+}
+
+PCommandTracker::~PCommandTracker()
+{
+}
+
+QVector<int> PCommandTracker::GetBucketBounds()
+{
+	return QVector<int>{50, 100, 200, 400, 800, 1600, 3200, 6400};
+}
+
+QStringList PCommandTracker::GetCommandTypes() const
+{
+	auto types = _Statistics.keys();
+	std::sort(types.begin(), types.end());
+	return types;
+}
+
+PCommandTracker::Statistics PCommandTracker::GetStatistics(const QString &type) const
+{
+	return _Statistics.value(type);
+}
+
+QVariantList PCommandTracker::GetStatisticsList() const
+{
+	auto bounds = GetBucketBounds();
+	QVariantList list;
+	for (const auto &type : GetCommandTypes())
+	{
+		const auto &stats = _Statistics[type];
+		QVariantList buckets;
+		for (int b = 0; b < stats._Buckets.length(); ++b)
+		{
+			buckets.append(QVariantMap{{QStringLiteral("upTo"), b < bounds.length() ? bounds.at(b) : 0},
+				{QStringLiteral("count"), stats._Buckets.at(b)}});
+		}
+		list.append(QVariantMap{
+			{QStringLiteral("type"), type},
+			{QStringLiteral("confirmed"), stats._Confirmed},
+			{QStringLiteral("failed"), stats._Failed},
+			{QStringLiteral("unconfirmed"), stats._Unconfirmed},
+			{QStringLiteral("min"), stats._Min},
+			{QStringLiteral("max"), stats._Max},
+			{QStringLiteral("mean"), stats._Confirmed > 0 ? stats._Total / stats._Confirmed : 0},
+			{QStringLiteral("buckets"), buckets}
+		});
+	}
+	return list;
+}
+
+int PCommandTracker::GetInFlightCount() const
+{
+	return _InFlight.length();
+}
+
+void PCommandTracker::Reset()
+{
+	_InFlight.clear();
+	_Statistics.clear();
+	_ExpireTimer.stop();
+	emit StatisticsChanged();
+}
+
+void PCommandTracker::OnCommandSent(int id, const QString &text)
+{
+	auto command = Describe(text);
+	// A command without a notice of its own can't be told apart from other notices, so it has no round trip.
+	if (command._Subtype == PMessage::Event && command._Notice.pattern().isEmpty())
+	{
+		++GetStatisticsRef(command._Type)._Unconfirmed;
+		emit StatisticsChanged();
+		return;
+	}
+	command._Id = id;
+	command._SentAt = _Clock.elapsed();
+	_InFlight.append(command);
+	if (!_ExpireTimer.isActive()) _ExpireTimer.start();
+	emit StatisticsChanged();
+}
+
+void PCommandTracker::OnCommandFailed(int id, const QString &text)
+{
+	Q_UNUSED(id);
+	++GetStatisticsRef(Describe(text)._Type)._Failed;
+	emit StatisticsChanged();
+}
+
+void PCommandTracker::OnExpireTimer()
+{
+	auto cutoff = _Clock.elapsed() - _EchoTimeout;
+	bool changed = false;
+	while (!_InFlight.isEmpty() && _InFlight.first()._SentAt < cutoff)
+	{
+		++GetStatisticsRef(_InFlight.takeFirst()._Type)._Unconfirmed;
+		changed = true;
+	}
+	if (_InFlight.isEmpty()) _ExpireTimer.stop();
+	if (changed) emit StatisticsChanged();
+}
+
+PCommandTracker::InFlight PCommandTracker::Describe(const QString &text) const
+{
+	// The notices the game prints for the commands that have one. The travel commands are matched by the area
+	// entered, since every area change prints the same notice, and /passives by the first line of its summary.
+	// Commands missing here have no round trip.
+	static const QHash<QString, QRegularExpression> notices{
+		{QStringLiteral("hideout"), QRegularExpression(tr("^You have entered .*Hideout\\.$"))},
+		{QStringLiteral("menagerie"), QRegularExpression(tr("^You have entered The Menagerie\\.$"))},
+		{QStringLiteral("delve"), QRegularExpression(tr("^You have entered Azurite Mine\\.$"))},
+		{QStringLiteral("afk"), QRegularExpression(tr("^AFK mode is now (ON|OFF)\\."))},
+		{QStringLiteral("dnd"), QRegularExpression(tr("^DND mode is now (ON|OFF)\\."))},
+		{QStringLiteral("autoreply"), QRegularExpression(tr("^Autoreply "))},
+		{QStringLiteral("remaining"), QRegularExpression(tr("monsters? remains?\\.$"))},
+		{QStringLiteral("passives"), 
+			QRegularExpression(tr("^\\d+\\s+total\\s+Passive\\s+Skill Points\\s+\\(\\d+\\s+allocated\\)$"))}
+	};
+	InFlight command;
+	if (text.startsWith('/'))
+	{
+		command._Type = text.mid(1).section(' ', 0, 0).toLower();
+		command._Subtype = PMessage::Event;
+		auto notice = notices.constFind(command._Type);
+		if (notice != notices.constEnd()) command._Notice = *notice;
+		return command;
+	}
+	command._Subtype = PMessage::Chat;
+	command._Channel = text.isEmpty() ? PMessage::InvalidChannel : PMessage::GetChannelFromPrefix(text.at(0));
+	auto body = text;
+	if (command._Channel == PMessage::InvalidChannel || command._Channel == PMessage::Local) 
+	{
+		command._Channel = PMessage::Local;
+	}
+	else body = text.mid(1);
+	if (command._Channel == PMessage::Whisper)
+	{
+		auto space = body.indexOf(' ');
+		command._Type = QStringLiteral("whisper");
+		command._Target = body.left(space);
+		command._Echo = space < 0 ? QString() : body.mid(space + 1);
+	}
+	else
+	{
+		command._Type = QStringLiteral("chat");
+		command._Echo = body;
+	}
+	return command;
+}
+
+bool PCommandTracker::IsEcho(const InFlight &command, PMessage *message) const
+{
+	if (message->GetSubtype() != command._Subtype) return false;
+	if (command._Subtype == PMessage::Event)
+	{
+		return command._Notice.match(message->GetContents()).hasMatch();
+	}
+	if (message->GetChannel() != command._Channel || message->GetContents() != command._Echo) return false;
+	if (command._Channel != PMessage::Whisper) return true;
+	return !message->IsIncoming() && message->GetSubject().compare(command._Target, Qt::CaseInsensitive) == 0;
+}
+
+void PCommandTracker::OnNewMessage(PMessage *message)
+{
+	if (_InFlight.isEmpty()) return;
+	for (auto iter = _InFlight.begin(); iter != _InFlight.end(); ++iter)
+	{
+		if (!IsEcho(*iter, message)) continue;
+		auto latency = _Clock.elapsed() - iter->_SentAt;
+		auto &stats = GetStatisticsRef(iter->_Type);
+		auto bounds = GetBucketBounds();
+		++stats._Buckets[std::lower_bound(bounds.begin(), bounds.end(), latency) - bounds.begin()];
+		stats._Min = stats._Confirmed == 0 ? latency : qMin(stats._Min, latency);
+		stats._Max = qMax(stats._Max, latency);
+		stats._Total += latency;
+		++stats._Confirmed;
+		_InFlight.erase(iter);
+		if (_InFlight.isEmpty()) _ExpireTimer.stop();
+		emit StatisticsChanged();
+		return;
+	}
+}
+
+PCommandTracker::Statistics & PCommandTracker::GetStatisticsRef(const QString &type)
+{
+	auto iter = _Statistics.find(type);
+	if (iter == _Statistics.end())
+	{
+		iter = _Statistics.insert(type, Statistics());
+		iter->_Buckets.fill(0, GetBucketBounds().length() + 1);
+	}
+	return *iter;
+}
@@ -0,0 +1,282 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "PMessage.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QRegularExpression>
+#include <QTimer>
+#include <QVariantList>
+#include <QVector>
+
+class PCommandQueue;
+class PMessageBus;
+
+/**
+ * Measures how long commands sent to the game take to show up in the log.
+ * Each line the command queue delivers is remembered with the time it was sent, along with what its echo in the
+ * log looks like: the outgoing whisper, the line in the channel, or the notice the game prints for a command.
+ * When the echo is parsed, the round trip is added to a latency histogram for that kind of command. Lines that
+ * never reach the game, and lines whose echo doesn't show up in time, are counted as failures.
+ */
+class PCommandTracker : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * The statistics for one kind of command.
+	 */
+	struct Statistics
+	{
+		/**
+		 * The number of round trips in each latency bucket. The last bucket holds everything above the last bound.
+		 */
+		QVector<int> _Buckets;
+
+		/**
+		 * The number of commands whose echo was seen.
+		 */
+		int _Confirmed = 0;
+
+		/**
+		 * The number of commands that couldn't be delivered to the game.
+		 */
+		int _Failed = 0;
+
+		/**
+		 * The number of commands whose echo didn't show up in time or that have no recognizable echo.
+		 */
+		int _Unconfirmed = 0;
+
+		/**
+		 * The sum of the round trips, in milliseconds.
+		 */
+		qint64 _Total = 0;
+
+		/**
+		 * The shortest round trip, in milliseconds.
+		 */
+		qint64 _Min = 0;
+
+		/**
+		 * The longest round trip, in milliseconds.
+		 */
+		qint64 _Max = 0;
+	};
+
+	/**
+	 * Creates a new tracker.
+	 * @param[in] queue
+	 *   The queue the commands are sent through.
+	 * @param[in] bus
+	 *   The bus the echoes are delivered on.
+	 * @param[in] parent
+	 *   The parent of the tracker.
+	 */
+	PCommandTracker(PCommandQueue *queue, PMessageBus *bus, QObject *parent = nullptr);
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~PCommandTracker();
+
+	/**
+	 * Retrieves the upper bounds of the latency buckets.
+	 * @return
+	 *   The bounds in milliseconds, in increasing order.
+	 */
+	static QVector<int> GetBucketBounds();
+
+	/**
+	 * Retrieves the kinds of commands that have been sent.
+	 * @return
+	 *   The kinds, sorted by name. Chat lines are "whisper" or "chat" and commands are their name.
+	 */
+	QStringList GetCommandTypes() const;
+
+	/**
+	 * Retrieves the statistics for one kind of command.
+	 * @param[in] type
+	 *   The kind of command.
+	 * @return
+	 *   The statistics.
+	 */
+	Statistics GetStatistics(const QString &type) const;
+
+	/**
+	 * Retrieves the statistics for every kind of command in a form scripts can use.
+	 * @return
+	 *   A list of objects with the type, confirmed, failed, unconfirmed, min, max and mean values, and buckets as
+	 *   a list of objects with an upTo bound (0 for the last one) and a count.
+	 */
+	Q_INVOKABLE QVariantList GetStatisticsList() const;
+
+	/**
+	 * Retrieves the number of commands whose echo hasn't been seen yet.
+	 * @return
+	 *   The number of commands in flight.
+	 */
+	Q_INVOKABLE int GetInFlightCount() const;
+
+public slots:
+
+	/**
+	 * Forgets all of the statistics gathered so far.
+	 */
+	void Reset();
+
+signals:
+
+	/**
+	 * Signal sent when the statistics change.
+	 */
+	void StatisticsChanged();
+
+private slots:
+
+	/**
+	 * Slot called when the queue delivers a command to the game.
+	 * @param[in] id
+	 *   The ID of the command.
+	 * @param[in] text
+	 *   The line that was sent.
+	 */
+	void OnCommandSent(int id, const QString &text);
+
+	/**
+	 * Slot called when the queue couldn't deliver a command to the game.
+	 * @param[in] id
+	 *   The ID of the command.
+	 * @param[in] text
+	 *   The line that wasn't sent.
+	 */
+	void OnCommandFailed(int id, const QString &text);
+
+	/**
+	 * Slot called periodically to give up on commands whose echo hasn't shown up.
+	 */
+	void OnExpireTimer();
+
+private:
+
+	/**
+	 * A command whose echo hasn't been seen yet.
+	 */
+	struct InFlight
+	{
+		/**
+		 * The ID of the command.
+		 */
+		int _Id = 0;
+
+		/**
+		 * The kind of command.
+		 */
+		QString _Type;
+
+		/**
+		 * The subtype of the echo.
+		 */
+		PMessage::Subtype _Subtype = PMessage::Event;
+
+		/**
+		 * The channel of the echo, for chat lines.
+		 */
+		PMessage::Channel _Channel = PMessage::InvalidChannel;
+
+		/**
+		 * The player a whisper was sent to.
+		 */
+		QString _Target;
+
+		/**
+		 * The contents of a chat line.
+		 */
+		QString _Echo;
+
+		/**
+		 * The notice the game prints for a command. The pattern is empty if the command has no notice that can be
+		 * told apart from other notices.
+		 */
+		QRegularExpression _Notice;
+
+		/**
+		 * The time the command was sent, on the tracker's clock.
+		 */
+		qint64 _SentAt = 0;
+	};
+
+	/**
+	 * Works out what the echo of a line looks like.
+	 * @param[in] text
+	 *   The line that was sent.
+	 * @return
+	 *   The command with everything but the ID and send time filled in.
+	 */
+	InFlight Describe(const QString &text) const;
+
+	/**
+	 * Checks whether a message is the echo of a command.
+	 * @param[in] command
+	 *   The command.
+	 * @param[in] message
+	 *   The message.
+	 * @return
+	 *   true if the message is the echo, false otherwise.
+	 */
+	bool IsEcho(const InFlight &command, PMessage *message) const;
+
+	/**
+	 * Called with each new chat message and game notice.
+	 * @param[in] message
+	 *   The message.
+	 */
+	void OnNewMessage(PMessage *message);
+
+	/**
+	 * Retrieves the statistics for a kind of command, creating them if needed.
+	 * @param[in] type
+	 *   The kind of command.
+	 * @return
+	 *   The statistics.
+	 */
+	Statistics & GetStatisticsRef(const QString &type);
+
+	/**
+	 * The commands whose echo hasn't been seen yet, oldest first.
+	 */
+	QList<InFlight> _InFlight;
+
+	/**
+	 * The statistics, by kind of command.
+	 */
+	QHash<QString, Statistics> _Statistics;
+
+	/**
+	 * The clock the round trips are measured with.
+	 */
+	QElapsedTimer _Clock;
+
+	/**
+	 * The timer that gives up on commands whose echo hasn't shown up.
+	 */
+	QTimer _ExpireTimer;
+};
@@ -0,0 +1,119 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+#include <QWindowDefs>
+
+/**
+ * Reports which window is in the foreground as it changes.
+ * Windows are identified by their native handle and the ID of the process that owns them, and the source tells
+ * whether the window belongs to the game, so consumers never have to look at window titles. The Win32 backend is
+ * driven by the system's foreground events, and the simulated backend is driven by hand so the overlay logic can be
+ * exercised without a Windows desktop.
+ */
+class PFocusSource : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * Creates a new focus source.
+	 * @param[in] parent
+	 *   The parent of the focus source.
+	 */
+	PFocusSource(QObject *parent = nullptr);
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~PFocusSource();
+
+	/**
+	 * Starts reporting foreground changes. ForegroundChanged is sent right away with the current foreground window.
+	 */
+	virtual void Start() = 0;
+
+	/**
+	 * Retrieves the window that was last reported to be in the foreground.
+	 * @return
+	 *   The native handle of the window, or 0 if there is none.
+	 */
+	WId GetForegroundWindow() const;
+
+	/**
+	 * Retrieves the process owning the window that was last reported to be in the foreground.
+	 * @return
+	 *   The ID of the process, or 0 if there is none.
+	 */
+	qint64 GetForegroundProcess() const;
+
+	/**
+	 * Indicates whether the window that was last reported to be in the foreground belongs to the game.
+	 * @return
+	 *   true if the game is in the foreground, false otherwise.
+	 */
+	bool IsGameInForeground() const;
+
+signals:
+
+	/**
+	 * Signal sent when another window comes to the foreground.
+	 * @param[in] window
+	 *   The native handle of the window.
+	 * @param[in] processId
+	 *   The ID of the process owning the window.
+	 * @param[in] game
+	 *   true if the window belongs to the game, false otherwise.
+	 */
+	void ForegroundChanged(WId window, qint64 processId, bool game);
+
+protected:
+
+	/**
+	 * Records a new foreground window and reports it if it changed.
+	 * @param[in] window
+	 *   The native handle of the window.
+	 * @param[in] processId
+	 *   The ID of the process owning the window.
+	 * @param[in] game
+	 *   true if the window belongs to the game, false otherwise.
+	 */
+	void SetForeground(WId window, qint64 processId, bool game);
+
+private:
+
+	/**
+	 * The window in the foreground.
+	 */
+	WId _Window = 0;
+
+	/**
+	 * The process owning the window in the foreground.
+	 */
+	qint64 _ProcessId = 0;
+
+	/**
+	 * Indicates whether the window in the foreground belongs to the game.
+	 */
+	bool _Game = false;
+
+	/**
+	 * Indicates whether a foreground window has been reported yet.
+	 */
+	bool _Reported = false;
+};
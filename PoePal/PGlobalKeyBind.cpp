@@ -15,10 +15,14 @@
  */
 #include "PGlobalKeyBind.h"
 #include "PApplication.h"
+#include "PCommandQueue.h"
 #include "PGlobalKeyBindManager.h"
+#include "PKeyChordEngine.h"
+#include "PMessageHandler.h"
+#include <QDebug>
 
 PGlobalKeyBind::PGlobalKeyBind(QObject* parent):
-QObject(parent),_Sequence(new UKeySequence())
+QObject(parent)
 {
 
 }
@@ -55,16 +59,60 @@ void PGlobalKeyBind::SetTooltip(const QString& tooltip)
 
 QString PGlobalKeyBind::GetKeySequence() const
 {
-	return const_cast<PGlobalKeyBind*>(this)->_Sequence->ToString(); // fix const issue in UKeySequence
+	return _Sequence.toString(QKeySequence::PortableText);
 }
 
 void PGlobalKeyBind::SetKeySequence(const QString& sequence)
 {
-	if (_Sequence->ToString().toLower() != sequence.toLower())
+	auto newSequence = PKeyChordEngine::ParseSequence(sequence);
+	if (newSequence != _Sequence)
 	{
-		_Sequence.reset(new UKeySequence());
-		if (!sequence.isEmpty()) _Sequence->FromString(sequence);
-		emit KeySequenceChanged(*_Sequence);
+		_Sequence = newSequence;
+		emit KeySequenceChanged(_Sequence);
 	}
 }
 
+PGlobalKeyBind::Context PGlobalKeyBind::GetContext() const
+{
+	return _Context;
+}
+
+void PGlobalKeyBind::SetContext(Context context)
+{
+	if (context != _Context)
+	{
+		_Context = context;
+		emit ContextChanged(context);
+	}
+}
+
+QStringList PGlobalKeyBind::GetCommands() const
+{
+	return _Commands;
+}
+
+void PGlobalKeyBind::SetCommands(const QStringList& commands)
+{
+	if (!_IsBuiltIn) _Commands = commands;
+}
+
+void PGlobalKeyBind::SetCallback(const QJSValue& callback)
+{
+	_Callback = callback;
+}
+
+void PGlobalKeyBind::Trigger()
+{
+	emit Triggered();
+	if (_Callback.isCallable())
+	{
+		auto result = _Callback.call();
+		if (result.isError()) qWarning() << "Key bind" << _ID << "failed:" << result.toString();
+	}
+	if (_Commands.isEmpty()) return;
+	auto app = qobject_cast<PApplication*>(qApp);
+	Q_ASSERT(app);
+	auto queue = app->GetMessageHandler()->GetCommandQueue();
+	for (const auto& command : _Commands) queue->Enqueue(command);
+}
+
@@ -15,8 +15,10 @@
  */
 #pragma once
 
-#include <ukeysequence.h>
+#include <QJSValue>
+#include <QKeySequence>
 #include <QObject>
+#include <QStringList>
 
 /**
  * A macro that can be triggered via a global keyboard shortcut.
@@ -48,12 +50,33 @@ class PGlobalKeyBind : public QObject
 	Q_PROPERTY(QString tooltip READ GetTooltip WRITE SetTooltip)
 
 	/**
-	 * The key sequence that triggers the macro as a string.
+	 * The key sequence that triggers the macro as a string. Strokes of a multi-stroke sequence are separated by
+	 * commas, such as "Ctrl+K, H".
 	 */
 	Q_PROPERTY(QString keySequence READ GetKeySequence WRITE SetKeySequence)
 
+	/**
+	 * When the macro can be triggered.
+	 */
+	Q_PROPERTY(Context context READ GetContext WRITE SetContext NOTIFY ContextChanged)
+
+	/**
+	 * The chat commands queued when the macro is triggered.
+	 */
+	Q_PROPERTY(QStringList commands READ GetCommands WRITE SetCommands)
+
 public:
 
+	/**
+	 * When a macro can be triggered.
+	 */
+	enum Context
+	{
+		Anywhere, ///< The macro can be triggered whichever window is focused.
+		GameFocused ///< The macro can only be triggered while the game or the overlay is focused.
+	};
+	Q_ENUM(Context);
+
 	/**
 	 * Indicates whether or not the macro is a built-in macro.
 	 * @return
@@ -112,6 +135,43 @@ public:
 	 */
 	void SetKeySequence(const QString& sequence);
 
+	/**
+	 * Retrieves when the macro can be triggered.
+	 * @return
+	 *   The context of the macro.
+	 */
+	Context GetContext() const;
+
+	/**
+	 * Sets when the macro can be triggered.
+	 * @param[in] context
+	 *   The new context of the macro.
+	 */
+	void SetContext(Context context);
+
+	/**
+	 * Retrieves the chat commands queued when the macro is triggered.
+	 * @return
+	 *   The chat commands.
+	 */
+	QStringList GetCommands() const;
+
+	/**
+	 * Sets the chat commands queued when the macro is triggered.
+	 * This method does nothing if this is a built-in macro.
+	 * @param[in] commands
+	 *   The new chat commands.
+	 */
+	void SetCommands(const QStringList& commands);
+
+	/**
+	 * Sets a script function called when the macro is triggered. Script functions aren't saved with the macro,
+	 * so scripts set them each time they are loaded.
+	 * @param[in] callback
+	 *   The function to call, or undefined to remove the current one.
+	 */
+	Q_INVOKABLE void SetCallback(const QJSValue& callback);
+
 signals:
 
 	/**
@@ -124,7 +184,14 @@ signals:
 	 * @param[in] sequence
 	 *   The new key sequence.
 	 */
-	void KeySequenceChanged(const UKeySequence& sequence);
+	void KeySequenceChanged(const QKeySequence& sequence);
+
+	/**
+	 * Signal sent when the context changes.
+	 * @param[in] context
+	 *   The new context.
+	 */
+	void ContextChanged(Context context);
 
 private:
 
@@ -135,6 +202,11 @@ private:
 	 */
 	PGlobalKeyBind(QObject* parent);
 
+	/**
+	 * Triggers the macro. This emits Triggered, calls the script function and queues the chat commands.
+	 */
+	void Trigger();
+
 	/**
 	 * Indicates whether or not the macro is built-in.
 	 */
@@ -158,7 +230,22 @@ private:
 	/**
 	 * The key sequence that triggers the macro.
 	 */
-	QScopedPointer<UKeySequence> _Sequence;
+	QKeySequence _Sequence;
+
+	/**
+	 * When the macro can be triggered.
+	 */
+	Context _Context = Anywhere;
+
+	/**
+	 * The chat commands queued when the macro is triggered.
+	 */
+	QStringList _Commands;
+
+	/**
+	 * The script function called when the macro is triggered.
+	 */
+	QJSValue _Callback;
 
 	friend class PGlobalKeyBindManager;
 };
\ No newline at end of file
@@ -15,12 +15,21 @@
  */
 #include "PGlobalKeyBindManager.h"
 #include "PGlobalKeyBind.h"
+#include "PKeyChordEngine.h"
 #include <QSettings>
 
 PGlobalKeyBindManager::PGlobalKeyBindManager() :
 UGlobalHotkeys()
 {
+	_Chords = new PKeyChordEngine(this);
 	connect(this, &UGlobalHotkeys::activated, this, &PGlobalKeyBindManager::OnHotkeyTriggered);
+	connect(_Chords, &PKeyChordEngine::Triggered, this, &PGlobalKeyBindManager::OnChordTriggered);
+	connect(_Chords, &PKeyChordEngine::ExpectedStrokesChanged, this, &PGlobalKeyBindManager::UpdateHotkeys);
+}
+
+PKeyChordEngine* PGlobalKeyBindManager::GetChordEngine() const
+{
+	return _Chords;
 }
 
 QList<PGlobalKeyBind*> PGlobalKeyBindManager::GetKeyBinds() const
@@ -42,10 +51,11 @@ PGlobalKeyBind* PGlobalKeyBindManager::RegisterKeyBind(const QByteArray& id, con
 	keyBind->_ID = id;
 	keyBind->_Label = label;
 	keyBind->_Tooltip = tooltip;
-	keyBind->_Sequence->FromString(keySequence);
+	keyBind->_Sequence = PKeyChordEngine::ParseSequence(keySequence);
 	_KeyBindsByStringId.insert(id, keyBind);
 	UpdateKeySequence(keyBind);
 	connect(keyBind, &PGlobalKeyBind::KeySequenceChanged, this, &PGlobalKeyBindManager::OnKeySequenceModified);
+	connect(keyBind, &PGlobalKeyBind::ContextChanged, this, &PGlobalKeyBindManager::OnKeySequenceModified);
 	return keyBind;
 }
 
@@ -62,6 +72,7 @@ void PGlobalKeyBindManager::RemoveKeyBind(const QByteArray& id)
 	if (_KeyBindsByStringId.contains(id))
 	{
 		auto keyBind = _KeyBindsByStringId.take(id);
+		_Chords->RemoveBinding(id);
 		keyBind->deleteLater();
 	}
 }
@@ -89,6 +100,8 @@ void PGlobalKeyBindManager::SaveKeyBinds()
 			settings.setValue(QStringLiteral("Label"), keyBind->GetLabel());
 			settings.setValue(QStringLiteral("Tooltip"), keyBind->GetTooltip());
 			settings.setValue(QStringLiteral("KeySeq"), keyBind->GetKeySequence());
+			settings.setValue(QStringLiteral("Context"), static_cast<int>(keyBind->GetContext()));
+			settings.setValue(QStringLiteral("Commands"), keyBind->GetCommands());
 			settings.endGroup(); // iter.value->GetId();
 			settings.endGroup(); // custom
 		}
@@ -114,24 +127,32 @@ void PGlobalKeyBindManager::RestoreKeyBinds()
 	settings.endGroup(); // BuiltIn
 	// Load all of the custom key binds.
 	settings.beginGroup(QStringLiteral("Custom"));
-	for (const auto& idStr : settings.childKeys())
+	for (const auto& idStr : settings.childGroups())
 	{
 		auto id = idStr.toLatin1();
 		settings.beginGroup(id);
 		auto label = settings.value(QStringLiteral("Label")).toString();
 		auto tooltip = settings.value(QStringLiteral("Tooltip")).toString();
 		auto keySeq = settings.value(QStringLiteral("KeySeq")).toString();
+		auto context = static_cast<PGlobalKeyBind::Context>(settings.value(QStringLiteral("Context"), 
+			PGlobalKeyBind::Anywhere).toInt());
+		auto commands = settings.value(QStringLiteral("Commands")).toStringList();
 		auto keyBind = _KeyBindsByStringId.value(id, nullptr);
 		if (!keyBind)
 		{
 			keyBind = new PGlobalKeyBind(this);
 			_KeyBindsByStringId.insert(id, keyBind);
+			connect(keyBind, &PGlobalKeyBind::KeySequenceChanged, this, 
+				&PGlobalKeyBindManager::OnKeySequenceModified);
+			connect(keyBind, &PGlobalKeyBind::ContextChanged, this, &PGlobalKeyBindManager::OnKeySequenceModified);
 		}
 		keyBind->_IsBuiltIn = false;
 		keyBind->_ID = id;
 		keyBind->_Label = label;
 		keyBind->_Tooltip = tooltip;
-		keyBind->_Sequence->FromString(keySeq);
+		keyBind->_Sequence = PKeyChordEngine::ParseSequence(keySeq);
+		keyBind->_Context = context;
+		keyBind->_Commands = commands;
 		UpdateKeySequence(keyBind);
 		settings.endGroup(); // id
 	}
@@ -140,6 +161,18 @@ void PGlobalKeyBindManager::RestoreKeyBinds()
 
 }
 
+bool PGlobalKeyBindManager::SimulateStroke(const QString& stroke)
+{
+	auto sequence = PKeyChordEngine::ParseSequence(stroke);
+	if (sequence.count() != 1) return false;
+	return _Chords->Feed(sequence[0]) != PKeyChordEngine::Unmatched;
+}
+
+void PGlobalKeyBindManager::SetGameFocused(bool focused)
+{
+	_Chords->SetGameFocused(focused);
+}
+
 void PGlobalKeyBindManager::OnKeySequenceModified()
 {
 	auto keyBind = qobject_cast<PGlobalKeyBind*>(sender());
@@ -150,34 +183,45 @@ void PGlobalKeyBindManager::OnKeySequenceModified()
 
 void PGlobalKeyBindManager::OnHotkeyTriggered(size_t id)
 {
-	auto keyBind = _KeyBindsBySysId.value(id, nullptr);
-	if (keyBind) emit keyBind->Triggered();
+	if (_StrokesBySysId.contains(id)) _Chords->Feed(_StrokesBySysId.value(id));
 }
 
-void PGlobalKeyBindManager::UpdateKeySequence(PGlobalKeyBind* keyBind)
+void PGlobalKeyBindManager::OnChordTriggered(const QByteArray& id)
 {
-	auto id = GetKeyBindSystemId(keyBind);
-	// If there is no key sequence now, check if there was one. If there was one, remove it.
-	if (keyBind->_Sequence->Size() == 0)
+	auto keyBind = _KeyBindsByStringId.value(id, nullptr);
+	if (keyBind) keyBind->Trigger();
+}
+
+void PGlobalKeyBindManager::UpdateHotkeys()
+{
+	auto strokes = _Chords->GetExpectedStrokes();
+	// Release the strokes that aren't expected anymore.
+	for (auto iter = _SysIdsByStroke.begin(); iter != _SysIdsByStroke.end();)
 	{
-		if (id != 0)
+		if (strokes.contains(iter.key()))
 		{
-			_KeyBindsBySysId.remove(id);
-			unregisterHotkey(id);
-			keyBind->setProperty("sysid", 0);
+			++iter;
+			continue;
 		}
+		unregisterHotkey(iter.value());
+		_StrokesBySysId.remove(iter.value());
+		iter = _SysIdsByStroke.erase(iter);
 	}
-	else
+	// Register the strokes that are newly expected.
+	for (auto stroke : strokes)
 	{
-		if (id == 0)
-		{
-			id = ++_LastId; // it didn't have an ID yet, so use the next one.
-			keyBind->setProperty("sysid", id);
-			_KeyBindsBySysId.insert(id, keyBind);
-		}
-		registerHotkey(keyBind->GetKeySequence(), id);
+		if (_SysIdsByStroke.contains(stroke)) continue;
+		auto id = ++_LastId;
+		registerHotkey(PKeyChordEngine::GetStrokeText(stroke), id);
+		_SysIdsByStroke.insert(stroke, id);
+		_StrokesBySysId.insert(id, stroke);
 	}
+}
 
+void PGlobalKeyBindManager::UpdateKeySequence(PGlobalKeyBind* keyBind)
+{
+	// The engine drops the key bind if it has no key sequence, and the system hotkeys follow the engine.
+	_Chords->SetBinding(keyBind->_ID, keyBind->_Sequence, keyBind->_Context);
 }
 
 QQmlListProperty<PGlobalKeyBind> PGlobalKeyBindManager::GetKeyBindsProperty() const
@@ -202,7 +246,3 @@ QQmlListProperty<PGlobalKeyBind> PGlobalKeyBindManager::GetKeyBindsProperty() co
 		atFunc);
 }
 
-size_t PGlobalKeyBindManager::GetKeyBindSystemId(PGlobalKeyBind* keyBind) const
-{
-	return keyBind->property("sysid").toULongLong();
-}
@@ -19,9 +19,12 @@
 #include <uglobalhotkeys.h>
 
 class PGlobalKeyBind;
+class PKeyChordEngine;
 
 /**
  * Manages all of the key binds that have been defined, including built-in and user-defined key binds.
+ * Key sequences are resolved by a chord engine. Only the strokes the engine can use next are registered as system
+ * hotkeys, so the second stroke of a chord is only taken from other applications once the first one was pressed.
  */
 class PGlobalKeyBindManager : public UGlobalHotkeys
 {
@@ -39,6 +42,13 @@ public:
 	 */
 	PGlobalKeyBindManager();
 
+	/**
+	 * Retrieves the engine resolving strokes to key binds.
+	 * @return
+	 *   The chord engine.
+	 */
+	PKeyChordEngine* GetChordEngine() const;
+
 	/**
 	 * Retrieves the list of key binds from the manager.
 	 * @return
@@ -108,13 +118,44 @@ public:
 	 */
 	Q_INVOKABLE void RestoreKeyBinds();
 
+	/**
+	 * Feeds a stroke to the key binds as if it was pressed.
+	 * @param[in] stroke
+	 *   The stroke, such as "Ctrl+K".
+	 * @return
+	 *   true if the stroke started, continued or completed a key sequence, false otherwise.
+	 */
+	Q_INVOKABLE bool SimulateStroke(const QString& stroke);
+
+public slots:
+
+	/**
+	 * Sets whether the game is focused, which activates the key binds limited to the game.
+	 * @param[in] focused
+	 *   true if the game is focused, false otherwise.
+	 */
+	void SetGameFocused(bool focused);
+
 private slots:
 
 	/**
-	 * Slot called when a key bind's key sequence is modified.
+	 * Slot called when a key bind's key sequence or context is modified.
 	 */
 	void OnKeySequenceModified();
 
+	/**
+	 * Slot called when the chord engine resolves a key sequence.
+	 * @param[in] id
+	 *   The ID of the key bind that was triggered.
+	 */
+	void OnChordTriggered(const QByteArray& id);
+
+	/**
+	 * Slot called when the strokes the chord engine expects change. This registers and unregisters system 
+	 * hotkeys to match.
+	 */
+	void UpdateHotkeys();
+
 	/**
 	 * Slot called when a hotkey is triggered.
 	 * @param[in] id
@@ -139,23 +180,24 @@ private:
 	QQmlListProperty<PGlobalKeyBind> GetKeyBindsProperty() const;
 
 	/**
-	 * Retrieves the system ID for a key bind.
-	 * @param[in] keyBind
-	 *   The key bind for which to retrieve the system ID.
-	 * @return
-	 *   The ID of the key bind. This will be zero if there was no ID set on the key bind.
+	 * The key binds indexed by their string id.
 	 */
-	size_t GetKeyBindSystemId(PGlobalKeyBind* keyBind) const;
+	QMap<QByteArray, PGlobalKeyBind*> _KeyBindsByStringId;
 
 	/**
-	 * The key binds indexed by their string id.
+	 * The engine resolving strokes to key binds.
 	 */
-	QMap<QByteArray, PGlobalKeyBind*> _KeyBindsByStringId;
+	PKeyChordEngine* _Chords = nullptr;
+
+	/**
+	 * The strokes registered as system hotkeys, indexed by system id.
+	 */
+	QHash<size_t, int> _StrokesBySysId;
 
 	/**
-	 * The key binds indexed by system id.
+	 * The system ids of the registered strokes, indexed by stroke.
 	 */
-	QHash<size_t, PGlobalKeyBind*> _KeyBindsBySysId;
+	QHash<int, size_t> _SysIdsByStroke;
 
 	/**
 	 * The last hotkey ID.
@@ -0,0 +1,29 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PInputInjector.h"
+
+const PInputInjector::Script & PInputInjector::GetChatScript()
+{
+	// Open the chat box, select and delete anything left in it, paste the line and submit it.
+	static const Script script{
+		{Return, false}, {Return, true},
+		{Control, false}, {A, false}, {A, true}, {Control, true},
+		{Backspace, false}, {Backspace, true},
+		{Control, false}, {V, false}, {V, true}, {Control, true},
+		{Return, false}, {Return, true}
+	};
+	return script;
+}
@@ -0,0 +1,94 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+/**
+ * Delivers chat lines to the game.
+ * The command queue decides when lines are sent; an injector only knows how to get a line into the game's chat
+ * box and how to clean up after a burst of lines. Every backend plays the same keystroke script: open the chat
+ * box, clear whatever was typed in it, paste the line from the clipboard, and submit it. The Win32 backend plays
+ * it against the real game window in a single call, and the mock backend records it so command scripts and the
+ * queue can be exercised without the game.
+ */
+class PInputInjector
+{
+public:
+
+	/**
+	 * The keys the keystroke script uses.
+	 */
+	enum Key
+	{
+		Return,
+		Control,
+		Backspace,
+		A,
+		V
+	};
+
+	/**
+	 * A single key press or release.
+	 */
+	struct KeyStroke
+	{
+		/**
+		 * The key.
+		 */
+		Key _Key;
+
+		/**
+		 * true if the key is released, false if it is pressed.
+		 */
+		bool _Release;
+	};
+
+	/**
+	 * A sequence of keystrokes.
+	 */
+	typedef QVector<KeyStroke> Script;
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~PInputInjector() {}
+
+	/**
+	 * Retrieves the keystrokes that submit the line on the clipboard to the game's chat.
+	 * @return
+	 *   The script.
+	 */
+	static const Script & GetChatScript();
+
+	/**
+	 * Types a line into the game's chat box and submits it.
+	 * @param[in] text
+	 *   The complete line, including any channel prefix.
+	 * @return
+	 *   true if the line was sent, false if the game couldn't be reached.
+	 */
+	virtual bool SendChatLine(const QString &text) = 0;
+
+	/**
+	 * Cleans up after the last line of a burst has been taken by the game.
+	 * @param[in] restoreFocus
+	 *   true to give focus back to the window that had it before the first line of the burst was sent, false to
+	 *   leave the game in front.
+	 */
+	virtual void EndBurst(bool restoreFocus) = 0;
+};
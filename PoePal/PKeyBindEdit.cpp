@@ -65,9 +65,17 @@ void PKeyBindEdit::SetKeySequence(const QString& keySeq)
 void PKeyBindEdit::Clear()
 {
 	Reset();
+	_Strokes.clear();
 	_LineEdit->clear();
 }
 
+void PKeyBindEdit::focusInEvent(QFocusEvent* evt)
+{
+	// Strokes pressed after taking focus start a new key sequence.
+	_Strokes.clear();
+	QWidget::focusInEvent(evt);
+}
+
 void PKeyBindEdit::keyPressEvent(QKeyEvent* evt)
 {
 	_KeySequence->AddKey(evt);
@@ -75,7 +83,13 @@ void PKeyBindEdit::keyPressEvent(QKeyEvent* evt)
 
 void PKeyBindEdit::keyReleaseEvent(QKeyEvent* evt)
 {
-	if(_KeySequence->Size() > 0) _LineEdit->setText(_KeySequence->ToString());
+	if (_KeySequence->Size() > 0)
+	{
+		// A key sequence has at most four strokes, so a fifth one starts over.
+		if (_Strokes.size() >= 4) _Strokes.clear();
+		_Strokes.append(_KeySequence->ToString());
+		_LineEdit->setText(_Strokes.join(QStringLiteral(", ")));
+	}
 	Reset();
 }
 
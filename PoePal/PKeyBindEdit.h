@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include <QStringList>
 #include <QWidget>
 
 class QLineEdit;
@@ -85,6 +86,11 @@ protected:
 	 */
 	bool event(QEvent* evt) override;
 
+	/**
+	 * Overrides QWidget#focusInEvent.
+	 */
+	void focusInEvent(QFocusEvent* evt) override;
+
 	/**
 	 * Overrides QWidget#keyPressEvent.
 	 */
@@ -117,4 +123,10 @@ private:
 	 * The current key sequence.
 	 */
 	QScopedPointer<UKeySequence> _KeySequence;
+
+	/**
+	 * The strokes recorded since the editor took focus. Pressing several strokes records a multi-stroke key
+	 * sequence.
+	 */
+	QStringList _Strokes;
 };
\ No newline at end of file
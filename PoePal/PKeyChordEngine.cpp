@@ -0,0 +1,235 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PKeyChordEngine.h"
+#include <QDebug>
+#include <QRegularExpression>
+
+namespace
+{
+	/**
+	 * The default time to wait for the next stroke of a key sequence, in milliseconds.
+	 */
+	const int _DefaultTimeout = 1500;
+}
+
+PKeyChordEngine::PKeyChordEngine(QObject* parent):
+QObject(parent)
+{
+	_Timer.setSingleShot(true);
+	_Timer.setInterval(_DefaultTimeout);
+	connect(&_Timer, &QTimer::timeout, this, &PKeyChordEngine::OnTimeout);
+	Compile();
+}
+
+void PKeyChordEngine::SetBinding(const QByteArray& id, const QKeySequence& sequence, 
+	PGlobalKeyBind::Context context)
+{
+	if (sequence.isEmpty())
+	{
+		RemoveBinding(id);
+		return;
+	}
+	Binding binding;
+	binding._Sequence = sequence;
+	binding._Context = context;
+	_Bindings.insert(id, binding);
+	Compile();
+}
+
+void PKeyChordEngine::RemoveBinding(const QByteArray& id)
+{
+	if (_Bindings.remove(id) > 0) Compile();
+}
+
+bool PKeyChordEngine::IsGameFocused() const
+{
+	return _GameFocused;
+}
+
+void PKeyChordEngine::SetGameFocused(bool focused)
+{
+	if (focused == _GameFocused) return;
+	_GameFocused = focused;
+	// A sequence started in the other context may not be valid anymore.
+	_State = 0;
+	_Timer.stop();
+	emit ExpectedStrokesChanged();
+}
+
+int PKeyChordEngine::GetTimeout() const
+{
+	return _Timer.interval();
+}
+
+void PKeyChordEngine::SetTimeout(int timeout)
+{
+	_Timer.setInterval(timeout);
+}
+
+bool PKeyChordEngine::IsPending() const
+{
+	return _State != 0;
+}
+
+QList<int> PKeyChordEngine::GetExpectedStrokes() const
+{
+	QList<int> strokes;
+	auto active = GetActiveContexts();
+	auto addStrokes = [&](int node) {
+		const auto& children = _Nodes[node]._Children;
+		for (auto child = children.constBegin(); child != children.constEnd(); ++child)
+		{
+			if ((_Nodes[child.value()]._Contexts & active) && !strokes.contains(child.key()))
+			{
+				strokes.append(child.key());
+			}
+		}
+	};
+	// Strokes continuing the current sequence come first, followed by the ones starting a new sequence.
+	addStrokes(_State);
+	if (_State != 0) addStrokes(0);
+	return strokes;
+}
+
+PKeyChordEngine::Result PKeyChordEngine::Feed(int stroke)
+{
+	auto next = Step(_State, stroke);
+	if (next < 0 && _State != 0)
+	{
+		// The sequence stopped short of a longer key bind, so a key bind ending where it stopped is triggered. The
+		// stroke may still start a new sequence.
+		FinishPending();
+		next = Step(0, stroke);
+	}
+	if (next < 0)
+	{
+		SetState(0);
+		return Unmatched;
+	}
+	const auto& node = _Nodes[next];
+	if (node._ChildContexts & GetActiveContexts())
+	{
+		// Longer sequences continue from here, so wait for the next stroke. A key bind ending here is triggered
+		// if the next stroke doesn't come in time.
+		SetState(next);
+		return Pending;
+	}
+	// Step only follows strokes leading to active key binds, so the key bind ending here is active.
+	auto id = node._Binding;
+	SetState(0);
+	emit Triggered(id);
+	return Matched;
+}
+
+void PKeyChordEngine::Reset()
+{
+	SetState(0);
+}
+
+QKeySequence PKeyChordEngine::ParseSequence(const QString& text)
+{
+	// The key bind editor calls the Windows key "Win", which Qt knows as "Meta".
+	static const QRegularExpression winRegex(QStringLiteral("\\bwin\\+"), 
+		QRegularExpression::CaseInsensitiveOption);
+	auto portable = text;
+	portable.replace(winRegex, QStringLiteral("Meta+"));
+	return QKeySequence::fromString(portable, QKeySequence::PortableText);
+}
+
+QString PKeyChordEngine::GetStrokeText(int stroke)
+{
+	auto text = QKeySequence(stroke).toString(QKeySequence::PortableText);
+	text.replace(QStringLiteral("Meta+"), QStringLiteral("Win+"));
+	return text;
+}
+
+void PKeyChordEngine::OnTimeout()
+{
+	FinishPending();
+}
+
+void PKeyChordEngine::FinishPending()
+{
+	const auto& node = _Nodes[_State];
+	bool active = !node._Binding.isEmpty() && ((1 << node._Context) & GetActiveContexts());
+	auto id = node._Binding;
+	SetState(0);
+	if (active) emit Triggered(id);
+}
+
+void PKeyChordEngine::Compile()
+{
+	_Nodes.clear();
+	_Nodes.append(Node());
+	for (auto binding = _Bindings.constBegin(); binding != _Bindings.constEnd(); ++binding)
+	{
+		const auto& sequence = binding->_Sequence;
+		int node = 0;
+		for (int i = 0; i < sequence.count(); ++i)
+		{
+			auto child = _Nodes[node]._Children.value(sequence[i], -1);
+			if (child < 0)
+			{
+				child = _Nodes.size();
+				_Nodes.append(Node());
+				_Nodes[node]._Children.insert(sequence[i], child);
+			}
+			node = child;
+		}
+		auto& leaf = _Nodes[node];
+		if (!leaf._Binding.isEmpty())
+		{
+			qWarning() << "Key bind" << binding.key() << "has the same key sequence as" << leaf._Binding;
+			continue;
+		}
+		leaf._Binding = binding.key();
+		leaf._Context = binding->_Context;
+	}
+	// Children are always added after their parent, so walking backwards sees every node after its children.
+	for (int i = _Nodes.size() - 1; i >= 0; --i)
+	{
+		auto& node = _Nodes[i];
+		for (int child : node._Children) node._ChildContexts |= _Nodes[child]._Contexts;
+		node._Contexts = node._ChildContexts;
+		if (!node._Binding.isEmpty()) node._Contexts |= 1 << node._Context;
+	}
+	_State = 0;
+	_Timer.stop();
+	emit ExpectedStrokesChanged();
+}
+
+int PKeyChordEngine::Step(int node, int stroke) const
+{
+	auto child = _Nodes[node]._Children.value(stroke, -1);
+	if (child < 0 || !(_Nodes[child]._Contexts & GetActiveContexts())) return -1;
+	return child;
+}
+
+int PKeyChordEngine::GetActiveContexts() const
+{
+	int contexts = 1 << PGlobalKeyBind::Anywhere;
+	if (_GameFocused) contexts |= 1 << PGlobalKeyBind::GameFocused;
+	return contexts;
+}
+
+void PKeyChordEngine::SetState(int node)
+{
+	if (node != 0) _Timer.start();
+	else _Timer.stop();
+	if (node == _State) return;
+	_State = node;
+	emit ExpectedStrokesChanged();
+}
@@ -0,0 +1,279 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "PGlobalKeyBind.h"
+#include <QHash>
+#include <QKeySequence>
+#include <QMap>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+/**
+ * Resolves keystrokes to key binds, including key binds made of several strokes such as Ctrl+K followed by H.
+ * The key sequences are compiled into a trie whenever a key bind changes, so each stroke is resolved with a single
+ * hash lookup. The engine doesn't listen to the keyboard itself; strokes are fed to it, which also allows it to be
+ * driven by synthetic strokes.
+ */
+class PKeyChordEngine : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * The outcome of feeding a stroke to the engine.
+	 */
+	enum Result
+	{
+		Unmatched, ///< The stroke doesn't belong to any active key bind.
+		Pending, ///< The stroke started or continued a key sequence and more strokes are expected.
+		Matched ///< The stroke completed a key sequence and its key bind was triggered.
+	};
+	Q_ENUM(Result);
+
+	/**
+	 * Creates a new engine.
+	 * @param[in] parent
+	 *   The parent of the engine.
+	 */
+	PKeyChordEngine(QObject* parent);
+
+	/**
+	 * Adds or replaces a key bind.
+	 * @param[in] id
+	 *   The ID of the key bind.
+	 * @param[in] sequence
+	 *   The strokes that trigger the key bind. The key bind is removed if this is empty.
+	 * @param[in] context
+	 *   When the key bind is active.
+	 */
+	void SetBinding(const QByteArray& id, const QKeySequence& sequence, PGlobalKeyBind::Context context);
+
+	/**
+	 * Removes a key bind.
+	 * @param[in] id
+	 *   The ID of the key bind.
+	 */
+	void RemoveBinding(const QByteArray& id);
+
+	/**
+	 * Indicates whether the game is focused. Key binds limited to the game are only active while it is.
+	 * @return
+	 *   true if the game is focused, false otherwise.
+	 */
+	bool IsGameFocused() const;
+
+	/**
+	 * Sets whether the game is focused.
+	 * @param[in] focused
+	 *   true if the game is focused, false otherwise.
+	 */
+	void SetGameFocused(bool focused);
+
+	/**
+	 * Retrieves how long the engine waits for the next stroke of a key sequence.
+	 * @return
+	 *   The time to wait, in milliseconds.
+	 */
+	int GetTimeout() const;
+
+	/**
+	 * Sets how long the engine waits for the next stroke of a key sequence.
+	 * @param[in] timeout
+	 *   The time to wait, in milliseconds.
+	 */
+	void SetTimeout(int timeout);
+
+	/**
+	 * Indicates whether the engine is waiting for the next stroke of a key sequence.
+	 * @return
+	 *   true if a key sequence has been started, false otherwise.
+	 */
+	bool IsPending() const;
+
+	/**
+	 * Retrieves the strokes the engine can do something with in its current state. These are the first strokes
+	 * of all active key binds plus the strokes continuing a started key sequence.
+	 * @return
+	 *   The strokes as key codes combined with keyboard modifiers.
+	 */
+	QList<int> GetExpectedStrokes() const;
+
+	/**
+	 * Feeds a stroke to the engine.
+	 * @param[in] stroke
+	 *   The stroke as a key code combined with keyboard modifiers.
+	 * @return
+	 *   What the stroke did.
+	 */
+	Result Feed(int stroke);
+
+	/**
+	 * Abandons a started key sequence without triggering anything.
+	 */
+	void Reset();
+
+	/**
+	 * Parses a key sequence written by a user or by the key bind editor. Strokes are separated by commas.
+	 * @param[in] text
+	 *   The text of the key sequence.
+	 * @return
+	 *   The key sequence.
+	 */
+	static QKeySequence ParseSequence(const QString& text);
+
+	/**
+	 * Writes a single stroke the way the global hotkey library reads it.
+	 * @param[in] stroke
+	 *   The stroke as a key code combined with keyboard modifiers.
+	 * @return
+	 *   The text of the stroke.
+	 */
+	static QString GetStrokeText(int stroke);
+
+signals:
+
+	/**
+	 * Signal sent when a key bind is triggered.
+	 * @param[in] id
+	 *   The ID of the key bind.
+	 */
+	void Triggered(const QByteArray& id);
+
+	/**
+	 * Signal sent when the strokes returned by GetExpectedStrokes change.
+	 */
+	void ExpectedStrokesChanged();
+
+private slots:
+
+	/**
+	 * Slot called when the next stroke of a key sequence didn't come in time. A key bind ending where the
+	 * sequence stopped is triggered.
+	 */
+	void OnTimeout();
+
+private:
+
+	/**
+	 * A node of the compiled trie. The path from the root to a node spells out a key sequence.
+	 */
+	struct Node
+	{
+		/**
+		 * The nodes following this one, mapped by stroke.
+		 */
+		QHash<int, int> _Children;
+
+		/**
+		 * The ID of the key bind whose sequence ends at this node, if any.
+		 */
+		QByteArray _Binding;
+
+		/**
+		 * The context of the key bind ending at this node.
+		 */
+		PGlobalKeyBind::Context _Context = PGlobalKeyBind::Anywhere;
+
+		/**
+		 * The contexts of the key binds ending at or below this node, as a mask.
+		 */
+		int _Contexts = 0;
+
+		/**
+		 * The contexts of the key binds ending below this node, as a mask.
+		 */
+		int _ChildContexts = 0;
+	};
+
+	/**
+	 * A key bind known to the engine.
+	 */
+	struct Binding
+	{
+		/**
+		 * The strokes that trigger the key bind.
+		 */
+		QKeySequence _Sequence;
+
+		/**
+		 * When the key bind is active.
+		 */
+		PGlobalKeyBind::Context _Context = PGlobalKeyBind::Anywhere;
+	};
+
+	/**
+	 * Ends a started key sequence, triggering the key bind ending where the sequence stopped if it is active.
+	 */
+	void FinishPending();
+
+	/**
+	 * Rebuilds the trie from the key binds.
+	 */
+	void Compile();
+
+	/**
+	 * Follows a stroke from a node, skipping nodes that only lead to inactive key binds.
+	 * @param[in] node
+	 *   The index of the node.
+	 * @param[in] stroke
+	 *   The stroke.
+	 * @return
+	 *   The index of the next node or -1 if the stroke doesn't lead anywhere.
+	 */
+	int Step(int node, int stroke) const;
+
+	/**
+	 * Retrieves the mask of the contexts that are currently active.
+	 * @return
+	 *   The mask of active contexts.
+	 */
+	int GetActiveContexts() const;
+
+	/**
+	 * Moves the engine to a node of the trie.
+	 * @param[in] node
+	 *   The index of the node. The root is 0.
+	 */
+	void SetState(int node);
+
+	/**
+	 * The key binds, mapped by ID.
+	 */
+	QMap<QByteArray, Binding> _Bindings;
+
+	/**
+	 * The compiled trie. The root is the first node.
+	 */
+	QVector<Node> _Nodes;
+
+	/**
+	 * The node reached by the strokes fed so far.
+	 */
+	int _State = 0;
+
+	/**
+	 * Indicates whether the game is focused.
+	 */
+	bool _GameFocused = false;
+
+	/**
+	 * Timer that ends a started key sequence when the next stroke doesn't come.
+	 */
+	QTimer _Timer;
+};
@@ -0,0 +1,111 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PKeywordMatcher.h"
+#include <QQueue>
+#include <algorithm>
+
+void PKeywordMatcher::SetKeywords(const QStringList &keywords)
+{
+	_Keywords.clear();
+	_Nodes = QVector<Node>(1);
+	for (const auto &keyword : keywords)
+	{
+		auto lower = keyword.toLower();
+		int keywordIdx = _Keywords.length();
+		_Keywords.append(lower);
+		if (lower.isEmpty()) continue;
+		int node = 0;
+		for (const auto &ch : lower)
+		{
+			int child = FindChild(node, ch.unicode());
+			if (child < 0)
+			{
+				child = _Nodes.length();
+				_Nodes.append(Node());
+				auto &children = _Nodes[node]._Children;
+				auto entry = qMakePair(ch.unicode(), child);
+				children.insert(std::lower_bound(children.begin(), children.end(), entry), entry);
+			}
+			node = child;
+		}
+		// A keyword listed twice keeps the first index.
+		if (_Nodes[node]._Keyword < 0) _Nodes[node]._Keyword = keywordIdx;
+	}
+	// Link the states breadth first, so the failure state of every state is linked before the state itself.
+	QQueue<int> queue;
+	for (const auto &child : _Nodes[0]._Children) queue.enqueue(child.second);
+	while (!queue.isEmpty())
+	{
+		int node = queue.dequeue();
+		for (const auto &child : _Nodes[node]._Children)
+		{
+			int fail = _Nodes[node]._Fail;
+			int next = FindChild(fail, child.first);
+			while (next < 0 && fail != 0)
+			{
+				fail = _Nodes[fail]._Fail;
+				next = FindChild(fail, child.first);
+			}
+			auto &childNode = _Nodes[child.second];
+			childNode._Fail = next < 0 ? 0 : next;
+			childNode._Output = _Nodes[childNode._Fail]._Keyword >= 0 ? childNode._Fail : 
+				_Nodes[childNode._Fail]._Output;
+			queue.enqueue(child.second);
+		}
+	}
+}
+
+QStringList PKeywordMatcher::GetKeywords() const
+{
+	return _Keywords;
+}
+
+int PKeywordMatcher::IndexOf(const QString &keyword) const
+{
+	return _Keywords.indexOf(keyword.toLower());
+}
+
+QBitArray PKeywordMatcher::Find(const QString &text) const
+{
+	QBitArray hits(_Keywords.length());
+	if (_Nodes.length() <= 1) return hits;
+	int node = 0;
+	for (const auto &ch : text)
+	{
+		auto lower = ch.toLower().unicode();
+		int next = FindChild(node, lower);
+		while (next < 0 && node != 0)
+		{
+			node = _Nodes[node]._Fail;
+			next = FindChild(node, lower);
+		}
+		node = next < 0 ? 0 : next;
+		for (int output = _Nodes[node]._Keyword >= 0 ? node : _Nodes[node]._Output; output >= 0; 
+			output = _Nodes[output]._Output)
+		{
+			hits.setBit(_Nodes[output]._Keyword);
+		}
+	}
+	return hits;
+}
+
+int PKeywordMatcher::FindChild(int node, ushort ch) const
+{
+	const auto &children = _Nodes[node]._Children;
+	auto iter = std::lower_bound(children.cbegin(), children.cend(), ch, 
+		[](const QPair<ushort, int> &child, ushort value) { return child.first < value; });
+	return iter != children.cend() && iter->first == ch ? iter->second : -1;
+}
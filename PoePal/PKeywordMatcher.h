@@ -0,0 +1,113 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QBitArray>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * Finds which of a set of keywords occur in a text, ignoring case.
+ * All keywords are found in a single pass over the text, however many there are. The keywords are compiled
+ * into a trie with failure links (Aho-Corasick) when they are set, so this is meant for keywords that change
+ * rarely and texts that are searched often.
+ */
+class PKeywordMatcher
+{
+public:
+
+	/**
+	 * Replaces the keywords.
+	 * @param[in] keywords
+	 *   The keywords. Each keyword is identified by its index in the list.
+	 */
+	void SetKeywords(const QStringList &keywords);
+
+	/**
+	 * Retrieves the keywords.
+	 * @return
+	 *   The keywords, in lower case.
+	 */
+	QStringList GetKeywords() const;
+
+	/**
+	 * Retrieves the index of a keyword.
+	 * @param[in] keyword
+	 *   The keyword.
+	 * @return
+	 *   The index of the keyword or -1 if it is not one of the keywords.
+	 */
+	int IndexOf(const QString &keyword) const;
+
+	/**
+	 * Finds the keywords that occur in a text.
+	 * @param[in] text
+	 *   The text to search.
+	 * @return
+	 *   One bit for each keyword, set if the keyword occurs in the text.
+	 */
+	QBitArray Find(const QString &text) const;
+
+private:
+
+	/**
+	 * A state of the matcher, which is the longest keyword prefix the text read so far ends with.
+	 */
+	struct Node
+	{
+		/**
+		 * The states reached by reading each character, sorted by character.
+		 */
+		QVector<QPair<ushort, int>> _Children;
+
+		/**
+		 * The state for the longest proper suffix of this prefix that is also a keyword prefix.
+		 */
+		int _Fail = 0;
+
+		/**
+		 * The closest state along the failure links that completes a keyword, or -1 if there is none.
+		 */
+		int _Output = -1;
+
+		/**
+		 * The index of the keyword this state completes, or -1 if it does not complete one.
+		 */
+		int _Keyword = -1;
+	};
+
+	/**
+	 * Finds the state reached from another by reading a character, without following the failure links.
+	 * @param[in] node
+	 *   The state to start from.
+	 * @param[in] ch
+	 *   The character, in lower case.
+	 * @return
+	 *   The state reached or -1 if there is none.
+	 */
+	int FindChild(int node, ushort ch) const;
+
+	/**
+	 * The keywords, in lower case.
+	 */
+	QStringList _Keywords;
+
+	/**
+	 * The states of the matcher. The first one is the empty prefix.
+	 */
+	QVector<Node> _Nodes = QVector<Node>(1);
+};
@@ -0,0 +1,105 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PLogReader.h"
+#include "PMessage.h"
+#include <QDebug>
+#include <QFile>
+#include <QThread>
+#include <QTimer>
+
+namespace
+{
+	/**
+	 * The time between reads of the log file, in milliseconds.
+	 */
+	const int _ReadInterval = 10;
+
+	/**
+	 * The most bytes read from the log file at once, so catching up on a large log applies backpressure in
+	 * steps instead of parsing it all in one go.
+	 */
+	const qint64 _ReadChunkSize = 1 << 20;
+}
+
+PLogReader::PLogReader(const QString &path, qint64 offset, Ring *ring, QThread *target):
+QObject(nullptr),
+_Path(path),
+_Offset(offset),
+_Ring(ring),
+_Target(target)
+{
+}
+
+PLogReader::~PLogReader()
+{
+	// Messages that never made it to the GUI thread are still owned here.
+	for (const auto &entry : _Pending) delete entry._Message;
+}
+
+void PLogReader::Start()
+{
+	_File = new QFile(_Path, this);
+	if (!_File->open(QIODevice::ReadOnly))
+	{
+		qWarning("Could not open client log file for reading.");
+		return;
+	}
+	_File->seek(_Offset);
+	_Timer = new QTimer(this);
+	_Timer->setInterval(_ReadInterval);
+	connect(_Timer, &QTimer::timeout, this, &PLogReader::OnTimer);
+	_Timer->start();
+}
+
+void PLogReader::OnTimer()
+{
+	// Backpressure: don't read more until the GUI thread has taken what was already parsed.
+	if (!PushPending() || _File->atEnd()) return;
+	QByteArray contents = _Remainder + _File->read(_ReadChunkSize);
+	auto base = _Offset - _Remainder.length();
+	_Offset = _File->pos();
+	int lineBegin = 0;
+	int lineEnd = 0;
+	while ((lineEnd = contents.indexOf('\r', lineBegin)) >= 0)
+	{
+		auto line = QString::fromUtf8(contents.mid(lineBegin, lineEnd - lineBegin));
+		auto message = PMessage::FromString(line, nullptr);
+		if (message)
+		{
+			// The GUI thread adopts the message, so it has to belong to that thread before it is handed over.
+			message->moveToThread(_Target);
+			Entry entry;
+			entry._Message = message;
+			entry._Offset = base + lineEnd + 1;
+			_Pending.append(entry);
+		}
+		else qDebug() << "Line not recognized as a message: " << line;
+		lineBegin = lineEnd + 1;
+	}
+	// Keep the partial line so it's completed on the next read.
+	_Remainder = contents.mid(lineBegin);
+	PushPending();
+}
+
+bool PLogReader::PushPending()
+{
+	int pushed = 0;
+	while (pushed < _Pending.length() && _Ring->TryPush(_Pending.at(pushed))) ++pushed;
+	_Pending.remove(0, pushed);
+	// A single request is outstanding at a time, so a burst costs one queued event rather than one per message.
+	if ((_Ring->IsAboveHighWater() || !_Pending.isEmpty()) && _Ring->RequestDrain()) emit DrainRequested();
+	return _Pending.isEmpty();
+}
@@ -0,0 +1,148 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "PSpscRing.h"
+#include <QByteArray>
+#include <QObject>
+#include <QVector>
+
+class PMessage;
+class QFile;
+class QThread;
+class QTimer;
+
+/**
+ * Reads and parses the client log on a worker thread.
+ * Parsed messages are handed to the GUI thread through a ring buffer rather than a queued signal per message.
+ * The GUI thread drains the ring on its own timer; the reader only signals when the ring passes its high-water
+ * mark. When the ring is full, the reader stops reading until it has been drained.
+ */
+class PLogReader : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * A message handed to the GUI thread.
+	 */
+	struct Entry
+	{
+		/**
+		 * The parsed message. It has no parent and already belongs to the GUI thread.
+		 */
+		PMessage *_Message = nullptr;
+
+		/**
+		 * The position in the log file just past the line the message was parsed from.
+		 */
+		qint64 _Offset = 0;
+	};
+
+	/**
+	 * The ring buffer messages are handed over in.
+	 */
+	typedef PSpscRing<Entry> Ring;
+
+	/**
+	 * Creates a new reader. It should be moved to its worker thread before it is started.
+	 * @param[in] path
+	 *   The path of the log file.
+	 * @param[in] offset
+	 *   The position in the log file to start reading from.
+	 * @param[in] ring
+	 *   The ring buffer to put the messages in. The reader is its only producer.
+	 * @param[in] target
+	 *   The thread the messages are handed to.
+	 */
+	PLogReader(const QString &path, qint64 offset, Ring *ring, QThread *target);
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~PLogReader();
+
+public slots:
+
+	/**
+	 * Opens the log file and starts reading it. This runs on the worker thread.
+	 */
+	void Start();
+
+signals:
+
+	/**
+	 * Signal sent when the ring buffer passes its high-water mark and should be drained right away.
+	 */
+	void DrainRequested();
+
+private slots:
+
+	/**
+	 * Slot called periodically to read new lines from the log file.
+	 */
+	void OnTimer();
+
+private:
+
+	/**
+	 * Puts the parsed messages that are waiting into the ring buffer.
+	 * @return
+	 *   true if all of them fit, false if the ring is full.
+	 */
+	bool PushPending();
+
+	/**
+	 * The path of the log file.
+	 */
+	QString _Path;
+
+	/**
+	 * The log file.
+	 */
+	QFile *_File = nullptr;
+
+	/**
+	 * The timer that polls the log file.
+	 */
+	QTimer *_Timer = nullptr;
+
+	/**
+	 * The position in the log file of the first byte that hasn't been read.
+	 */
+	qint64 _Offset = 0;
+
+	/**
+	 * The partial line at the end of the last read.
+	 */
+	QByteArray _Remainder;
+
+	/**
+	 * The ring buffer the messages are put in.
+	 */
+	Ring *_Ring = nullptr;
+
+	/**
+	 * The thread the messages are handed to.
+	 */
+	QThread *_Target = nullptr;
+
+	/**
+	 * The parsed messages that didn't fit in the ring buffer yet.
+	 */
+	QVector<Entry> _Pending;
+};
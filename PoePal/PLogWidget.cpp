@@ -15,17 +15,155 @@
  */
 #include "PLogWidget.h"
 #include "PApplication.h"
+#include "PMessageHandler.h"
 #include "PMessageModel.h"
+#include <QCache>
+#include <QHeaderView>
+#include <QPainter>
 #include <QScrollBar>
+#include <QStyledItemDelegate>
+
+namespace
+{
+	/**
+	 * The maximum number of elided cell texts kept. This is several screens worth of cells.
+	 */
+	const int _ElidedCacheSize = 4096;
+
+	/**
+	 * The horizontal space around the text in a cell, in pixels.
+	 */
+	const int _CellMargin = 4;
+}
+
+/**
+ * Paints the cells of the log table.
+ * Every row has the same height and the text is never wrapped, so the view never has to measure a message.
+ * The elided text of the cells on screen is cached, so scrolling only elides the rows coming into view.
+ */
+class PLogItemDelegate : public QStyledItemDelegate
+{
+public:
+
+	/**
+	 * Creates a new delegate.
+	 * @param[in] parent
+	 *   The parent of the delegate.
+	 */
+	PLogItemDelegate(QObject *parent):
+	QStyledItemDelegate(parent)
+	{
+		_Elided.setMaxCost(_ElidedCacheSize);
+	}
+
+	/**
+	 * Overrides QStyledItemDelegate#paint
+	 */
+	virtual void paint(QPainter *painter, const QStyleOptionViewItem &option, 
+		const QModelIndex &index) const override
+	{
+		QStyleOptionViewItem opt(option);
+		opt.text.clear();
+		auto style = opt.widget ? opt.widget->style() : QApplication::style();
+		style->drawPrimitive(QStyle::PE_PanelItemViewItem, &opt, painter, opt.widget);
+		auto rect = option.rect.adjusted(_CellMargin, 0, -_CellMargin, 0);
+		painter->save();
+		painter->setPen(option.palette.color(option.state.testFlag(QStyle::State_Selected) ? 
+			QPalette::HighlightedText : QPalette::Text));
+		painter->drawText(rect, Qt::AlignLeft | Qt::AlignVCenter, GetElidedText(index, option.fontMetrics, 
+			rect.width()));
+		painter->restore();
+	}
+
+	/**
+	 * Overrides QStyledItemDelegate#sizeHint
+	 */
+	virtual QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override
+	{
+		// The table has fixed row heights and column widths, so there is no need to look at the message.
+		return QSize(option.fontMetrics.averageCharWidth() * 10, option.fontMetrics.height() + _CellMargin);
+	}
+
+	/**
+	 * Drops the elided text of every cell. This must be called when rows move, such as when the model is reset.
+	 */
+	void ClearCache()
+	{
+		_Elided.clear();
+	}
+
+private:
+
+	/**
+	 * Retrieves the text of a cell elided to fit its width.
+	 * @param[in] index
+	 *   The index of the cell.
+	 * @param[in] metrics
+	 *   The metrics of the font used to draw the cell.
+	 * @param[in] width
+	 *   The width available for the text.
+	 * @return
+	 *   The elided text.
+	 */
+	QString GetElidedText(const QModelIndex &index, const QFontMetrics &metrics, int width) const
+	{
+		// Rows are appended between resets of the model, so the row and column identify the text of a cell.
+		auto key = (static_cast<quint64>(index.row()) << 8) | static_cast<quint64>(index.column());
+		auto cached = _Elided.object(key);
+		if (cached && cached->first == width) return cached->second;
+		auto text = metrics.elidedText(index.data(Qt::DisplayRole).toString(), Qt::ElideRight, width);
+		_Elided.insert(key, new QPair<int, QString>(width, text));
+		return text;
+	}
+
+	/**
+	 * The elided text of the cells, with the width it was elided to, indexed by row and column.
+	 */
+	mutable QCache<quint64, QPair<int, QString>> _Elided;
+};
 
 PLogWidget::PLogWidget(QWidget *parent)
 	: QDockWidget(parent)
 {
 	ui.setupUi(this);
 	auto app = qobject_cast<PApplication *>(qApp);
-	ui._ListView->setModel(app->GetMessageModel());
+	auto table = ui._TableView;
+	table->setModel(app->GetMessageModel());
+	auto delegate = new PLogItemDelegate(table);
+	table->setItemDelegate(delegate);
+	connect(app->GetMessageModel(), &QAbstractItemModel::modelReset, delegate, &PLogItemDelegate::ClearCache);
+	// Fixed row heights and column widths mean the view never measures rows, no matter how many there are.
+	auto metrics = table->fontMetrics();
+	auto rows = table->verticalHeader();
+	rows->setSectionResizeMode(QHeaderView::Fixed);
+	rows->setDefaultSectionSize(metrics.height() + _CellMargin);
+	auto columns = table->horizontalHeader();
+	columns->setSectionResizeMode(QHeaderView::Interactive);
+	columns->resizeSection(PMessageModel::TimeColumn, 
+		metrics.horizontalAdvance(QStringLiteral("0000/00/00 00:00:00")) + _CellMargin * 3);
+	columns->resizeSection(PMessageModel::TypeColumn, metrics.horizontalAdvance(QStringLiteral("DEBUG")) + 
+		_CellMargin * 3);
+	columns->resizeSection(PMessageModel::ChannelColumn, metrics.horizontalAdvance(QStringLiteral("Whisper")) + 
+		_CellMargin * 3);
+	columns->resizeSection(PMessageModel::SenderColumn, metrics.averageCharWidth() * 24);
+	ui._JumpEdit->setDateTime(QDateTime::currentDateTime());
+	connect(ui._JumpButton, &QPushButton::clicked, this, &PLogWidget::OnJump);
+	connect(ui._JumpEdit, &QDateTimeEdit::editingFinished, this, &PLogWidget::OnJump);
 }
 
 PLogWidget::~PLogWidget()
 {
 }
+
+void PLogWidget::OnJump()
+{
+	auto app = qobject_cast<PApplication *>(qApp);
+	Q_ASSERT(app);
+	auto model = app->GetMessageModel();
+	int row = app->GetMessageHandler()->FindMessageAt(ui._JumpEdit->dateTime());
+	row = qMin(row, model->rowCount() - 1);
+	if (row < 0) return;
+	auto index = model->index(row, PMessageModel::TimeColumn);
+	ui._TableView->scrollTo(index, QAbstractItemView::PositionAtTop);
+	ui._TableView->setCurrentIndex(index);
+}
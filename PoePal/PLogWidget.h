@@ -41,6 +41,13 @@ public:
 	 */
 	virtual ~PLogWidget();
 
+private slots:
+
+	/**
+	 * Slot called to jump to the time in the jump box.
+	 */
+	void OnJump();
+
 private:
 	Ui::PLogWidget ui;
 };
@@ -19,6 +19,7 @@
 #include "PChatDockWidget.h"
 #include "PChatWidget.h"
 #include "PChatWidgetsDlg.h"
+#include "PCommandStatsWidget.h"
 #include "PJSConsoleWidget.h"
 #include "PLogWidget.h"
 #include "PMainOptionsDlg.h"
@@ -46,6 +47,8 @@ PMainWindow::PMainWindow(QWidget *parent)
 	InitializeDockWidget(_LogWidget = new PLogWidget(this), Qt::BottomDockWidgetArea, _MessagesAction);
 	InitializeDockWidget(_JSConsole = new PJSConsoleWidget(this), Qt::BottomDockWidgetArea, 
 		_ConsoleAction);
+	InitializeDockWidget(_CommandStats = new PCommandStatsWidget(this), Qt::BottomDockWidgetArea, 
+		_DiagnosticsAction);
 	InitializeDockWidget(_StatusWidget = new PStatusWidget(this), Qt::LeftDockWidgetArea, _StatusAction);
 	QSettings settings;
 	settings.beginGroup(QStringLiteral("Chat"));
@@ -21,6 +21,7 @@
 #include "PMessage.h"
 
 class PChatDockWidget;
+class PCommandStatsWidget;
 class PJSConsoleWidget;
 class PLogWidget;
 class PStatusWidget;
@@ -207,6 +208,11 @@ private:
 	 */
 	PJSConsoleWidget *_JSConsole = nullptr;
 
+	/**
+	 * The command diagnostics widget.
+	 */
+	PCommandStatsWidget *_CommandStats = nullptr;
+
 	/**
 	 * The status widget.
 	 */
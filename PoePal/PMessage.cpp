@@ -15,10 +15,14 @@
  */
 #include "PMessage.h"
 #include "PApplication.h"
+#include "PSlabPool.h"
 #include <QDebug>
 #include <QJSEngine>
 #include <QJSValue>
+#include <QMetaEnum>
+#include <QMutex>
 #include <QRegularExpression>
+#include <QSet>
 #include <QStringBuilder>
 #include <QTimer>
 
@@ -67,6 +71,59 @@ namespace {
 		};
 		return &strings;
 	}
+
+	/**
+	 * Guards the pools, since messages are parsed on the log reader thread and released on the GUI thread.
+	 */
+	QMutex _PoolMutex;
+
+	/**
+	 * Guards the interned strings, for the same reason.
+	 */
+	QMutex _InternMutex;
+
+	/**
+	 * Retrieves the pool that objects of a given type are allocated from. The caller must hold the pool mutex.
+	 */
+	template<typename T>
+	PSlabPool<T> * GetPool()
+	{
+		static PSlabPool<T> pool;
+		return &pool;
+	}
+
+	/**
+	 * The number of interned strings below which the interned strings are never pruned.
+	 */
+	const int _MinInternPruneSize = 1024;
+
+	/**
+	 * Interns a string that is likely to repeat across messages, such as a sender name, so that every message
+	 * shares the same string data rather than holding its own copy.
+	 * @param[in] string
+	 *   The string to intern.
+	 * @return
+	 *   The shared copy of the string.
+	 */
+	QString Intern(const QString &string)
+	{
+		static QSet<QString> strings;
+		static int pruneSize = _MinInternPruneSize;
+		if (string.isEmpty()) return QString();
+		QMutexLocker locker(&_InternMutex);
+		if (strings.size() >= pruneSize)
+		{
+			// Drop the strings that only the set still refers to, since the messages using them are gone. The set
+			// is only pruned each time it doubles, which spreads the cost over the strings added in between.
+			for (auto iter = strings.begin(); iter != strings.end();)
+			{
+				if (iter->isDetached()) iter = strings.erase(iter);
+				else ++iter;
+			}
+			pruneSize = qMax(_MinInternPruneSize, strings.size() * 2);
+		}
+		return *strings.insert(string);
+	}
 }
 
 QString PMessage::GetStringFromType(Type type)
@@ -138,8 +195,8 @@ PMessage * PMessage::FromString(const QString &string, QObject *parent)
 	auto chatMatch = chatRegex.match(contents);
 	if (chatMatch.hasMatch())
 	{
-		msg->_ChatSubject = chatMatch.captured(4);
-		msg->_ChatSubjectGuild = chatMatch.captured(3);
+		msg->_ChatSubject = Intern(chatMatch.captured(4));
+		msg->_ChatSubjectGuild = Intern(chatMatch.captured(3));
 		msg->_Contents = chatMatch.captured(5);
 		if (msg->_ChatSubject.isEmpty()) msg->_Subtype = Event;
 		else
@@ -153,9 +210,9 @@ PMessage * PMessage::FromString(const QString &string, QObject *parent)
 				msg->_TradeInfo.reset(new TradeReqInfo);
 				msg->_TradeInfo->_Item = tradeMatch.captured(1);
 				msg->_TradeInfo->_Amount = tradeMatch.captured(2).toFloat();
-				msg->_TradeInfo->_Currency = tradeMatch.captured(3);
-				msg->_TradeInfo->_League = tradeMatch.captured(4);
-				msg->_TradeInfo->_Tab = tradeMatch.captured(5);
+				msg->_TradeInfo->_Currency = Intern(tradeMatch.captured(3));
+				msg->_TradeInfo->_League = Intern(tradeMatch.captured(4));
+				msg->_TradeInfo->_Tab = Intern(tradeMatch.captured(5));
 				msg->_TradeInfo->_Left = tradeMatch.captured(6).toInt();
 				msg->_TradeInfo->_Top = tradeMatch.captured(7).toInt();
 			}
@@ -165,6 +222,158 @@ PMessage * PMessage::FromString(const QString &string, QObject *parent)
 	return msg;
 }
 
+PMessage * PMessage::FromStream(QDataStream &stream, QObject *parent)
+{
+	qint64 msecs = 0;
+	qint8 type = Invalid, subtype = Log;
+	qint32 channel = InvalidChannel;
+	bool hasTradeInfo = false;
+	auto msg = new PMessage(parent);
+	stream >> msecs >> msg->_Id >> msg->_Code >> type >> subtype >> msg->_ClientId >> msg->_Contents >> channel
+		>> msg->_ChatSubject >> msg->_ChatSubjectGuild >> msg->_IsIncoming >> hasTradeInfo;
+	if (hasTradeInfo)
+	{
+		msg->_TradeInfo.reset(new TradeReqInfo);
+		stream >> msg->_TradeInfo->_Item >> msg->_TradeInfo->_Amount >> msg->_TradeInfo->_Currency >>
+			msg->_TradeInfo->_League >> msg->_TradeInfo->_Tab >> msg->_TradeInfo->_Left >> 
+			msg->_TradeInfo->_Top;
+	}
+	if (stream.status() != QDataStream::Ok)
+	{
+		delete msg;
+		return nullptr;
+	}
+	msg->_ChatSubject = Intern(msg->_ChatSubject);
+	msg->_ChatSubjectGuild = Intern(msg->_ChatSubjectGuild);
+	if (hasTradeInfo)
+	{
+		msg->_TradeInfo->_Currency = Intern(msg->_TradeInfo->_Currency);
+		msg->_TradeInfo->_League = Intern(msg->_TradeInfo->_League);
+		msg->_TradeInfo->_Tab = Intern(msg->_TradeInfo->_Tab);
+	}
+	msg->_Date = QDateTime::fromMSecsSinceEpoch(msecs);
+	msg->_Type = static_cast<Type>(type);
+	msg->_Subtype = static_cast<Subtype>(subtype);
+	msg->_Channel = static_cast<Channel>(channel);
+	return msg;
+}
+
+void * PMessage::operator new(size_t size)
+{
+	// The pool blocks only fit a PMessage, so anything derived from it comes from the heap.
+	if (size != sizeof(PMessage)) return ::operator new(size);
+	QMutexLocker locker(&_PoolMutex);
+	return GetPool<PMessage>()->Allocate();
+}
+
+void PMessage::operator delete(void *ptr, size_t size)
+{
+	if (size != sizeof(PMessage))
+	{
+		::operator delete(ptr);
+		return;
+	}
+	QMutexLocker locker(&_PoolMutex);
+	GetPool<PMessage>()->Release(ptr);
+}
+
+void * PMessage::TradeReqInfo::operator new(size_t size)
+{
+	if (size != sizeof(TradeReqInfo)) return ::operator new(size);
+	QMutexLocker locker(&_PoolMutex);
+	return GetPool<TradeReqInfo>()->Allocate();
+}
+
+void PMessage::TradeReqInfo::operator delete(void *ptr, size_t size)
+{
+	if (size != sizeof(TradeReqInfo))
+	{
+		::operator delete(ptr);
+		return;
+	}
+	QMutexLocker locker(&_PoolMutex);
+	GetPool<TradeReqInfo>()->Release(ptr);
+}
+
+PMessage * PMessage::FromJson(const QJsonObject &object, QObject *parent)
+{
+	auto date = QDateTime::fromString(object.value(QStringLiteral("time")).toString(), Qt::ISODateWithMs);
+	bool typeOk = false, subtypeOk = false;
+	auto type = QMetaEnum::fromType<Type>().keyToValue(
+		object.value(QStringLiteral("type")).toString().toLatin1().constData(), &typeOk);
+	auto subtype = QMetaEnum::fromType<Subtype>().keyToValue(
+		object.value(QStringLiteral("subtype")).toString().toLatin1().constData(), &subtypeOk);
+	if (!date.isValid() || !typeOk || !subtypeOk) return nullptr;
+	auto msg = new PMessage(parent);
+	msg->_Date = date;
+	msg->_Id = object.value(QStringLiteral("id")).toVariant().toLongLong();
+	msg->_Code = static_cast<qint16>(object.value(QStringLiteral("code")).toInt());
+	msg->_Type = static_cast<Type>(type);
+	msg->_Subtype = static_cast<Subtype>(subtype);
+	msg->_ClientId = object.value(QStringLiteral("client")).toInt();
+	msg->_Channel = GetChannelFromString(object.value(QStringLiteral("channel")).toString());
+	msg->_ChatSubject = Intern(object.value(QStringLiteral("sender")).toString());
+	msg->_ChatSubjectGuild = Intern(object.value(QStringLiteral("guild")).toString());
+	msg->_IsIncoming = object.value(QStringLiteral("incoming")).toBool(true);
+	msg->_Contents = object.value(QStringLiteral("contents")).toString();
+	auto trade = object.value(QStringLiteral("trade")).toObject();
+	if (!trade.isEmpty())
+	{
+		msg->_TradeInfo.reset(new TradeReqInfo);
+		msg->_TradeInfo->_Item = trade.value(QStringLiteral("item")).toString();
+		msg->_TradeInfo->_Amount = static_cast<float>(trade.value(QStringLiteral("amount")).toDouble());
+		msg->_TradeInfo->_Currency = Intern(trade.value(QStringLiteral("currency")).toString());
+		msg->_TradeInfo->_League = Intern(trade.value(QStringLiteral("league")).toString());
+		msg->_TradeInfo->_Tab = Intern(trade.value(QStringLiteral("tab")).toString());
+		msg->_TradeInfo->_Left = trade.value(QStringLiteral("left")).toInt();
+		msg->_TradeInfo->_Top = trade.value(QStringLiteral("top")).toInt();
+	}
+	return msg;
+}
+
+PMessage * PMessage::FromCsvRecord(const QStringList &record, QObject *parent)
+{
+	if (record.size() != GetCsvHeader().size()) return nullptr;
+	auto date = QDateTime::fromString(record.at(0), Qt::ISODateWithMs);
+	bool typeOk = false, subtypeOk = false;
+	auto type = QMetaEnum::fromType<Type>().keyToValue(record.at(3).toLatin1().constData(), &typeOk);
+	auto subtype = QMetaEnum::fromType<Subtype>().keyToValue(record.at(4).toLatin1().constData(), &subtypeOk);
+	if (!date.isValid() || !typeOk || !subtypeOk) return nullptr;
+	auto msg = new PMessage(parent);
+	msg->_Date = date;
+	msg->_Id = record.at(1).toLongLong();
+	msg->_Code = static_cast<qint16>(record.at(2).toInt(nullptr, 16));
+	msg->_Type = static_cast<Type>(type);
+	msg->_Subtype = static_cast<Subtype>(subtype);
+	msg->_ClientId = record.at(5).toInt();
+	msg->_Channel = GetChannelFromString(record.at(6));
+	msg->_ChatSubject = Intern(record.at(7));
+	msg->_ChatSubjectGuild = Intern(record.at(8));
+	msg->_IsIncoming = record.at(9) != QStringLiteral("false");
+	msg->_Contents = record.at(10);
+	if (!record.at(11).isEmpty())
+	{
+		msg->_TradeInfo.reset(new TradeReqInfo);
+		msg->_TradeInfo->_Item = record.at(11);
+		msg->_TradeInfo->_Amount = record.at(12).toFloat();
+		msg->_TradeInfo->_Currency = Intern(record.at(13));
+		msg->_TradeInfo->_League = Intern(record.at(14));
+		msg->_TradeInfo->_Tab = Intern(record.at(15));
+		msg->_TradeInfo->_Left = record.at(16).toInt();
+		msg->_TradeInfo->_Top = record.at(17).toInt();
+	}
+	return msg;
+}
+
+QStringList PMessage::GetCsvHeader()
+{
+	static QStringList header{
+		"time", "id", "code", "type", "subtype", "client", "channel", "sender", "guild", "incoming", "contents",
+		"item", "amount", "currency", "league", "tab", "left", "top"
+	};
+	return header;
+}
+
 PMessage::PMessage(QObject *parent):
 QObject(parent)
 {
@@ -242,6 +451,12 @@ bool PMessage::IsTradeRequest() const
 	return _TradeInfo;
 }
 
+bool PMessage::IsWhisperFailure() const
+{
+	return _Subtype != Chat && (_Contents == tr("That character is not online.") || 
+		_Contents == tr("The specified character does not exist."));
+}
+
 QString PMessage::GetTradeItem() const
 {
 	if (_TradeInfo) return _TradeInfo->_Item;
@@ -284,10 +499,120 @@ int PMessage::GetTradeTopPosition() const
 	return 0;
 }
 
+int PMessage::GetStoreIndex() const
+{
+	return _StoreIndex;
+}
+
+void PMessage::SetStoreIndex(int idx)
+{
+	_StoreIndex = idx;
+}
+
+bool PMessage::MatchesFilter(int filterId) const
+{
+	if (filterId < 0) return false;
+	if (filterId < 64) return (_FilterMatches & (Q_UINT64_C(1) << filterId)) != 0;
+	int word = filterId / 64 - 1;
+	if (word >= _MoreFilterMatches.length()) return false;
+	return (_MoreFilterMatches.at(word) & (Q_UINT64_C(1) << (filterId % 64))) != 0;
+}
+
+void PMessage::SetFilterMatch(int filterId, bool matches)
+{
+	if (filterId < 0) return;
+	auto bit = Q_UINT64_C(1) << (filterId % 64);
+	if (filterId < 64)
+	{
+		if (matches) _FilterMatches |= bit;
+		else _FilterMatches &= ~bit;
+		return;
+	}
+	int word = filterId / 64 - 1;
+	if (word >= _MoreFilterMatches.length())
+	{
+		if (!matches) return;
+		_MoreFilterMatches.resize(word + 1);
+	}
+	if (matches) _MoreFilterMatches[word] |= bit;
+	else _MoreFilterMatches[word] &= ~bit;
+}
+
 QString PMessage::ToString() const
 {
-	static QString format("%1 %2 %3 [%4 Client %5] %6");
-	return format.arg(_Date.toString(QStringLiteral("yyyy/MM/dd HH:mm:ss")), QString::number(_Id),
-		QString::number(_Code, 16), GetStringFromType(_Type), QString::number(_ClientId), 
-		GetFullContents());
+	// Build the string in a single allocation rather than substituting into a format string.
+	return _Date.toString(QStringLiteral("yyyy/MM/dd HH:mm:ss")) % QLatin1Char(' ') % QString::number(_Id) %
+		QLatin1Char(' ') % QString::number(_Code, 16) % QStringLiteral(" [") % GetStringFromType(_Type) %
+		QStringLiteral(" Client ") % QString::number(_ClientId) % QStringLiteral("] ") % GetFullContents();
+}
+
+void PMessage::ToStream(QDataStream &stream) const
+{
+	stream << _Date.toMSecsSinceEpoch() << _Id << _Code << static_cast<qint8>(_Type) << 
+		static_cast<qint8>(_Subtype) << _ClientId << _Contents << static_cast<qint32>(_Channel) << 
+		_ChatSubject << _ChatSubjectGuild << _IsIncoming << !_TradeInfo.isNull();
+	if (_TradeInfo)
+	{
+		stream << _TradeInfo->_Item << _TradeInfo->_Amount << _TradeInfo->_Currency << _TradeInfo->_League <<
+			_TradeInfo->_Tab << _TradeInfo->_Left << _TradeInfo->_Top;
+	}
+}
+
+QJsonObject PMessage::ToJson() const
+{
+	QJsonObject object{
+		{QStringLiteral("time"), _Date.toString(Qt::ISODateWithMs)},
+		{QStringLiteral("id"), _Id},
+		{QStringLiteral("code"), _Code},
+		{QStringLiteral("type"), QMetaEnum::fromType<Type>().valueToKey(_Type)},
+		{QStringLiteral("subtype"), QMetaEnum::fromType<Subtype>().valueToKey(_Subtype)},
+		{QStringLiteral("client"), _ClientId},
+		{QStringLiteral("contents"), _Contents}
+	};
+	if (_Subtype == Chat)
+	{
+		object.insert(QStringLiteral("channel"), GetStringFromChannel(_Channel));
+		object.insert(QStringLiteral("sender"), _ChatSubject);
+		if (!_ChatSubjectGuild.isEmpty()) object.insert(QStringLiteral("guild"), _ChatSubjectGuild);
+		object.insert(QStringLiteral("incoming"), _IsIncoming);
+	}
+	if (_TradeInfo)
+	{
+		object.insert(QStringLiteral("trade"), QJsonObject{
+			{QStringLiteral("item"), _TradeInfo->_Item},
+			{QStringLiteral("amount"), _TradeInfo->_Amount},
+			{QStringLiteral("currency"), _TradeInfo->_Currency},
+			{QStringLiteral("league"), _TradeInfo->_League},
+			{QStringLiteral("tab"), _TradeInfo->_Tab},
+			{QStringLiteral("left"), _TradeInfo->_Left},
+			{QStringLiteral("top"), _TradeInfo->_Top}
+		});
+	}
+	return object;
+}
+
+QStringList PMessage::ToCsvRecord() const
+{
+	auto isChat = _Subtype == Chat;
+	QStringList record{
+		_Date.toString(Qt::ISODateWithMs),
+		QString::number(_Id),
+		QString::number(_Code, 16),
+		QMetaEnum::fromType<Type>().valueToKey(_Type),
+		QMetaEnum::fromType<Subtype>().valueToKey(_Subtype),
+		QString::number(_ClientId),
+		isChat ? GetStringFromChannel(_Channel) : QString(),
+		_ChatSubject,
+		_ChatSubjectGuild,
+		_IsIncoming ? QStringLiteral("true") : QStringLiteral("false"),
+		_Contents
+	};
+	if (_TradeInfo)
+	{
+		record << _TradeInfo->_Item << QString::number(_TradeInfo->_Amount) << _TradeInfo->_Currency <<
+			_TradeInfo->_League << _TradeInfo->_Tab << QString::number(_TradeInfo->_Left) << 
+			QString::number(_TradeInfo->_Top);
+	}
+	else record << QString() << QString() << QString() << QString() << QString() << QString() << QString();
+	return record;
 }
@@ -15,8 +15,11 @@
  */
 #pragma once
 
+#include <QDataStream>
 #include <QDateTime>
+#include <QJsonObject>
 #include <QObject>
+#include <QVector>
 
 /**
  * Represents a message from the log.
@@ -189,6 +192,46 @@ public:
 	 */
 	static PMessage * FromString(const QString &string, QObject *parent);
 
+	/**
+	 * Reads a message that was previously written with ToStream.
+	 * @param[in] stream
+	 *   The stream from which to read the message.
+	 * @param[in] parent
+	 *   The parent of the new log message.
+	 * @return
+	 *   The log message or null if the stream did not contain a valid message.
+	 */
+	static PMessage * FromStream(QDataStream &stream, QObject *parent);
+
+	/**
+	 * Creates a message from a JSON object that was previously written with ToJson.
+	 * @param[in] object
+	 *   The JSON object describing the message.
+	 * @param[in] parent
+	 *   The parent of the new log message.
+	 * @return
+	 *   The log message or null if the object did not describe a valid message.
+	 */
+	static PMessage * FromJson(const QJsonObject &object, QObject *parent);
+
+	/**
+	 * Creates a message from a CSV record that was previously written with ToCsvRecord.
+	 * @param[in] record
+	 *   The fields of the record, in the order given by GetCsvHeader.
+	 * @param[in] parent
+	 *   The parent of the new log message.
+	 * @return
+	 *   The log message or null if the record did not describe a valid message.
+	 */
+	static PMessage * FromCsvRecord(const QStringList &record, QObject *parent);
+
+	/**
+	 * Retrieves the names of the fields written by ToCsvRecord.
+	 * @return
+	 *   The CSV column names.
+	 */
+	static QStringList GetCsvHeader();
+
 	/**
 	 * Creates a new log message.
 	 * @param[in] parent
@@ -201,6 +244,25 @@ public:
 	 */
 	virtual ~PMessage();
 
+	/**
+	 * Allocates a message from the message pool instead of individually from the heap. Objects of classes
+	 * derived from PMessage don't fit the pool, so they come from the heap.
+	 * @param[in] size
+	 *   The size of the allocation.
+	 * @return
+	 *   The storage for the message.
+	 */
+	static void * operator new(size_t size);
+
+	/**
+	 * Returns the storage of a message to the message pool.
+	 * @param[in] ptr
+	 *   The storage to release.
+	 * @param[in] size
+	 *   The size of the allocation.
+	 */
+	static void operator delete(void *ptr, size_t size);
+
 	/**
 	 * Retrieves the time of the message.
 	 * @return
@@ -295,6 +357,48 @@ public:
 	 */
 	bool IsTradeRequest() const;
 
+	/**
+	 * Indicates whether the message is the game telling the user that their last whisper couldn't be delivered.
+	 * @return
+	 *   true if the message is about an undelivered whisper, false otherwise.
+	 */
+	bool IsWhisperFailure() const;
+
+	/**
+	 * Retrieves the position of the message in the message handler's list of messages.
+	 * @return
+	 *   The index of the message or -1 if it has not been added to the message handler.
+	 */
+	int GetStoreIndex() const;
+
+	/**
+	 * Sets the position of the message in the message handler's list of messages.
+	 * This is used by the message handler when it adds the message.
+	 * @param[in] idx
+	 *   The index of the message.
+	 */
+	void SetStoreIndex(int idx);
+
+	/**
+	 * Checks whether the message matched a content filter registered with the message handler.
+	 * The result is computed once when the message is added or the filter is registered.
+	 * @param[in] filterId
+	 *   The ID of the filter returned by PMessageHandler::AddFilter.
+	 * @return
+	 *   true if the message matched the filter, false otherwise.
+	 */
+	bool MatchesFilter(int filterId) const;
+
+	/**
+	 * Records whether the message matched a content filter.
+	 * This is used by the message handler when it evaluates its filters.
+	 * @param[in] filterId
+	 *   The ID of the filter.
+	 * @param[in] matches
+	 *   true if the message matched the filter, false otherwise.
+	 */
+	void SetFilterMatch(int filterId, bool matches);
+
 	/**
 	 * Retrieves the name of the item being traded.
 	 * @return
@@ -351,6 +455,27 @@ public:
 	 */
 	QString ToString() const;
 
+	/**
+	 * Writes the message to a stream so it can be restored with FromStream.
+	 * @param[in] stream
+	 *   The stream to which to write the message.
+	 */
+	void ToStream(QDataStream &stream) const;
+
+	/**
+	 * Converts the message to a JSON object so it can be restored with FromJson.
+	 * @return
+	 *   The JSON object describing the message.
+	 */
+	QJsonObject ToJson() const;
+
+	/**
+	 * Converts the message to a CSV record so it can be restored with FromCsvRecord.
+	 * @return
+	 *   The fields of the record, in the order given by GetCsvHeader.
+	 */
+	QStringList ToCsvRecord() const;
+
 private:
 
 	/**
@@ -442,6 +567,24 @@ private:
 		 * The top position of the item in the tab.
 		 */
 		int _Top = 0;
+
+		/**
+		 * Allocates trade information from the trade information pool.
+		 * @param[in] size
+		 *   The size of the allocation.
+		 * @return
+		 *   The storage for the trade information.
+		 */
+		static void * operator new(size_t size);
+
+		/**
+		 * Returns the storage of trade information to the trade information pool.
+		 * @param[in] ptr
+		 *   The storage to release.
+		 * @param[in] size
+		 *   The size of the allocation.
+		 */
+		static void operator delete(void *ptr, size_t size);
 	};
 
 	/**
@@ -454,6 +597,21 @@ private:
 	 * This will always be true unless the chat message is a whisper.
 	 */
 	bool _IsIncoming = true;
+
+	/**
+	 * The position of the message in the message handler's list of messages.
+	 */
+	int _StoreIndex = -1;
+
+	/**
+	 * The results of the first 64 content filters, with one bit for each filter ID.
+	 */
+	quint64 _FilterMatches = 0;
+
+	/**
+	 * The results of the content filters past the first 64, which most messages never need.
+	 */
+	QVector<quint64> _MoreFilterMatches;
 };
 Q_DECLARE_METATYPE(PMessage::Channels)
 Q_DECLARE_OPERATORS_FOR_FLAGS(PMessage::Channels)
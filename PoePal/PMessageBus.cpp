@@ -0,0 +1,137 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PMessageBus.h"
+#include <algorithm>
+
+PMessageBus::PMessageBus(QObject *parent /*= nullptr*/):
+QObject(parent)
+{
+}
+
+PMessageBus::~PMessageBus()
+{
+}
+
+int PMessageBus::Subscribe(const Subscription &subscription, QObject *receiver, const Callback &callback)
+{
+	int id = _NextId++;
+	auto &subscriber = _Subscribers[id];
+	subscriber._Subscription = subscription;
+	subscriber._Receiver = receiver;
+	subscriber._Callback = callback;
+	if (receiver) connect(receiver, &QObject::destroyed, this, [this, id]() { Unsubscribe(id); });
+	RebuildRoutes();
+	return id;
+}
+
+void PMessageBus::UpdateSubscription(int id, const Subscription &subscription)
+{
+	auto iter = _Subscribers.find(id);
+	if (iter == _Subscribers.end()) return;
+	iter->_Subscription = subscription;
+	RebuildRoutes();
+}
+
+void PMessageBus::Unsubscribe(int id)
+{
+	if (_Subscribers.remove(id) == 0) return;
+	_Pending.removeOne(id);
+	RebuildRoutes();
+}
+
+int PMessageBus::GetSubscriberCount() const
+{
+	return _Subscribers.size();
+}
+
+void PMessageBus::Publish(PMessage *message)
+{
+	auto channel = message->GetSubtype() == PMessage::Chat ? message->GetChannel() : PMessage::InvalidChannel;
+	auto key = GetRouteKey(message->GetSubtype(), channel);
+	auto routes = _Routes.constFind(key);
+	if (routes != _Routes.constEnd()) Enqueue(*routes, message);
+	if (_SenderRoutes.isEmpty() || message->GetSubject().isEmpty()) return;
+	auto senderRoutes = _SenderRoutes.constFind(qMakePair(key, message->GetSubject()));
+	if (senderRoutes != _SenderRoutes.constEnd()) Enqueue(*senderRoutes, message);
+}
+
+void PMessageBus::Flush()
+{
+	// Callbacks can change the subscriptions, so work from copies.
+	auto pending = _Pending;
+	_Pending.clear();
+	for (auto id : pending)
+	{
+		auto iter = _Subscribers.find(id);
+		if (iter == _Subscribers.end()) continue;
+		auto queue = iter->_Queue;
+		iter->_Queue.clear();
+		auto receiver = iter->_Receiver;
+		auto callback = iter->_Callback;
+		for (auto message : queue)
+		{
+			if (!receiver || !_Subscribers.contains(id)) break;
+			callback(message);
+		}
+	}
+}
+
+int PMessageBus::GetRouteKey(PMessage::Subtype subtype, PMessage::Channel channel)
+{
+	// The channels are single bits below 1 << 8, so they fit under the subtype.
+	return (static_cast<int>(subtype) << 8) | static_cast<int>(channel);
+}
+
+void PMessageBus::RebuildRoutes()
+{
+	_Routes.clear();
+	_SenderRoutes.clear();
+	// Keep the subscribers in the order they subscribed, so messages are delivered in a predictable order.
+	auto ids = _Subscribers.keys();
+	std::sort(ids.begin(), ids.end());
+	for (auto id : ids)
+	{
+		const auto &subscription = _Subscribers[id]._Subscription;
+		QVector<int> keys;
+		for (auto subtype : subscription._Subtypes)
+		{
+			if (subtype != PMessage::Chat)
+			{
+				keys.append(GetRouteKey(subtype, PMessage::InvalidChannel));
+				continue;
+			}
+			for (auto channel : PMessage::GetChannels())
+			{
+				if (subscription._Channels.testFlag(channel)) keys.append(GetRouteKey(subtype, channel));
+			}
+		}
+		for (auto key : keys)
+		{
+			if (subscription._Senders.isEmpty()) _Routes[key].append(id);
+			else for (const auto &sender : subscription._Senders) _SenderRoutes[qMakePair(key, sender)].append(id);
+		}
+	}
+}
+
+void PMessageBus::Enqueue(const QVector<int> &ids, PMessage *message)
+{
+	for (auto id : ids)
+	{
+		auto &subscriber = _Subscribers[id];
+		if (subscriber._Queue.isEmpty()) _Pending.append(id);
+		subscriber._Queue.append(message);
+	}
+}
@@ -0,0 +1,202 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "PMessage.h"
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QVector>
+#include <functional>
+
+/**
+ * Delivers new messages to the parts of the application that are interested in them.
+ * Consumers subscribe with the kinds of messages they want. The subscriptions are compiled into a routing table
+ * indexed by subtype and channel, and by sender for subscriptions limited to some players, so a message is only
+ * looked at by the consumers that want it. Messages are queued for each subscriber as they are parsed and
+ * delivered once the batch they were parsed in is complete.
+ */
+class PMessageBus : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * The kinds of messages a consumer wants.
+	 */
+	struct Subscription
+	{
+		/**
+		 * The subtypes of the messages.
+		 */
+		QList<PMessage::Subtype> _Subtypes;
+
+		/**
+		 * The channels of the chat messages. This doesn't apply to other subtypes.
+		 */
+		PMessage::Channels _Channels;
+
+		/**
+		 * The senders of the messages, or empty for messages from anyone.
+		 */
+		QSet<QString> _Senders;
+	};
+
+	/**
+	 * The function called with each message for a subscriber.
+	 */
+	typedef std::function<void(PMessage *)> Callback;
+
+	/**
+	 * Creates a new message bus.
+	 * @param[in] parent
+	 *   The parent of the bus.
+	 */
+	PMessageBus(QObject *parent = nullptr);
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~PMessageBus();
+
+	/**
+	 * Adds a subscriber.
+	 * @param[in] subscription
+	 *   The kinds of messages to deliver.
+	 * @param[in] receiver
+	 *   The object receiving the messages. The subscription ends when it is destroyed.
+	 * @param[in] callback
+	 *   The function called with each message.
+	 * @return
+	 *   The ID of the subscriber.
+	 */
+	int Subscribe(const Subscription &subscription, QObject *receiver, const Callback &callback);
+
+	/**
+	 * Changes the kinds of messages delivered to a subscriber.
+	 * @param[in] id
+	 *   The ID of the subscriber.
+	 * @param[in] subscription
+	 *   The new kinds of messages to deliver.
+	 */
+	void UpdateSubscription(int id, const Subscription &subscription);
+
+	/**
+	 * Removes a subscriber. Messages queued for it are dropped.
+	 * @param[in] id
+	 *   The ID of the subscriber.
+	 */
+	void Unsubscribe(int id);
+
+	/**
+	 * Retrieves the number of subscribers.
+	 * @return
+	 *   The number of subscribers.
+	 */
+	int GetSubscriberCount() const;
+
+	/**
+	 * Queues a message for the subscribers that want it.
+	 * @param[in] message
+	 *   The new message.
+	 */
+	void Publish(PMessage *message);
+
+	/**
+	 * Delivers the queued messages.
+	 */
+	void Flush();
+
+private:
+
+	/**
+	 * A consumer of messages.
+	 */
+	struct Subscriber
+	{
+		/**
+		 * The kinds of messages the subscriber wants.
+		 */
+		Subscription _Subscription;
+
+		/**
+		 * The object receiving the messages.
+		 */
+		QPointer<QObject> _Receiver;
+
+		/**
+		 * The function called with each message.
+		 */
+		Callback _Callback;
+
+		/**
+		 * The messages waiting to be delivered.
+		 */
+		QVector<PMessage *> _Queue;
+	};
+
+	/**
+	 * Retrieves the key of the routing table for a kind of message.
+	 * @param[in] subtype
+	 *   The subtype of the message.
+	 * @param[in] channel
+	 *   The channel of a chat message or PMessage::InvalidChannel for other subtypes.
+	 * @return
+	 *   The key.
+	 */
+	static int GetRouteKey(PMessage::Subtype subtype, PMessage::Channel channel);
+
+	/**
+	 * Rebuilds the routing table from the subscriptions.
+	 */
+	void RebuildRoutes();
+
+	/**
+	 * Queues a message for subscribers.
+	 * @param[in] ids
+	 *   The IDs of the subscribers.
+	 * @param[in] message
+	 *   The message.
+	 */
+	void Enqueue(const QVector<int> &ids, PMessage *message);
+
+	/**
+	 * The subscribers, indexed by ID.
+	 */
+	QHash<int, Subscriber> _Subscribers;
+
+	/**
+	 * The ID of the next subscriber.
+	 */
+	int _NextId = 0;
+
+	/**
+	 * The subscribers that want messages from anyone, indexed by route key.
+	 */
+	QHash<int, QVector<int>> _Routes;
+
+	/**
+	 * The subscribers that want messages from some senders, indexed by route key and sender.
+	 */
+	QHash<QPair<int, QString>, QVector<int>> _SenderRoutes;
+
+	/**
+	 * The subscribers with queued messages, in the order they first had a message queued.
+	 */
+	QVector<int> _Pending;
+};
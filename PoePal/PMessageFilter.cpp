@@ -0,0 +1,175 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PMessageFilter.h"
+#include "PMessage.h"
+
+namespace
+{
+	/**
+	 * Splits a filter expression into its terms.
+	 * Quoted text, quoted prefix values and regular expressions may contain spaces.
+	 * @param[in] expression
+	 *   The filter expression.
+	 * @param[out] terms
+	 *   The terms of the expression. Regular expressions keep their enclosing slashes.
+	 * @return
+	 *   true if the expression was split, false if a quote or regular expression was not closed.
+	 */
+	bool SplitTerms(const QString &expression, QStringList &terms)
+	{
+		int pos = 0;
+		int length = expression.length();
+		while (pos < length)
+		{
+			if (expression.at(pos).isSpace())
+			{
+				++pos;
+				continue;
+			}
+			auto start = expression.at(pos);
+			if (start == '"' || start == '/')
+			{
+				int end = pos + 1;
+				while (end < length && (expression.at(end) != start || expression.at(end - 1) == '\\')) ++end;
+				if (end >= length) return false;
+				if (start == '"') terms.append(expression.mid(pos + 1, end - pos - 1));
+				else terms.append(expression.mid(pos, end - pos + 1));
+				pos = end + 1;
+			}
+			else
+			{
+				QString term;
+				int end = pos;
+				while (end < length && !expression.at(end).isSpace())
+				{
+					// A quoted value after a prefix, like item:"Tabula Rasa", is kept whole without its quotes.
+					if (expression.at(end) == '"' && end > pos && expression.at(end - 1) == ':')
+					{
+						int close = end + 1;
+						while (close < length && (expression.at(close) != '"' || expression.at(close - 1) == '\\'))
+						{
+							++close;
+						}
+						if (close >= length) return false;
+						term += expression.mid(pos, end - pos) + expression.mid(end + 1, close - end - 1);
+						pos = end = close + 1;
+						continue;
+					}
+					++end;
+				}
+				terms.append(term + expression.mid(pos, end - pos));
+				pos = end;
+			}
+		}
+		return true;
+	}
+}
+
+PMessageFilter PMessageFilter::Compile(const QString &expression, QString *error /*= nullptr*/)
+{
+	PMessageFilter filter;
+	filter._Expression = expression;
+	QStringList terms;
+	if (!SplitTerms(expression, terms))
+	{
+		if (error) *error = QObject::tr("A quote or regular expression is not closed.");
+		return filter;
+	}
+	for (const auto &term : terms)
+	{
+		if (term.length() > 1 && term.startsWith('/') && term.endsWith('/'))
+		{
+			QRegularExpression pattern(term.mid(1, term.length() - 2), 
+				QRegularExpression::CaseInsensitiveOption);
+			if (!pattern.isValid())
+			{
+				if (error) *error = pattern.errorString();
+				return filter;
+			}
+			pattern.optimize();
+			filter._Patterns.append(pattern);
+		}
+		else if (term.startsWith(QStringLiteral("item:"), Qt::CaseInsensitive))
+		{
+			filter._Items.append(term.mid(5));
+			filter._TradeOnly = true;
+		}
+		else if (term.startsWith(QStringLiteral("currency:"), Qt::CaseInsensitive))
+		{
+			filter._Currency = term.mid(9);
+			filter._TradeOnly = true;
+		}
+		else if (term.startsWith(QStringLiteral("price>"), Qt::CaseInsensitive) || 
+			term.startsWith(QStringLiteral("price<"), Qt::CaseInsensitive))
+		{
+			bool ok = false;
+			auto amount = term.mid(6).toFloat(&ok);
+			if (!ok || amount < 0.0f)
+			{
+				if (error) *error = QObject::tr("Invalid price: %1").arg(term.mid(6));
+				return filter;
+			}
+			if (term.at(5) == '>') filter._MinPrice = amount;
+			else filter._MaxPrice = amount;
+			filter._TradeOnly = true;
+		}
+		else if (!term.isEmpty()) filter._Keywords.append(term.toLower());
+	}
+	filter._Keywords.removeDuplicates();
+	filter._Valid = true;
+	return filter;
+}
+
+bool PMessageFilter::IsValid() const
+{
+	return _Valid;
+}
+
+QString PMessageFilter::GetExpression() const
+{
+	return _Expression;
+}
+
+QStringList PMessageFilter::GetKeywords() const
+{
+	return _Keywords;
+}
+
+bool PMessageFilter::Matches(PMessage *message) const
+{
+	if (!_Valid || !message) return false;
+	// Check the cheap conditions first.
+	if (_TradeOnly)
+	{
+		if (!message->IsTradeRequest()) return false;
+		auto amount = message->GetTradeAmount();
+		if (_MinPrice >= 0.0f && amount <= _MinPrice) return false;
+		if (_MaxPrice >= 0.0f && amount >= _MaxPrice) return false;
+		if (!_Currency.isEmpty() && 
+			!message->GetTradeCurrency().startsWith(_Currency, Qt::CaseInsensitive)) return false;
+		for (const auto &item : _Items)
+		{
+			if (!message->GetTradeItem().contains(item, Qt::CaseInsensitive)) return false;
+		}
+	}
+	if (_Patterns.isEmpty()) return true;
+	auto contents = message->GetContents();
+	for (const auto &pattern : _Patterns)
+	{
+		if (!pattern.match(contents).hasMatch()) return false;
+	}
+	return true;
+}
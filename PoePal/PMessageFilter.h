@@ -0,0 +1,132 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QRegularExpression>
+#include <QStringList>
+#include <QVector>
+
+class PMessage;
+
+/**
+ * A compiled filter on the contents of messages.
+ * A filter expression is a list of terms separated by spaces, and a message must match all of the terms:
+ *   word or "several words"  The contents contain the text, ignoring case.
+ *   /pattern/                The contents match the regular expression, ignoring case.
+ *   item:name                The message is a trade request for an item whose name contains the text.
+ *   price>N or price<N       The message is a trade request offering more or less than N.
+ *   currency:name            The message is a trade request offering the currency.
+ * The name of an item or currency can be quoted when it has several words, like item:"Tabula Rasa".
+ * Keywords are not tested by the filter itself. The message handler finds the keywords of all of its filters in
+ * a single pass over each message and only calls Matches for the filters whose keywords were all found.
+ */
+class PMessageFilter
+{
+public:
+
+	/**
+	 * Compiles a filter expression.
+	 * @param[in] expression
+	 *   The filter expression.
+	 * @param[out] error
+	 *   If not null, receives a description of why the expression is invalid.
+	 * @return
+	 *   The compiled filter, which is invalid if the expression could not be compiled.
+	 */
+	static PMessageFilter Compile(const QString &expression, QString *error = nullptr);
+
+	/**
+	 * Creates an invalid filter.
+	 */
+	PMessageFilter() = default;
+
+	/**
+	 * Indicates whether the filter was compiled successfully.
+	 * @return
+	 *   true if the filter is valid, false otherwise.
+	 */
+	bool IsValid() const;
+
+	/**
+	 * Retrieves the expression the filter was compiled from.
+	 * @return
+	 *   The filter expression.
+	 */
+	QString GetExpression() const;
+
+	/**
+	 * Retrieves the keywords the filter requires, in lower case.
+	 * @return
+	 *   The keywords.
+	 */
+	QStringList GetKeywords() const;
+
+	/**
+	 * Checks whether a message matches the terms of the filter other than its keywords.
+	 * @param[in] message
+	 *   The message to check.
+	 * @return
+	 *   true if the message matches, false otherwise.
+	 */
+	bool Matches(PMessage *message) const;
+
+private:
+
+	/**
+	 * The expression the filter was compiled from.
+	 */
+	QString _Expression;
+
+	/**
+	 * The keywords the contents must contain, in lower case.
+	 */
+	QStringList _Keywords;
+
+	/**
+	 * The regular expressions the contents must match.
+	 */
+	QVector<QRegularExpression> _Patterns;
+
+	/**
+	 * The text the item of a trade request must contain.
+	 */
+	QStringList _Items;
+
+	/**
+	 * The currency a trade request must offer.
+	 */
+	QString _Currency;
+
+	/**
+	 * The amount a trade request must offer more than, or a negative value if there is no minimum.
+	 */
+	float _MinPrice = -1.0f;
+
+	/**
+	 * The amount a trade request must offer less than, or a negative value if there is no maximum.
+	 */
+	float _MaxPrice = -1.0f;
+
+	/**
+	 * Indicates whether the filter is only matched by trade requests.
+	 */
+	bool _TradeOnly = false;
+
+	/**
+	 * Indicates whether the filter was compiled successfully.
+	 */
+	bool _Valid = false;
+};
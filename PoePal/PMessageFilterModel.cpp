@@ -14,15 +14,19 @@
  * <https://www.gnu.org/licenses/>.
  */
 #include "PMessageFilterModel.h"
+#include "PMessageHandler.h"
 #include "PMessageModel.h"
+#include <algorithm>
 
 PMessageFilterModel::PMessageFilterModel(QObject *parent)
-	: QSortFilterProxyModel(parent)
+	: QAbstractProxyModel(parent)
 {
 }
 
 PMessageFilterModel::~PMessageFilterModel()
 {
+	auto handler = GetHandler();
+	if (handler && _FilterId >= 0) handler->RemoveFilter(_FilterId);
 }
 
 PMessage::Channels PMessageFilterModel::GetChannels() const
@@ -32,14 +36,15 @@ PMessage::Channels PMessageFilterModel::GetChannels() const
 
 void PMessageFilterModel::SetChannels(const PMessage::Channels &channels)
 {
+	if (_Channels == channels) return;
 	_Channels = channels;
-	invalidateFilter();
+	Rebuild();
+	emit ChannelsChanged(static_cast<int>(_Channels));
 }
 
 void PMessageFilterModel::SetChannels(int channels)
 {
-	_Channels = static_cast<PMessage::Channel>(channels);
-	invalidateFilter();
+	SetChannels(PMessage::Channels(static_cast<PMessage::Channel>(channels)));
 }
 
 QStringList PMessageFilterModel::GetSubjects() const
@@ -50,22 +55,190 @@ QStringList PMessageFilterModel::GetSubjects() const
 void PMessageFilterModel::SetSubjects(const QStringList &subjects)
 {
 	_Subjects = subjects;
-	invalidateFilter();
+	_SubjectSet = QSet<QString>::fromList(subjects);
+	Rebuild();
+	emit SubjectsChanged(_Subjects);
+}
+
+QString PMessageFilterModel::GetFilter() const
+{
+	return _Filter;
+}
+
+void PMessageFilterModel::SetFilter(const QString &expression)
+{
+	auto trimmed = expression.trimmed();
+	if (trimmed == _Filter) return;
+	// Without a source model, the filter is registered once there is one.
+	auto handler = GetHandler();
+	if (handler && _FilterId >= 0) handler->RemoveFilter(_FilterId);
+	_Filter = trimmed;
+	_FilterId = handler && !_Filter.isEmpty() ? handler->AddFilter(_Filter) : -1;
+	Rebuild();
+	emit FilterChanged(_Filter);
 }
 
 PMessage * PMessageFilterModel::GetMessage(const QModelIndex &index) const
 {
 	auto msgModel = qobject_cast<PMessageModel *>(sourceModel());
-	if (!msgModel) return false;
+	if (!msgModel) return nullptr;
 	return msgModel->GetLogMessage(mapToSource(index));
 }
 
-bool PMessageFilterModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
+void PMessageFilterModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+	beginResetModel();
+	// The content filter is registered with the message handler of the source model, so it moves with it.
+	auto oldHandler = GetHandler();
+	if (oldHandler && _FilterId >= 0) oldHandler->RemoveFilter(_FilterId);
+	_FilterId = -1;
+	if (this->sourceModel())
+	{
+		disconnect(this->sourceModel(), &QAbstractItemModel::rowsInserted, this, 
+			&PMessageFilterModel::OnSourceRowsInserted);
+		disconnect(this->sourceModel(), &QAbstractItemModel::modelReset, this, &PMessageFilterModel::Rebuild);
+	}
+	QAbstractProxyModel::setSourceModel(sourceModel);
+	if (sourceModel)
+	{
+		connect(sourceModel, &QAbstractItemModel::rowsInserted, this, 
+			&PMessageFilterModel::OnSourceRowsInserted);
+		connect(sourceModel, &QAbstractItemModel::modelReset, this, &PMessageFilterModel::Rebuild);
+	}
+	auto handler = GetHandler();
+	if (handler && !_Filter.isEmpty()) _FilterId = handler->AddFilter(_Filter);
+	_Rows = FindRows();
+	endResetModel();
+}
+
+QModelIndex PMessageFilterModel::mapToSource(const QModelIndex &proxyIndex) const
+{
+	if (!proxyIndex.isValid() || !sourceModel()) return QModelIndex();
+	if (proxyIndex.row() < 0 || proxyIndex.row() >= _Rows.length()) return QModelIndex();
+	return sourceModel()->index(_Rows.at(proxyIndex.row()), proxyIndex.column());
+}
+
+QModelIndex PMessageFilterModel::mapFromSource(const QModelIndex &sourceIndex) const
+{
+	// Only the first column of the message model has a counterpart here.
+	if (!sourceIndex.isValid() || sourceIndex.column() != 0) return QModelIndex();
+	auto iter = std::lower_bound(_Rows.begin(), _Rows.end(), sourceIndex.row());
+	if (iter == _Rows.end() || *iter != sourceIndex.row()) return QModelIndex();
+	return createIndex(static_cast<int>(iter - _Rows.begin()), 0);
+}
+
+QModelIndex PMessageFilterModel::index(int row, int column, const QModelIndex &parent /*= QModelIndex()*/) const
+{
+	if (parent.isValid() || row < 0 || row >= _Rows.length() || column != 0) return QModelIndex();
+	return createIndex(row, column);
+}
+
+QModelIndex PMessageFilterModel::parent(const QModelIndex &child) const
+{
+	// We will never have any parents.
+	return QModelIndex();
+}
+
+int PMessageFilterModel::rowCount(const QModelIndex &parent /*= QModelIndex()*/) const
+{
+	if (parent.isValid()) return 0;
+	return _Rows.length();
+}
+
+int PMessageFilterModel::columnCount(const QModelIndex &parent /*= QModelIndex()*/) const
+{
+	return 1;
+}
+
+QVariant PMessageFilterModel::data(const QModelIndex &proxyIndex, int role /*= Qt::DisplayRole*/) const
+{
+	// The first column of the message model only shows the time, so the line is built here.
+	if (role == Qt::DisplayRole)
+	{
+		auto message = GetMessage(proxyIndex);
+		return message ? QVariant(message->ToString()) : QVariant();
+	}
+	return QAbstractProxyModel::data(proxyIndex, role);
+}
+
+bool PMessageFilterModel::AcceptsMessage(PMessage *message) const
 {
-	auto msgModel = qobject_cast<PMessageModel *>(sourceModel());
-	if (!msgModel) return false;
-	auto message = msgModel->GetLogMessage(msgModel->index(source_row, 0));
 	if (!message) return false;
 	return _Channels.testFlag(message->GetChannel()) && 
-		(_Subjects.isEmpty() || _Subjects.contains(message->GetSubject()));
+		(_SubjectSet.isEmpty() || _SubjectSet.contains(message->GetSubject())) &&
+		(_FilterId < 0 || message->MatchesFilter(_FilterId));
+}
+
+void PMessageFilterModel::OnSourceRowsInserted(const QModelIndex &parent, int first, int last)
+{
+	auto msgModel = qobject_cast<PMessageModel *>(sourceModel());
+	if (parent.isValid() || !msgModel) return;
+	// Rows are only ever appended to the message model, so accepted rows go on the end of the list.
+	if (!_Rows.isEmpty() && first <= _Rows.last())
+	{
+		Rebuild();
+		return;
+	}
+	QVector<int> accepted;
+	for (int r = first; r <= last; ++r)
+	{
+		if (AcceptsMessage(msgModel->GetLogMessage(msgModel->index(r, 0)))) accepted.append(r);
+	}
+	if (accepted.isEmpty()) return;
+	beginInsertRows(QModelIndex(), _Rows.length(), _Rows.length() + accepted.length() - 1);
+	_Rows.append(accepted);
+	endInsertRows();
+}
+
+void PMessageFilterModel::Rebuild()
+{
+	beginResetModel();
+	_Rows = FindRows();
+	endResetModel();
+}
+
+PMessageHandler * PMessageFilterModel::GetHandler() const
+{
+	auto msgModel = qobject_cast<PMessageModel *>(sourceModel());
+	return msgModel ? msgModel->GetHandler() : nullptr;
+}
+
+QVector<int> PMessageFilterModel::FindRows() const
+{
+	QVector<int> rows;
+	auto handler = GetHandler();
+	if (handler)
+	{
+		int numRows = sourceModel()->rowCount();
+		// Start from the messages on the accepted channels instead of testing every message. Messages that
+		// aren't chat messages have no channel, and those are only accepted when no channels are.
+		QVector<int> candidates;
+		if (_Channels == 0)
+		{
+			candidates = PMessageHandler::MergeIndexes({handler->GetSubtypeIndexes(PMessage::Event),
+				handler->GetSubtypeIndexes(PMessage::Log)});
+		}
+		else candidates = handler->GetMessageIndexes(_Channels);
+		if (_SubjectSet.isEmpty() && _FilterId < 0)
+		{
+			// The candidates are all accepted, so the list can be shared rather than copied.
+			rows = candidates;
+			if (!rows.isEmpty() && rows.last() >= numRows)
+			{
+				rows.resize(static_cast<int>(std::lower_bound(rows.begin(), rows.end(), numRows) - rows.begin()));
+			}
+			return rows;
+		}
+		for (int row : candidates)
+		{
+			if (row >= numRows) break;
+			auto message = handler->GetMessageAt(row);
+			if ((_SubjectSet.isEmpty() || _SubjectSet.contains(message->GetSubject())) &&
+				(_FilterId < 0 || message->MatchesFilter(_FilterId)))
+			{
+				rows.append(row);
+			}
+		}
+	}
+	return rows;
 }
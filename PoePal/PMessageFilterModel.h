@@ -15,13 +15,20 @@
  */
 #pragma once
 
-#include <QSortFilterProxyModel>
+#include <QAbstractProxyModel>
+#include <QSet>
+#include <QVector>
 #include "PMessage.h"
 
+class PMessageHandler;
+
 /**
- * Item model that filters another model based on the channel and sender.
+ * Item model that filters a PMessageModel based on the channel and sender.
+ * The model keeps the list of accepted source rows itself. Rows appended to the source are filtered as they
+ * arrive, and changing the filter rebuilds the list from the message handler's channel indexes rather than
+ * testing every message.
  */
-class PMessageFilterModel : public QSortFilterProxyModel
+class PMessageFilterModel : public QAbstractProxyModel
 {
 	Q_OBJECT
 
@@ -35,6 +42,11 @@ class PMessageFilterModel : public QSortFilterProxyModel
 	 */
 	Q_PROPERTY(QStringList subjects READ GetSubjects WRITE SetSubjects NOTIFY SubjectsChanged)
 
+	/**
+	 * The content filter messages must match to be included in the model.
+	 */
+	Q_PROPERTY(QString filter READ GetFilter WRITE SetFilter NOTIFY FilterChanged)
+
 public:
 
 	/**
@@ -77,6 +89,20 @@ public:
 	 */
 	void SetSubjects(const QStringList &subjects);
 
+	/**
+	 * Retrieves the content filter messages must match to be included in the model.
+	 * @return
+	 *   The filter expression or an empty string if messages are not filtered by their contents.
+	 */
+	QString GetFilter() const;
+
+	/**
+	 * Sets the content filter messages must match to be included in the model.
+	 * @param[in] expression
+	 *   The filter expression, see PMessageFilter, or an empty string to not filter by contents.
+	 */
+	void SetFilter(const QString &expression);
+
 	/**
 	 * Retrieves the log message for an index in this model.
 	 * @param[in] index
@@ -102,15 +128,100 @@ signals:
 	 */
 	void SubjectsChanged(const QStringList &subjects);
 
+	/**
+	 * Signal sent when the content filter changes.
+	 * @param[in] expression
+	 *   The new filter expression.
+	 */
+	void FilterChanged(const QString &expression);
+
+	/**
+	 * Overrides QAbstractProxyModel#setSourceModel
+	 */
+	virtual void setSourceModel(QAbstractItemModel *sourceModel) override;
+
+	/**
+	 * Overrides QAbstractProxyModel#mapToSource
+	 */
+	virtual QModelIndex mapToSource(const QModelIndex &proxyIndex) const override;
+
+	/**
+	 * Overrides QAbstractProxyModel#mapFromSource
+	 */
+	virtual QModelIndex mapFromSource(const QModelIndex &sourceIndex) const override;
+
+	/**
+	 * Overrides QAbstractItemModel#index
+	 */
+	virtual QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+
+	/**
+	 * Overrides QAbstractItemModel#parent
+	 */
+	virtual QModelIndex parent(const QModelIndex &child) const override;
+
+	/**
+	 * Overrides QAbstractItemModel#rowCount
+	 */
+	virtual int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+	/**
+	 * Overrides QAbstractItemModel#columnCount
+	 */
+	virtual int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+	/**
+	 * Overrides QAbstractProxyModel#data
+	 * The model has a single column whose display text is the whole message line. The other roles come from the
+	 * message model.
+	 */
+	virtual QVariant data(const QModelIndex &proxyIndex, int role = Qt::DisplayRole) const override;
+
 protected:
 
 	/**
-	 * Overrides QSortFilterProxyModel#filterAcceptsRow
+	 * Checks whether a message is accepted by the filter.
+	 * @param[in] message
+	 *   The message to check.
+	 * @return
+	 *   true if the message is accepted, false otherwise.
 	 */
-	virtual bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
+	bool AcceptsMessage(PMessage *message) const;
+
+private slots:
+
+	/**
+	 * Slot called when rows are inserted into the source model.
+	 * @param[in] parent
+	 *   The parent of the inserted rows.
+	 * @param[in] first
+	 *   The first inserted row.
+	 * @param[in] last
+	 *   The last inserted row.
+	 */
+	void OnSourceRowsInserted(const QModelIndex &parent, int first, int last);
 
 private:
 
+	/**
+	 * Rebuilds the list of accepted source rows after the filter or the source model changes.
+	 */
+	void Rebuild();
+
+	/**
+	 * Retrieves the message handler of the source model, which holds the messages and the content filter.
+	 * @return
+	 *   The message handler or nullptr if the source model isn't a PMessageModel.
+	 */
+	PMessageHandler * GetHandler() const;
+
+	/**
+	 * Finds the rows of the source model that are accepted by the filter.
+	 * @return
+	 *   The accepted rows in ascending order.
+	 */
+	QVector<int> FindRows() const;
+
 	/**
 	 * Sets the channels for the property.
 	 * @param[in] channels
@@ -128,4 +239,25 @@ private:
 	 * The list of subjects that are allowed.
 	 */
 	QStringList _Subjects;
+
+	/**
+	 * The subjects that are allowed, for quick lookup.
+	 */
+	QSet<QString> _SubjectSet;
+
+	/**
+	 * The content filter messages must match.
+	 */
+	QString _Filter;
+
+	/**
+	 * The ID of the content filter registered with the message handler or -1 if there is no filter.
+	 */
+	int _FilterId = -1;
+
+	/**
+	 * The accepted rows of the source model in ascending order. The position in this list is the row in this
+	 * model.
+	 */
+	QVector<int> _Rows;
 };
@@ -15,14 +15,26 @@
  */
 #include "PMessageHandler.h"
 #include "PApplication.h"
+#include "PCommandQueue.h"
+#include "PCommandTracker.h"
+#include "PLogReader.h"
+#include "PMessageBus.h"
+#include "PWin32InputInjector.h"
 #include <QBuffer>
-#include <QClipboard>
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
 #include <QFileSystemWatcher>
 #include <QJSValue>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
 #include <QTimer>
-#include "windows.h"
+#include <algorithm>
+#include <iterator>
 
 namespace
 {
@@ -70,12 +82,154 @@ namespace
 		"autoreply",
 		"delve"
 	};
+
+	/**
+	 * Identifies a message snapshot file.
+	 */
+	const quint32 _SnapshotMagic = 0x50504d53;
+
+	/**
+	 * The version of the message snapshot format. Increment this whenever PMessage::ToStream changes.
+	 */
+	const quint32 _SnapshotVersion = 1;
+
+	/**
+	 * The number of bytes of the log file before the snapshot position that are used to validate it.
+	 */
+	const qint64 _SnapshotTailLength = 1024;
+
+	/**
+	 * How often a snapshot of the messages is saved, in milliseconds.
+	 */
+	const int _SnapshotInterval = 5 * 60 * 1000;
+
+	/**
+	 * The time loading the snapshot at startup may take before it is reported as too slow, in milliseconds.
+	 */
+	const qint64 _SnapshotLoadBudget = 300;
+
+	/**
+	 * Writes a snapshot file.
+	 * This runs on a worker thread. It only reads the fields of the messages that never change once they are
+	 * parsed, and the messages stay alive until the handler has waited for the worker.
+	 * @param[in] path
+	 *   The path of the snapshot file.
+	 * @param[in] messages
+	 *   The messages to write.
+	 * @param[in] offset
+	 *   The position in the log file the messages were read up to.
+	 * @param[in] tailHash
+	 *   The hash of the log file text before the offset.
+	 */
+	void WriteSnapshot(const QString &path, const QList<PMessage *> &messages, qint64 offset, 
+		const QByteArray &tailHash)
+	{
+		QByteArray payload;
+		QDataStream payloadStream(&payload, QIODevice::WriteOnly);
+		payloadStream.setVersion(QDataStream::Qt_5_12);
+		for (const auto &message : messages) message->ToStream(payloadStream);
+		QDir().mkpath(QFileInfo(path).absolutePath());
+		QSaveFile file(path);
+		if (!file.open(QIODevice::WriteOnly))
+		{
+			qWarning() << "Could not open message snapshot for writing: " << path;
+			return;
+		}
+		QDataStream stream(&file);
+		stream.setVersion(QDataStream::Qt_5_12);
+		stream << _SnapshotMagic << _SnapshotVersion << offset << tailHash << 
+			static_cast<qint32>(messages.length()) << QCryptographicHash::hash(payload, QCryptographicHash::Md5) <<
+			static_cast<qint64>(payload.length());
+		file.write(payload);
+		if (!file.commit()) qWarning() << "Could not write message snapshot: " << file.errorString();
+	}
+
+	/**
+	 * The number of parsed messages the reader thread can get ahead of the GUI thread by.
+	 */
+	const int _ReaderRingCapacity = 8192;
+
+	/**
+	 * The number of waiting messages above which the GUI thread is asked to drain them before its next tick.
+	 */
+	const int _ReaderRingHighWater = 4096;
+
+	/**
+	 * The amount of exported text that is buffered before it is written to the file.
+	 */
+	const int _ExportBufferSize = 1 << 20;
+
+	/**
+	 * Appends a record to CSV text, quoting the fields that need it.
+	 * @param[in] record
+	 *   The fields of the record.
+	 * @param[in,out] out
+	 *   The text to which to append the record.
+	 */
+	void WriteCsvRecord(const QStringList &record, QByteArray &out)
+	{
+		for (int f = 0; f < record.size(); ++f)
+		{
+			if (f > 0) out.append(',');
+			auto field = record.at(f).toUtf8();
+			if (field.contains(',') || field.contains('"') || field.contains('\n') || field.contains('\r'))
+			{
+				out.append('"');
+				out.append(field.replace("\"", "\"\""));
+				out.append('"');
+			}
+			else out.append(field);
+		}
+		out.append('\n');
+	}
+
+	/**
+	 * Splits a line of CSV text into its fields.
+	 * @param[in] line
+	 *   The line to split, without the line ending.
+	 * @param[out] record
+	 *   The fields of the line.
+	 * @return
+	 *   true if the line is complete, false if it ends within a quoted field that continues on the next line.
+	 */
+	bool ReadCsvRecord(const QString &line, QStringList &record)
+	{
+		record.clear();
+		QString field;
+		bool quoted = false;
+		for (int c = 0; c < line.length(); ++c)
+		{
+			auto ch = line.at(c);
+			if (quoted)
+			{
+				if (ch != '"') field.append(ch);
+				else if (c + 1 < line.length() && line.at(c + 1) == '"')
+				{
+					field.append(ch);
+					++c;
+				}
+				else quoted = false;
+			}
+			else if (ch == '"') quoted = true;
+			else if (ch == ',')
+			{
+				record.append(field);
+				field.clear();
+			}
+			else field.append(ch);
+		}
+		record.append(field);
+		return !quoted;
+	}
 }
 
 PMessageHandler::PMessageHandler(QObject *parent)
-	: QObject(parent)
+	: QObject(parent), _Ring(_ReaderRingCapacity, _ReaderRingHighWater)
 {
 	_Watcher = new QFileSystemWatcher();
+	_Bus = new PMessageBus(this);
+	_CommandQueue = new PCommandQueue(new PWin32InputInjector, this);
+	_Tracker = new PCommandTracker(_CommandQueue, _Bus, this);
 	auto pfFolder = getenv("ProgramFiles(x86)");
 	_LogDirPath = QStringList{ pfFolder,  "Grinding Gear Games", "Path of Exile", "logs" }.
 		join(QDir::separator());
@@ -83,14 +237,35 @@ PMessageHandler::PMessageHandler(QObject *parent)
 	_Watcher->addPath(_LogDirPath);
 	_Timer.setInterval(10);
 
-	connect(&_Timer, &QTimer::timeout, this, &PMessageHandler::OnFileChanged);
+	connect(&_Timer, &QTimer::timeout, this, &PMessageHandler::DrainMessages);
 	connect(_Watcher, &QFileSystemWatcher::directoryChanged, this, &PMessageHandler::OnDirectoryChanged);
 
+	// Restore the messages from the last session right away so they are available to the widgets that are
+	// created after this. Only the part of the log written since the snapshot needs to be parsed.
+	LoadSnapshot();
+	_SnapshotTimer.setInterval(_SnapshotInterval);
+	connect(&_SnapshotTimer, &QTimer::timeout, this, &PMessageHandler::SaveSnapshot);
+	// The last snapshot is written before the application quits, so wait for it rather than leaving it behind.
+	connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+		SaveSnapshot();
+		WaitForSnapshot();
+	});
+
 	QTimer::singleShot(0, this, &PMessageHandler::OnDirectoryChanged);
 }
 
 PMessageHandler::~PMessageHandler()
 {
+	// The snapshot thread reads the messages, which are deleted with the handler.
+	WaitForSnapshot();
+	if (_ReaderThread)
+	{
+		_ReaderThread->quit();
+		_ReaderThread->wait();
+	}
+	// Whatever the reader handed over but was never drained is still unowned.
+	PLogReader::Entry entry;
+	while (_Ring.TryPop(entry)) delete entry._Message;
 }
 
 QList<PMessage *> PMessageHandler::GetLogMessages() const
@@ -98,6 +273,144 @@ QList<PMessage *> PMessageHandler::GetLogMessages() const
 	return _Messages;
 }
 
+PMessageBus * PMessageHandler::GetMessageBus() const
+{
+	return _Bus;
+}
+
+PCommandQueue * PMessageHandler::GetCommandQueue() const
+{
+	return _CommandQueue;
+}
+
+PCommandTracker * PMessageHandler::GetCommandTracker() const
+{
+	return _Tracker;
+}
+
+QVariantList PMessageHandler::GetCommandStatistics() const
+{
+	return _Tracker->GetStatisticsList();
+}
+
+int PMessageHandler::GetMessageCount() const
+{
+	return _Messages.length();
+}
+
+PMessage * PMessageHandler::GetMessageAt(int idx) const
+{
+	if (idx < 0 || idx >= _Messages.length()) return nullptr;
+	return _Messages.at(idx);
+}
+
+int PMessageHandler::FindMessageAt(const QDateTime &time) const
+{
+	auto iter = std::lower_bound(_Messages.begin(), _Messages.end(), time, 
+		[](const PMessage *message, const QDateTime &t) { return message->GetTime() < t; });
+	return static_cast<int>(iter - _Messages.begin());
+}
+
+QVector<int> PMessageHandler::GetChannelIndexes(PMessage::Channel channel) const
+{
+	return _ChannelIndexes.value(channel);
+}
+
+QVector<int> PMessageHandler::GetSubtypeIndexes(PMessage::Subtype subtype) const
+{
+	return _SubtypeIndexes.value(subtype);
+}
+
+QVector<int> PMessageHandler::GetWhisperIndexes(const QString &partner) const
+{
+	return _WhisperIndexes.value(partner);
+}
+
+QVector<int> PMessageHandler::GetMessageIndexes(PMessage::Channels channels, 
+	bool includeEvents /*= false*/) const
+{
+	QVector<QVector<int>> indexLists;
+	for (const auto &channel : PMessage::GetChannels())
+	{
+		if (channels.testFlag(channel) && _ChannelIndexes.contains(channel))
+		{
+			indexLists.append(_ChannelIndexes.value(channel));
+		}
+	}
+	if (includeEvents && _SubtypeIndexes.contains(PMessage::Event))
+	{
+		indexLists.append(_SubtypeIndexes.value(PMessage::Event));
+	}
+	return MergeIndexes(indexLists);
+}
+
+QVector<int> PMessageHandler::GetMessageIndexesBefore(PMessage::Channels channels, bool includeEvents, 
+	int before, int count) const
+{
+	QVector<const QVector<int> *> lists;
+	for (const auto &channel : PMessage::GetChannels())
+	{
+		auto iter = _ChannelIndexes.find(channel);
+		if (channels.testFlag(channel) && iter != _ChannelIndexes.end()) lists.append(&iter.value());
+	}
+	auto events = _SubtypeIndexes.find(PMessage::Event);
+	if (includeEvents && events != _SubtypeIndexes.end()) lists.append(&events.value());
+	// Find where each list passes the starting point, then walk backwards taking the latest index each time.
+	QVector<int> positions;
+	for (const auto &list : lists)
+	{
+		positions.append(static_cast<int>(std::lower_bound(list->begin(), list->end(), before) - list->begin()));
+	}
+	QVector<int> indexes;
+	while (indexes.length() < count)
+	{
+		int best = -1;
+		for (int l = 0; l < lists.length(); ++l)
+		{
+			if (positions.at(l) > 0 && (best < 0 || 
+				lists.at(l)->at(positions.at(l) - 1) > lists.at(best)->at(positions.at(best) - 1)))
+			{
+				best = l;
+			}
+		}
+		if (best < 0) break;
+		auto index = lists.at(best)->at(positions.at(best) - 1);
+		// An event can be in a channel list as well, so step past it in every list that has it.
+		for (int l = 0; l < lists.length(); ++l)
+		{
+			if (positions.at(l) > 0 && lists.at(l)->at(positions.at(l) - 1) == index) --positions[l];
+		}
+		indexes.append(index);
+	}
+	std::reverse(indexes.begin(), indexes.end());
+	return indexes;
+}
+
+QVector<int> PMessageHandler::MergeIndexes(const QVector<QVector<int>> &indexLists)
+{
+	// A single list can be shared as-is.
+	if (indexLists.isEmpty()) return QVector<int>();
+	if (indexLists.length() == 1) return indexLists.first();
+	int total = 0;
+	for (const auto &list : indexLists) total += list.length();
+	QVector<int> merged;
+	merged.reserve(total);
+	// There are only ever a handful of lists, so a linear scan for the smallest head is cheaper than a heap.
+	QVector<int> positions(indexLists.length(), 0);
+	int numLists = indexLists.length();
+	while (merged.length() < total)
+	{
+		int best = -1;
+		for (int l = 0; l < numLists; ++l)
+		{
+			if (positions[l] >= indexLists[l].length()) continue;
+			if (best < 0 || indexLists[l][positions[l]] < indexLists[best][positions[best]]) best = l;
+		}
+		merged.append(indexLists[best][positions[best]++]);
+	}
+	return merged;
+}
+
 QList<PMessageHandler::Action> PMessageHandler::GetAllActions() const
 {
 	static QList<Action> actions{
@@ -156,163 +469,196 @@ PMessageHandler::Action PMessageHandler::GetActionFromCommand(const QString &com
 	return static_cast<PMessageHandler::Action>(_Commands.indexOf(command));
 }
 
-void PMessageHandler::SendChatMessage(PMessage::Channel channel, const QString &message, 
-	const QString &target /*= QString()*/, bool retainFocus/*=true*/)
+qint64 PMessageHandler::ExportMessages(const QString &path, ExportFormat format/*=Ndjson*/, 
+	const QDateTime &from/*=QDateTime()*/, const QDateTime &to/*=QDateTime()*/) const
 {
-	auto thisWin = GetActiveWindow();
-	auto hwnd = FindWindow(NULL, L"Path of Exile");
-	if (!hwnd)
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly))
 	{
-		qWarning() << "Sending chat message, Path of Exile window not found";
-		return;
+		qWarning() << "Could not open export file for writing: " << path;
+		return -1;
+	}
+	QByteArray buffer;
+	buffer.reserve(_ExportBufferSize + 4096);
+	if (format == Csv) WriteCsvRecord(PMessage::GetCsvHeader(), buffer);
+	qint64 count = 0;
+	for (const auto &message : _Messages)
+	{
+		auto time = message->GetTime();
+		if ((from.isValid() && time < from) || (to.isValid() && time > to)) continue;
+		if (format == Csv) WriteCsvRecord(message->ToCsvRecord(), buffer);
+		else
+		{
+			buffer.append(QJsonDocument(message->ToJson()).toJson(QJsonDocument::Compact));
+			buffer.append('\n');
+		}
+		++count;
+		if (buffer.length() >= _ExportBufferSize)
+		{
+			file.write(buffer);
+			buffer.clear();
+		}
+	}
+	file.write(buffer);
+	if (!file.commit())
+	{
+		qWarning() << "Could not write export file: " << file.errorString();
+		return -1;
+	}
+	return count;
+}
+
+qint64 PMessageHandler::ImportMessages(const QString &path, ExportFormat format/*=Ndjson*/)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "Could not open import file for reading: " << path;
+		return -1;
+	}
+	QVector<PMessage *> imported;
+	QStringList record;
+	QString pending;
+	// Skip the header row.
+	if (format == Csv) file.readLine();
+	while (!file.atEnd())
+	{
+		auto line = file.readLine();
+		PMessage *message = nullptr;
+		if (format == Csv)
+		{
+			// A quoted field can span several lines, so keep reading until the record is complete.
+			pending.append(QString::fromUtf8(line));
+			if (!ReadCsvRecord(pending, record)) continue;
+			if (!record.isEmpty() && record.last().endsWith('\n')) record.last().chop(1);
+			if (!record.isEmpty() && record.last().endsWith('\r')) record.last().chop(1);
+			pending.clear();
+			message = PMessage::FromCsvRecord(record, this);
+		}
+		else
+		{
+			auto doc = QJsonDocument::fromJson(line);
+			if (doc.isObject()) message = PMessage::FromJson(doc.object(), this);
+		}
+		if (!message) continue;
+		if (!_Filters.isEmpty()) EvaluateFilters(message, _Filters.keys());
+		imported.append(message);
 	}
-	auto app = qobject_cast<PApplication *>(qApp);
-	Q_ASSERT(app);
+	MergeMessages(imported);
+	return imported.length();
+}
+
+int PMessageHandler::AddFilter(const QString &expression)
+{
+	QString error;
+	auto filter = PMessageFilter::Compile(expression, &error);
+	if (!filter.IsValid())
+	{
+		qWarning() << "Invalid message filter: " << expression << error;
+		emit FilterFailed(expression, error);
+		return -1;
+	}
+	// The filter results are stored as bits on the messages, so the IDs are kept small by reusing free ones.
+	int filterId = 0;
+	while (_Filters.contains(filterId)) ++filterId;
+	_Filters.insert(filterId, filter);
+	for (const auto &keyword : filter.GetKeywords()) _FilterKeywords[keyword]++;
+	UpdateKeywordMatcher();
+	for (const auto &message : _Messages) EvaluateFilters(message, {filterId});
+	return filterId;
+}
+
+void PMessageHandler::RemoveFilter(int filterId)
+{
+	if (!_Filters.contains(filterId)) return;
+	for (const auto &keyword : _Filters.take(filterId).GetKeywords())
+	{
+		if (--_FilterKeywords[keyword] <= 0) _FilterKeywords.remove(keyword);
+	}
+	UpdateKeywordMatcher();
+	for (const auto &message : _Messages) message->SetFilterMatch(filterId, false);
+}
+
+void PMessageHandler::SendChatMessage(PMessage::Channel channel, const QString &message, 
+	const QString &target /*= QString()*/, bool retainFocus/*=true*/)
+{
 	QString text = PMessage::GetPrefixFromChannel(channel);
 	if (text[0] == '\0') text.clear();
 	if (channel == PMessage::Whisper) text += target + ' ';
 	text += message;
-	app->clipboard()->setText(text);
-	auto threadId = GetWindowThreadProcessId(hwnd, nullptr);
-	auto currThread = GetCurrentThreadId();
-	AttachThreadInput(currThread, threadId, TRUE);
-	SetFocus(hwnd);
-	SetForegroundWindow(hwnd);
-	SetActiveWindow(hwnd);
-	INPUT input;
-	input.type = INPUT_KEYBOARD;
-	input.ki.wScan = 0;
-	input.ki.time = 0;
-	input.ki.dwExtraInfo = 0;
-
-	// Press the "Enter" key
-	input.ki.wVk = VK_RETURN;
-	input.ki.dwFlags = 0; // 0 for key press
-	SendInput(1, &input, sizeof(INPUT));
-
-	// Release the "Enter" key
-	input.ki.wVk = VK_RETURN;
-	input.ki.dwFlags = KEYEVENTF_KEYUP; // 0 for key press
-	SendInput(1, &input, sizeof(INPUT));
-
-	// Press the "Ctrl" key
-	input.ki.wVk = VK_CONTROL;
-	input.ki.dwFlags = 0; // 0 for key press
-	SendInput(1, &input, sizeof(INPUT));
-
-	// Press the "V" key
-	input.ki.wVk = 'A';
-	input.ki.dwFlags = 0; // 0 for key press
-	SendInput(1, &input, sizeof(INPUT));
-
-	// Release the "V" key
-	input.ki.wVk = 'A';
-	input.ki.dwFlags = KEYEVENTF_KEYUP;
-	SendInput(1, &input, sizeof(INPUT));
-
-	// Release the "Ctrl" key
-	input.ki.wVk = VK_CONTROL;
-	input.ki.dwFlags = KEYEVENTF_KEYUP;
-	SendInput(1, &input, sizeof(INPUT));
-
-	// Press the "Backspace" key
-	input.ki.wVk = VK_BACK;
-	input.ki.dwFlags = 0; // 0 for key press
-	SendInput(1, &input, sizeof(INPUT));
-
-	// Release the "Backspace" key
-	input.ki.wVk = VK_BACK;
-	input.ki.dwFlags = KEYEVENTF_KEYUP; // 0 for key press
-	SendInput(1, &input, sizeof(INPUT));
-
-	// Press the "Ctrl" key
-	input.ki.wVk = VK_CONTROL;
-	input.ki.dwFlags = 0; // 0 for key press
-	SendInput(1, &input, sizeof(INPUT));
-
-	// Press the "V" key
-	input.ki.wVk = 'V';
-	input.ki.dwFlags = 0; // 0 for key press
-	SendInput(1, &input, sizeof(INPUT));
-
-	// Release the "V" key
-	input.ki.wVk = 'V';
-	input.ki.dwFlags = KEYEVENTF_KEYUP;
-	SendInput(1, &input, sizeof(INPUT));
-
-	// Release the "Ctrl" key
-	input.ki.wVk = VK_CONTROL;
-	input.ki.dwFlags = KEYEVENTF_KEYUP;
-	SendInput(1, &input, sizeof(INPUT));
-
-	// Press the "Enter" key
-	input.ki.wVk = VK_RETURN;
-	input.ki.dwFlags = 0; // 0 for key press
-	SendInput(1, &input, sizeof(INPUT));
-
-	// Release the "Enter" key
-	input.ki.wVk = VK_RETURN;
-	input.ki.dwFlags = KEYEVENTF_KEYUP; // 0 for key press
-	SendInput(1, &input, sizeof(INPUT));
-
-	AttachThreadInput(currThread, threadId, FALSE);
-	if (retainFocus)
-	{
-		QTimer::singleShot(10, [thisWin]() {
-			SetFocus(thisWin);
-			SetForegroundWindow(thisWin);
-			SetActiveWindow(thisWin);
-		});
-	}
+	_CommandQueue->Enqueue(text, QString(), retainFocus);
 }
 
 void PMessageHandler::SendAction(Action action, const QString &args/*=QString()*/, bool retainFocus/*=true*/)
 {
+	auto command = GetCommandFromAction(action);
 	if (args.isEmpty())
 	{
-		SendChatMessage(PMessage::Local, "/" + GetCommandFromAction(action), QString(), retainFocus);
-	}
-	else
-	{
-		SendChatMessage(PMessage::Local, "/" + GetCommandFromAction(action) + " " + args, QString(), 
-			retainFocus);
+		_CommandQueue->Enqueue("/" + command, QString(), retainFocus);
+		return;
 	}
+	// Commands that set a message replace one that is still waiting, since only the last one would stick.
+	QString coalesceKey;
+	if (action == Status || action == Autoreply || action == PartyDescription) coalesceKey = command;
+	_CommandQueue->Enqueue("/" + command + " " + args, coalesceKey, retainFocus);
+}
+
+void PMessageHandler::SaveSnapshot()
+{
+	// A snapshot that is still being written is left to finish; the next one picks up the newer messages.
+	if (!_ReaderThread || _SnapshotThread) return;
+	// The snapshot position is the first byte that has not been turned into a message yet.
+	qint64 offset = _ReadOffset;
+	auto tailHash = HashLogTail(offset);
+	auto path = GetSnapshotPath();
+	// The list is shared with the worker, so taking it costs nothing and messages appended meanwhile don't
+	// touch the worker's copy.
+	auto messages = _Messages;
+	_SnapshotThread = QThread::create([path, messages, offset, tailHash]() {
+		WriteSnapshot(path, messages, offset, tailHash);
+	});
+	connect(_SnapshotThread, &QThread::finished, _SnapshotThread, &QObject::deleteLater);
+	_SnapshotThread->start();
+}
+
+void PMessageHandler::WaitForSnapshot()
+{
+	if (_SnapshotThread) _SnapshotThread->wait();
 }
 
-void PMessageHandler::OnFileChanged()
+void PMessageHandler::DrainMessages()
 {
-	if (_File->atEnd()) return;
-	QByteArray contents = _Remainder + _File->readAll();
-	int lineBegin = 0;
-	int lineEnd = 0;
-	while ((lineEnd = contents.indexOf('\r', lineBegin)) >= 0)
+	// Clear the request first so the reader can ask again for whatever it adds while this runs.
+	_Ring.ClearDrainRequest();
+	int first = _Messages.length();
+	PLogReader::Entry entry;
+	while (_Ring.TryPop(entry))
 	{
-		auto line = QString::fromUtf8(contents.mid(lineBegin, lineEnd - lineBegin));
-		auto newMsg = PMessage::FromString(line, this);
-		if (newMsg)
-		{
-			_Messages.append(newMsg);
-			if(_Initialized) emit NewMessage(newMsg);
-		}
-		else qDebug() << "Line not recognized as a message: " << line;
-		lineBegin = lineEnd + 1;
+		entry._Message->setParent(this);
+		AppendMessage(entry._Message);
+		_ReadOffset = entry._Offset;
 	}
+	_Bus->Flush();
+	if (_Messages.length() > first) emit MessagesAppended(first, _Messages.length() - 1);
 }
 
 void PMessageHandler::OnDirectoryChanged()
 {
-	// If the file is already open or doesn't exist, don't bother.
-	if (_File || !QFile::exists(_LogFilePath)) return;
-	_File = new QFile(_LogFilePath, this);
-	if (!_File->open(QIODevice::ReadOnly))
-	{
-		qWarning("Could not open client log file for reading.");
-		delete _File;
-		_File = nullptr;
-	}
-	_File->seek(_File->size());
+	// If the file is already being read or doesn't exist, don't bother.
+	if (_ReaderThread || !QFile::exists(_LogFilePath)) return;
+	// Resume where the snapshot left off, if there was one. Otherwise, only new messages are read.
+	auto size = QFileInfo(_LogFilePath).size();
+	_ReadOffset = _SnapshotOffset >= 0 && _SnapshotOffset <= size ? _SnapshotOffset : size;
+	_ReaderThread = new QThread(this);
+	auto reader = new PLogReader(_LogFilePath, _ReadOffset, &_Ring, thread());
+	reader->moveToThread(_ReaderThread);
+	connect(_ReaderThread, &QThread::started, reader, &PLogReader::Start);
+	connect(_ReaderThread, &QThread::finished, reader, &QObject::deleteLater);
+	connect(reader, &PLogReader::DrainRequested, this, &PMessageHandler::DrainMessages);
+	_ReaderThread->start();
 	_Watcher->deleteLater();
 	_Timer.start();
+	_SnapshotTimer.start();
 	_Initialized = true;
 	emit Initialized();
 }
@@ -323,15 +669,177 @@ QQmlListProperty<PMessage> PMessageHandler::GetLogMessagesProperty() const
 	{
 		auto scanner = qobject_cast<PMessageHandler *>(prop->object);
 		Q_ASSERT(scanner);
-		return scanner->GetLogMessages().length();
+		return scanner->GetMessageCount();
 	};
 	static QQmlListProperty<PMessage>::AtFunction atFunc = [](QQmlListProperty<PMessage> *prop,
 		int index)
 	{
 		auto scanner = qobject_cast<PMessageHandler *>(prop->object);
 		Q_ASSERT(scanner);
-		return scanner->GetLogMessages().at(index);
+		return scanner->GetMessageAt(index);
 	};
 	return QQmlListProperty<PMessage>(const_cast<PMessageHandler *>(this), nullptr, countFunc, atFunc);
 }
 
+void PMessageHandler::AppendMessage(PMessage *message)
+{
+	if (!_Filters.isEmpty()) EvaluateFilters(message, _Filters.keys());
+	IndexMessage(message);
+	if (_Initialized)
+	{
+		emit NewMessage(message);
+		_Bus->Publish(message);
+	}
+}
+
+void PMessageHandler::IndexMessage(PMessage *message)
+{
+	int idx = _Messages.length();
+	message->SetStoreIndex(idx);
+	_Messages.append(message);
+	if (message->GetSubtype() == PMessage::Chat) _ChannelIndexes[message->GetChannel()].append(idx);
+	_SubtypeIndexes[message->GetSubtype()].append(idx);
+	if (message->GetSubtype() == PMessage::Chat && message->GetChannel() == PMessage::Whisper)
+	{
+		_LastWhisperPartner = message->GetSubject();
+		_WhisperIndexes[_LastWhisperPartner].append(idx);
+	}
+	else if (!_LastWhisperPartner.isEmpty() && message->IsWhisperFailure())
+	{
+		_WhisperIndexes[_LastWhisperPartner].append(idx);
+	}
+}
+
+void PMessageHandler::MergeMessages(QVector<PMessage *> messages)
+{
+	if (messages.isEmpty()) return;
+	auto byTime = [](PMessage *left, PMessage *right) { return left->GetTime() < right->GetTime(); };
+	std::stable_sort(messages.begin(), messages.end(), byTime);
+	int first = _Messages.length();
+	if (_Messages.isEmpty() || !byTime(messages.first(), _Messages.last()))
+	{
+		// Nothing loaded is newer, so the messages simply go at the end.
+		for (const auto &message : messages) IndexMessage(message);
+		emit MessagesAppended(first, _Messages.length() - 1);
+		return;
+	}
+	// Otherwise the store is rebuilt so it stays in time order for FindMessageAt and the indexes stay sorted.
+	QVector<PMessage *> merged;
+	merged.reserve(_Messages.length() + messages.length());
+	std::merge(_Messages.cbegin(), _Messages.cend(), messages.cbegin(), messages.cend(), 
+		std::back_inserter(merged), byTime);
+	_Messages.clear();
+	_ChannelIndexes.clear();
+	_SubtypeIndexes.clear();
+	_WhisperIndexes.clear();
+	_LastWhisperPartner.clear();
+	_Messages.reserve(merged.length());
+	for (const auto &message : merged) IndexMessage(message);
+	emit MessagesReset();
+}
+
+void PMessageHandler::EvaluateFilters(PMessage *message, const QList<int> &filterIds) const
+{
+	QBitArray keywordHits;
+	if (!_FilterKeywords.isEmpty()) keywordHits = _KeywordMatcher.Find(message->GetContents());
+	for (int filterId : filterIds)
+	{
+		bool matches = true;
+		for (int keywordIdx : _FilterKeywordIndexes.value(filterId))
+		{
+			if (!keywordHits.testBit(keywordIdx))
+			{
+				matches = false;
+				break;
+			}
+		}
+		message->SetFilterMatch(filterId, matches && _Filters.value(filterId).Matches(message));
+	}
+}
+
+void PMessageHandler::UpdateKeywordMatcher()
+{
+	_KeywordMatcher.SetKeywords(_FilterKeywords.keys());
+	_FilterKeywordIndexes.clear();
+	for (auto iter = _Filters.cbegin(); iter != _Filters.cend(); ++iter)
+	{
+		QVector<int> indexes;
+		for (const auto &keyword : iter.value().GetKeywords()) indexes.append(_KeywordMatcher.IndexOf(keyword));
+		_FilterKeywordIndexes.insert(iter.key(), indexes);
+	}
+}
+
+bool PMessageHandler::LoadSnapshot()
+{
+	QElapsedTimer timer;
+	timer.start();
+	QFile file(GetSnapshotPath());
+	if (!file.open(QIODevice::ReadOnly)) return false;
+	auto size = file.size();
+	auto data = file.map(0, size);
+	if (!data) return false;
+	// Read straight out of the mapped file rather than copying it into memory first.
+	auto raw = QByteArray::fromRawData(reinterpret_cast<const char *>(data), size);
+	QDataStream stream(raw);
+	stream.setVersion(QDataStream::Qt_5_12);
+	quint32 magic = 0, version = 0;
+	stream >> magic >> version;
+	if (magic != _SnapshotMagic || version != _SnapshotVersion) return false;
+	qint64 offset = -1, payloadLength = 0;
+	qint32 count = 0;
+	QByteArray tailHash, payloadHash;
+	stream >> offset >> tailHash >> count >> payloadHash >> payloadLength;
+	auto payloadPos = stream.device()->pos();
+	if (stream.status() != QDataStream::Ok || payloadPos + payloadLength != size) return false;
+	auto payload = QByteArray::fromRawData(raw.constData() + payloadPos, payloadLength);
+	if (QCryptographicHash::hash(payload, QCryptographicHash::Md5) != payloadHash)
+	{
+		qWarning("Message snapshot is corrupt, ignoring it.");
+		return false;
+	}
+	// The snapshot only applies if the log file still contains the text it was taken from.
+	if (HashLogTail(offset) != tailHash) return false;
+	QDataStream payloadStream(payload);
+	payloadStream.setVersion(QDataStream::Qt_5_12);
+	_Messages.reserve(count);
+	for (int m = 0; m < count; ++m)
+	{
+		auto message = PMessage::FromStream(payloadStream, this);
+		if (!message)
+		{
+			qWarning("Message snapshot could not be read, ignoring it.");
+			qDeleteAll(_Messages);
+			_Messages.clear();
+			_ChannelIndexes.clear();
+			_SubtypeIndexes.clear();
+			_WhisperIndexes.clear();
+			_LastWhisperPartner.clear();
+			return false;
+		}
+		AppendMessage(message);
+	}
+	_SnapshotOffset = offset;
+	auto elapsed = timer.elapsed();
+	qDebug() << "Loaded" << count << "messages from snapshot in" << elapsed << "ms";
+	if (elapsed > _SnapshotLoadBudget)
+	{
+		qWarning() << "Loading the message snapshot took" << elapsed << "ms, more than the" << _SnapshotLoadBudget <<
+			"ms budget";
+	}
+	return true;
+}
+
+QString PMessageHandler::GetSnapshotPath() const
+{
+	return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + QDir::separator() + 
+		"messages.snapshot";
+}
+
+QByteArray PMessageHandler::HashLogTail(qint64 offset) const
+{
+	QFile file(_LogFilePath);
+	if (offset < 0 || !file.open(QIODevice::ReadOnly) || file.size() < offset) return QByteArray();
+	auto begin = qMax<qint64>(0, offset - _SnapshotTailLength);
+	file.seek(begin);
+	return QCryptographicHash::hash(file.read(offset - begin), QCryptographicHash::Md5);
+}
@@ -15,16 +15,26 @@
  */
 #pragma once
 
+#include "PLogReader.h"
 #include "PMessage.h"
+#include "PKeywordMatcher.h"
+#include "PMessageFilter.h"
 
+#include <QHash>
 #include <QObject>
+#include <QPointer>
 #include <QQmlListProperty>
 #include <QTextStream>
 #include <QTimer>
+#include <QVariantList>
+#include <QVector>
 
-class QFile;
+class PCommandQueue;
+class PCommandTracker;
+class PMessageBus;
 class QFileSystemWatcher;
 class QJSValue;
+class QThread;
 
 /**
  * Scans the PoE log file for messages.
@@ -173,6 +183,20 @@ public:
 	};
 	Q_ENUM(Action)
 
+	/**
+	 * Formats that messages can be exported to and imported from.
+	 * @param Ndjson
+	 *   Newline delimited JSON, with one JSON object per message.
+	 * @param Csv
+	 *   Comma separated values, with a header row followed by one row per message.
+	 */
+	enum ExportFormat
+	{
+		Ndjson,
+		Csv
+	};
+	Q_ENUM(ExportFormat)
+
 	/**
 	 * Creates a new log scanner.
 	 * @param[in] parent
@@ -192,6 +216,132 @@ public:
 	 */
 	QList<PMessage *> GetLogMessages() const;
 
+	/**
+	 * Retrieves the bus that delivers new messages to the parts of the application interested in them.
+	 * @return
+	 *   The message bus.
+	 */
+	PMessageBus * GetMessageBus() const;
+
+	/**
+	 * Retrieves the queue that chat messages and commands are sent to the game through.
+	 * @return
+	 *   The command queue.
+	 */
+	PCommandQueue * GetCommandQueue() const;
+
+	/**
+	 * Retrieves the tracker that measures how long commands take to show up in the log.
+	 * @return
+	 *   The command tracker.
+	 */
+	PCommandTracker * GetCommandTracker() const;
+
+	/**
+	 * Retrieves the round trip statistics of the commands sent to the game.
+	 * @return
+	 *   The statistics for each kind of command. See PCommandTracker#GetStatisticsList.
+	 */
+	Q_INVOKABLE QVariantList GetCommandStatistics() const;
+
+	/**
+	 * Retrieves the number of log messages that have been loaded.
+	 * @return
+	 *   The number of log messages.
+	 */
+	int GetMessageCount() const;
+
+	/**
+	 * Retrieves a log message without copying the list of messages.
+	 * @param[in] idx
+	 *   The index of the message in the list returned by GetLogMessages().
+	 * @return
+	 *   The message or null if the index is out of range.
+	 */
+	PMessage * GetMessageAt(int idx) const;
+
+	/**
+	 * Finds the first message logged at or after a time.
+	 * The messages are in the order they were logged, so this is a binary search.
+	 * @param[in] time
+	 *   The time to look for.
+	 * @return
+	 *   The index of the first message at or after the time, or the number of messages if there is none.
+	 */
+	Q_INVOKABLE int FindMessageAt(const QDateTime &time) const;
+
+	/**
+	 * Retrieves the indexes of all messages sent on a channel.
+	 * The indexes refer to positions in the list returned by GetLogMessages() and are in ascending order.
+	 * @param[in] channel
+	 *   The channel for which to retrieve the message indexes.
+	 * @return
+	 *   The indexes of the messages sent on the channel.
+	 */
+	QVector<int> GetChannelIndexes(PMessage::Channel channel) const;
+
+	/**
+	 * Retrieves the indexes of all messages of a subtype.
+	 * The indexes refer to positions in the list returned by GetLogMessages() and are in ascending order.
+	 * @param[in] subtype
+	 *   The subtype for which to retrieve the message indexes.
+	 * @return
+	 *   The indexes of the messages of the subtype.
+	 */
+	QVector<int> GetSubtypeIndexes(PMessage::Subtype subtype) const;
+
+	/**
+	 * Retrieves the indexes of the messages of a whisper conversation.
+	 * This includes the whispers to and from the player, and the notices that a whisper couldn't be delivered
+	 * that came while the player was the last one whispered.
+	 * The indexes refer to positions in the list returned by GetLogMessages() and are in ascending order.
+	 * @param[in] partner
+	 *   The player being whispered.
+	 * @return
+	 *   The indexes of the messages of the conversation.
+	 */
+	QVector<int> GetWhisperIndexes(const QString &partner) const;
+
+	/**
+	 * Retrieves the indexes of all messages sent on any of the given channels.
+	 * This only visits the messages on the requested channels, so the cost depends on the number of matching
+	 * messages rather than the total number of messages.
+	 * @param[in] channels
+	 *   The channels for which to retrieve the message indexes.
+	 * @param[in] includeEvents
+	 *   true if event messages should be included as well, false otherwise.
+	 * @return
+	 *   The indexes of the matching messages in ascending order.
+	 */
+	QVector<int> GetMessageIndexes(PMessage::Channels channels, bool includeEvents = false) const;
+
+	/**
+	 * Retrieves the indexes of the latest messages before a given message sent on any of the given channels.
+	 * This is used to page back through the history. It only looks at the messages it returns, so the cost
+	 * depends on the page size rather than the number of messages.
+	 * @param[in] channels
+	 *   The channels for which to retrieve the message indexes.
+	 * @param[in] includeEvents
+	 *   true if event messages should be included as well, false otherwise.
+	 * @param[in] before
+	 *   The index before which to look for messages.
+	 * @param[in] count
+	 *   The maximum number of indexes to retrieve.
+	 * @return
+	 *   The indexes of the matching messages in ascending order.
+	 */
+	QVector<int> GetMessageIndexesBefore(PMessage::Channels channels, bool includeEvents, int before, 
+		int count) const;
+
+	/**
+	 * Merges several lists of message indexes into one.
+	 * @param[in] indexLists
+	 *   The lists of indexes to merge. Each list must be in ascending order.
+	 * @return
+	 *   The merged list of indexes in ascending order.
+	 */
+	static QVector<int> MergeIndexes(const QVector<QVector<int>> &indexLists);
+
 	/**
 	 * Retrieves the list of all available actions.
 	 * @return
@@ -217,6 +367,56 @@ public:
 	 */
 	Q_INVOKABLE Action GetActionFromCommand(const QString &command) const;
 
+	/**
+	 * Exports the loaded messages to a file.
+	 * The file is written as it goes, so the memory used does not depend on the number of messages.
+	 * @param[in] path
+	 *   The path of the file to write.
+	 * @param[in] format
+	 *   The format to write the messages in.
+	 * @param[in] from
+	 *   The earliest time of the messages to export, or an invalid time to start with the first message.
+	 * @param[in] to
+	 *   The latest time of the messages to export, or an invalid time to end with the last message.
+	 * @return
+	 *   The number of messages exported or -1 if the file could not be written.
+	 */
+	Q_INVOKABLE qint64 ExportMessages(const QString &path, ExportFormat format = Ndjson, 
+		const QDateTime &from = QDateTime(), const QDateTime &to = QDateTime()) const;
+
+	/**
+	 * Imports messages from a file that was written by ExportMessages.
+	 * The imported messages are merged into the loaded messages in time order. They are not sent out as new
+	 * messages, so chat widgets and notifications don't react to them. The file is read a line at a time, and
+	 * lines that do not describe a valid message are skipped.
+	 * @param[in] path
+	 *   The path of the file to read.
+	 * @param[in] format
+	 *   The format the messages are in.
+	 * @return
+	 *   The number of messages imported or -1 if the file could not be read.
+	 */
+	Q_INVOKABLE qint64 ImportMessages(const QString &path, ExportFormat format = Ndjson);
+
+	/**
+	 * Registers a content filter.
+	 * Every message is tested against all registered filters once, when it is added, and the result is stored
+	 * on the message so that the widgets using a filter only need to check PMessage::MatchesFilter. The
+	 * messages already loaded are tested when the filter is registered.
+	 * @param[in] expression
+	 *   The filter expression. See PMessageFilter for the syntax.
+	 * @return
+	 *   The ID of the filter or -1 if the expression is invalid, in which case FilterFailed is sent.
+	 */
+	Q_INVOKABLE int AddFilter(const QString &expression);
+
+	/**
+	 * Unregisters a content filter.
+	 * @param[in] filterId
+	 *   The ID of the filter returned by AddFilter.
+	 */
+	Q_INVOKABLE void RemoveFilter(int filterId);
+
 public slots:
 
 	/**
@@ -244,6 +444,14 @@ public slots:
 	 */
 	void SendAction(Action action, const QString &args=QString(), bool retainFocus=true);
 
+	/**
+	 * Saves a snapshot of all loaded messages.
+	 * The snapshot records how far into Client.txt the messages were read so that the next start only needs
+	 * to parse what was written to the log after the snapshot was taken. The snapshot is written on a worker
+	 * thread, so this returns right away; nothing is done while the previous snapshot is still being written.
+	 */
+	void SaveSnapshot();
+
 signals:
 
 	/**
@@ -253,17 +461,44 @@ signals:
 
 	/**
 	 * Signal sent when a new message is received.
+	 * Every connection gets every message, so this is meant for scripts. Widgets subscribe to the kinds of
+	 * messages they want through the message bus instead.
 	 * @param[in] message
 	 *   The new message.
 	 */
 	void NewMessage(PMessage *message);
 
+	/**
+	 * Signal sent once for each batch of messages that is added, after NewMessage has been sent for each of
+	 * them.
+	 * @param[in] first
+	 *   The index of the first message that was added.
+	 * @param[in] last
+	 *   The index of the last message that was added.
+	 */
+	void MessagesAppended(int first, int last);
+
+	/**
+	 * Signal sent when messages are merged in among the loaded messages. The indexes of the messages, including
+	 * the channel and subtype indexes, have changed.
+	 */
+	void MessagesReset();
+
+	/**
+	 * Signal sent when a content filter could not be registered.
+	 * @param[in] expression
+	 *   The filter expression.
+	 * @param[in] error
+	 *   A description of why the expression is invalid.
+	 */
+	void FilterFailed(const QString &expression, const QString &error);
+
 private slots:
 
 	/**
-	 * Slot called when the Client.txt file changes.
+	 * Slot called to take the messages the reader thread has parsed and add them to the list.
 	 */
-	void OnFileChanged();
+	void DrainMessages();
 
 	/**
 	 * Slot called when the log directory changes.
@@ -277,11 +512,93 @@ private:
 	 */
 	QQmlListProperty<PMessage> GetLogMessagesProperty() const;
 
+	/**
+	 * Adds a message to the list of messages and the channel and subtype indexes.
+	 * @param[in] message
+	 *   The message to add.
+	 */
+	void AppendMessage(PMessage *message);
+
+	/**
+	 * Adds a message to the end of the list of messages and to the channel and subtype indexes, without testing
+	 * filters or sending it out.
+	 * @param[in] message
+	 *   The message to add.
+	 */
+	void IndexMessage(PMessage *message);
+
+	/**
+	 * Merges messages into the list of messages in time order. Messages with the same time as a loaded message
+	 * go after it.
+	 * @param[in] messages
+	 *   The messages to merge. Their filter results must already be set.
+	 */
+	void MergeMessages(QVector<PMessage *> messages);
+
+	/**
+	 * Tests a message against the registered content filters and stores the results on the message.
+	 * Each distinct keyword is only searched for once, no matter how many filters use it.
+	 * @param[in] message
+	 *   The message to test.
+	 * @param[in] filterIds
+	 *   The IDs of the filters to test.
+	 */
+	void EvaluateFilters(PMessage *message, const QList<int> &filterIds) const;
+
+	/**
+	 * Rebuilds the keyword matcher from the keywords of the registered filters.
+	 */
+	void UpdateKeywordMatcher();
+
+	/**
+	 * Loads the messages from the snapshot, if there is a snapshot that matches the current log file.
+	 * @return
+	 *   true if the snapshot was loaded, false otherwise.
+	 */
+	bool LoadSnapshot();
+
+	/**
+	 * Waits for the snapshot that is being written, if there is one, to be finished.
+	 */
+	void WaitForSnapshot();
+
+	/**
+	 * Retrieves the path of the message snapshot file.
+	 * @return
+	 *   The path of the message snapshot file.
+	 */
+	QString GetSnapshotPath() const;
+
+	/**
+	 * Computes a hash of the log file contents immediately preceding a position.
+	 * This is used to check that the log file still contains the text a snapshot was taken from.
+	 * @param[in] offset
+	 *   The position in the log file.
+	 * @return
+	 *   The hash or an empty array if the log file is shorter than the offset.
+	 */
+	QByteArray HashLogTail(qint64 offset) const;
+
 	/**
 	 * The file system watcher that looks at the Client.txt
 	 */
 	QFileSystemWatcher *_Watcher = nullptr;
 
+	/**
+	 * The bus that delivers new messages.
+	 */
+	PMessageBus *_Bus = nullptr;
+
+	/**
+	 * The queue that chat messages and commands are sent to the game through.
+	 */
+	PCommandQueue *_CommandQueue = nullptr;
+
+	/**
+	 * The tracker that measures how long commands take to show up in the log.
+	 */
+	PCommandTracker *_Tracker = nullptr;
+
 	/**
 	 * The path to the log directory.
 	 */
@@ -293,25 +610,70 @@ private:
 	QString _LogFilePath;
 
 	/**
-	 * The file open on the Client.txt file.
+	 * The thread reading and parsing the Client.txt file.
 	 */
-	QFile *_File = nullptr;
+	QThread *_ReaderThread = nullptr;
 
 	/**
-	 * The timer looking at the file.
+	 * The ring buffer the reader thread hands parsed messages over in.
 	 */
-	QTimer _Timer;
+	PLogReader::Ring _Ring;
 
 	/**
-	 * The remainder of the file.
+	 * The position in the log file just past the last message that was added.
 	 */
-	QByteArray _Remainder;
+	qint64 _ReadOffset = 0;
+
+	/**
+	 * The timer draining the messages parsed by the reader thread.
+	 */
+	QTimer _Timer;
 
 	/**
 	 * The list of log messages.
 	 */
 	QList<PMessage *> _Messages;
 
+	/**
+	 * The registered content filters, indexed by their ID.
+	 */
+	QHash<int, PMessageFilter> _Filters;
+
+	/**
+	 * The keywords used by the registered content filters, with the number of filters using each.
+	 */
+	QHash<QString, int> _FilterKeywords;
+
+	/**
+	 * Finds the keywords of all registered content filters in a message at once.
+	 */
+	PKeywordMatcher _KeywordMatcher;
+
+	/**
+	 * The indexes in the keyword matcher of the keywords of each content filter, indexed by filter ID.
+	 */
+	QHash<int, QVector<int>> _FilterKeywordIndexes;
+
+	/**
+	 * The indexes of the messages on each channel.
+	 */
+	QHash<PMessage::Channel, QVector<int>> _ChannelIndexes;
+
+	/**
+	 * The indexes of the messages of each subtype.
+	 */
+	QHash<PMessage::Subtype, QVector<int>> _SubtypeIndexes;
+
+	/**
+	 * The indexes of the messages of each whisper conversation, indexed by the player being whispered.
+	 */
+	QHash<QString, QVector<int>> _WhisperIndexes;
+
+	/**
+	 * The last player whispered to or by, who notices about undelivered whispers belong to.
+	 */
+	QString _LastWhisperPartner;
+
 	/**
 	 * Indicates whether the log scanner has been initialized.
 	 */
@@ -321,4 +683,20 @@ private:
 	 * The position of the first message loaded.
 	 */
 	qint64 _FirstMessagePos = -1;
+
+	/**
+	 * The position in the log file where reading resumes after a snapshot was loaded.
+	 * This is -1 if no snapshot was loaded.
+	 */
+	qint64 _SnapshotOffset = -1;
+
+	/**
+	 * The timer that periodically saves a snapshot of the messages.
+	 */
+	QTimer _SnapshotTimer;
+
+	/**
+	 * The thread writing a snapshot, while one is being written.
+	 */
+	QPointer<QThread> _SnapshotThread;
 };
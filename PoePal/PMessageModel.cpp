@@ -15,16 +15,36 @@
  */
 #include "PMessageModel.h"
 #include "PApplication.h"
+#include "PMessage.h"
 #include "PMessageHandler.h"
 
+namespace
+{
+	/**
+	 * Retrieves the message handler of the application.
+	 * @return
+	 *   The message handler.
+	 */
+	PMessageHandler * GetApplicationHandler()
+	{
+		auto app = qobject_cast<PApplication *>(qApp);
+		Q_ASSERT(app);
+		return app->GetMessageHandler();
+	}
+}
+
 PMessageModel::PMessageModel(QObject *parent)
-	: QAbstractItemModel(parent)
+	: PMessageModel(GetApplicationHandler(), parent)
+{
+}
+
+PMessageModel::PMessageModel(PMessageHandler *handler, QObject *parent)
+	: QAbstractItemModel(parent), _Handler(handler)
 {
-	auto app = qobject_cast<PApplication *>(qApp);
-	Q_ASSERT(app);
-	auto scanner = app->GetMessageHandler();
-	Q_ASSERT(scanner);
-	connect(scanner, &PMessageHandler::NewMessage, this, &PMessageModel::OnNewMessage);
+	Q_ASSERT(_Handler);
+	_RowCount = _Handler->GetMessageCount();
+	connect(_Handler, &PMessageHandler::MessagesAppended, this, &PMessageModel::OnMessagesAppended);
+	connect(_Handler, &PMessageHandler::MessagesReset, this, &PMessageModel::OnMessagesReset);
 }
 
 PMessageModel::~PMessageModel()
@@ -33,13 +53,8 @@ PMessageModel::~PMessageModel()
 
 QModelIndex PMessageModel::index(int row, int column, const QModelIndex &parent /*= QModelIndex()*/) const
 {
-	auto app = qobject_cast<PApplication *>(qApp);
-	Q_ASSERT(app);
-	auto scanner = app->GetMessageHandler();
-	Q_ASSERT(scanner);
-	auto messages = scanner->GetLogMessages();
-	if (row >= 0 && row < messages.length()) return createIndex(row, column, messages.at(row));
-	return QModelIndex();
+	if (parent.isValid() || row < 0 || row >= _RowCount || column < 0 || column >= ColumnCount) return QModelIndex();
+	return createIndex(row, column, _Handler->GetMessageAt(row));
 }
 
 QModelIndex PMessageModel::parent(const QModelIndex &child) const
@@ -50,24 +65,105 @@ QModelIndex PMessageModel::parent(const QModelIndex &child) const
 
 int PMessageModel::rowCount(const QModelIndex &parent /*= QModelIndex()*/) const
 {
-	auto app = qobject_cast<PApplication *>(qApp);
-	Q_ASSERT(app);
-	auto scanner = app->GetMessageHandler();
-	Q_ASSERT(scanner);
-	return scanner->GetLogMessages().length();
+	if (parent.isValid()) return 0;
+	return _RowCount;
 }
 
 int PMessageModel::columnCount(const QModelIndex &parent /*= QModelIndex()*/) const
 {
-	return 1;
+	if (parent.isValid()) return 0;
+	return ColumnCount;
 }
 
 QVariant PMessageModel::data(const QModelIndex &index, int role /*= Qt::DisplayRole*/) const
 {
-	if (!index.isValid() || role != Qt::DisplayRole) return QVariant();
 	auto msg = GetLogMessage(index);
-	if (role == Qt::DisplayRole) return msg->ToString();
-	return QVariant();
+	if (!msg) return QVariant();
+	switch (role)
+	{
+	case Qt::DisplayRole:
+		switch (index.column())
+		{
+		case TimeColumn:
+			return msg->GetTime().toString(QStringLiteral("yyyy/MM/dd HH:mm:ss"));
+		case TypeColumn:
+			return PMessage::GetStringFromType(msg->GetType());
+		case ChannelColumn:
+			if (msg->GetChannel() == PMessage::InvalidChannel) return QString();
+			return PMessage::GetChannelLabel(msg->GetChannel());
+		case SenderColumn:
+			return msg->GetFullSender();
+		default:
+			return msg->GetContents();
+		}
+	case Qt::ToolTipRole:
+		return msg->ToString();
+	case TimeRole:
+		return msg->GetTime();
+	case TypeRole:
+		return QVariant::fromValue(msg->GetType());
+	case SubtypeRole:
+		return QVariant::fromValue(msg->GetSubtype());
+	case ChannelRole:
+		return QVariant::fromValue(msg->GetChannel());
+	case SenderRole:
+		return msg->GetSubject();
+	case SenderGuildRole:
+		return msg->GetSubjectGuild();
+	case BodyRole:
+		return msg->GetContents();
+	case TradeItemRole:
+		return msg->IsTradeRequest() ? QVariant(msg->GetTradeItem()) : QVariant();
+	case TradeAmountRole:
+		return msg->IsTradeRequest() ? QVariant(msg->GetTradeAmount()) : QVariant();
+	case TradeCurrencyRole:
+		return msg->IsTradeRequest() ? QVariant(msg->GetTradeCurrency()) : QVariant();
+	case TradeLeagueRole:
+		return msg->IsTradeRequest() ? QVariant(msg->GetTradeLeague()) : QVariant();
+	case MessageRole:
+		return QVariant::fromValue(msg);
+	default:
+		return QVariant();
+	}
+}
+
+QVariant PMessageModel::headerData(int section, Qt::Orientation orientation, 
+	int role /*= Qt::DisplayRole*/) const
+{
+	if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+	switch (section)
+	{
+	case TimeColumn:
+		return tr("Time");
+	case TypeColumn:
+		return tr("Level");
+	case ChannelColumn:
+		return tr("Channel");
+	case SenderColumn:
+		return tr("Sender");
+	case BodyColumn:
+		return tr("Message");
+	default:
+		return QVariant();
+	}
+}
+
+QHash<int, QByteArray> PMessageModel::roleNames() const
+{
+	auto names = QAbstractItemModel::roleNames();
+	names.insert(TimeRole, "time");
+	names.insert(TypeRole, "type");
+	names.insert(SubtypeRole, "subtype");
+	names.insert(ChannelRole, "channel");
+	names.insert(SenderRole, "sender");
+	names.insert(SenderGuildRole, "senderGuild");
+	names.insert(BodyRole, "body");
+	names.insert(TradeItemRole, "tradeItem");
+	names.insert(TradeAmountRole, "tradeAmount");
+	names.insert(TradeCurrencyRole, "tradeCurrency");
+	names.insert(TradeLeagueRole, "tradeLeague");
+	names.insert(MessageRole, "message");
+	return names;
 }
 
 PMessage * PMessageModel::GetLogMessage(const QModelIndex &index) const
@@ -76,13 +172,23 @@ PMessage * PMessageModel::GetLogMessage(const QModelIndex &index) const
 	return static_cast<PMessage *>(index.internalPointer());
 }
 
-void PMessageModel::OnNewMessage(PMessage *msg)
+PMessageHandler * PMessageModel::GetHandler() const
 {
-	auto app = qobject_cast<PApplication *>(qApp);
-	Q_ASSERT(app);
-	auto scanner = app->GetMessageHandler();
-	Q_ASSERT(scanner);
-	auto messages = scanner->GetLogMessages();
-	beginInsertRows(QModelIndex(), messages.length() - 1, messages.length() - 1);
+	return _Handler;
+}
+
+void PMessageModel::OnMessagesAppended(int first, int last)
+{
+	// The whole batch is inserted at once so views only lay out the new rows a single time.
+	if (last < _RowCount) return;
+	beginInsertRows(QModelIndex(), _RowCount, last);
+	_RowCount = last + 1;
 	endInsertRows();
 }
+
+void PMessageModel::OnMessagesReset()
+{
+	beginResetModel();
+	_RowCount = _Handler->GetMessageCount();
+	endResetModel();
+}
@@ -18,6 +18,7 @@
 #include <QAbstractItemModel>
 
 class PMessage;
+class PMessageHandler;
 
 /**
  * An item model that contains all of the log messages that have been parsed by PoePal.
@@ -31,12 +32,93 @@ class PMessageModel : public QAbstractItemModel
 public:
 
 	/**
-	 * Creates a new instance of this model.
+	 * The roles for the data of the messages in the model.
+	 * These give views and proxy models the parsed parts of a message without having to parse its text.
+	 * @param TimeRole
+	 *   The time of the message as a QDateTime.
+	 * @param TypeRole
+	 *   The PMessage::Type of the message.
+	 * @param SubtypeRole
+	 *   The PMessage::Subtype of the message.
+	 * @param ChannelRole
+	 *   The PMessage::Channel the message was sent on.
+	 * @param SenderRole
+	 *   The name of the sender of a chat message.
+	 * @param SenderGuildRole
+	 *   The guild of the sender of a chat message.
+	 * @param BodyRole
+	 *   The contents of the message, without the sender.
+	 * @param TradeItemRole
+	 *   The item requested in a trade message.
+	 * @param TradeAmountRole
+	 *   The amount of currency offered in a trade message.
+	 * @param TradeCurrencyRole
+	 *   The currency offered in a trade message.
+	 * @param TradeLeagueRole
+	 *   The league of a trade message.
+	 * @param MessageRole
+	 *   The PMessage itself.
+	 */
+	enum Role
+	{
+		TimeRole = Qt::UserRole + 1,
+		TypeRole,
+		SubtypeRole,
+		ChannelRole,
+		SenderRole,
+		SenderGuildRole,
+		BodyRole,
+		TradeItemRole,
+		TradeAmountRole,
+		TradeCurrencyRole,
+		TradeLeagueRole,
+		MessageRole
+	};
+	Q_ENUM(Role)
+
+	/**
+	 * The columns of the model.
+	 * Each column shows one part of a message as its display text; the roles are the same in every column.
+	 * @param TimeColumn
+	 *   The time the message was logged.
+	 * @param TypeColumn
+	 *   The level of the message.
+	 * @param ChannelColumn
+	 *   The channel a chat message was sent on.
+	 * @param SenderColumn
+	 *   The sender of a chat message, with their guild.
+	 * @param BodyColumn
+	 *   The contents of the message.
+	 * @param ColumnCount
+	 *   The number of columns.
+	 */
+	enum Column
+	{
+		TimeColumn,
+		TypeColumn,
+		ChannelColumn,
+		SenderColumn,
+		BodyColumn,
+		ColumnCount
+	};
+	Q_ENUM(Column)
+
+	/**
+	 * Creates a new instance of this model on the messages of the application's message handler.
 	 * @param[in] parent
 	 *   The parent of the model.
 	 */
 	PMessageModel(QObject *parent);
 
+	/**
+	 * Creates a new instance of this model on the messages of a message handler.
+	 * @param[in] handler
+	 *   The message handler holding the messages.
+	 * @param[in] parent
+	 *   The parent of the model.
+	 */
+	PMessageModel(PMessageHandler *handler, QObject *parent);
+
 	/**
 	 * Destructor.
 	 */
@@ -67,6 +149,16 @@ public:
 	 */
 	virtual QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
 
+	/**
+	 * Overrides QAbstractItemModel#headerData
+	 */
+	virtual QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+	/**
+	 * Overrides QAbstractItemModel#roleNames
+	 */
+	virtual QHash<int, QByteArray> roleNames() const override;
+
 	/**
 	 * Retrieves the message from an index.
 	 * @param[in] index
@@ -76,12 +168,39 @@ public:
 	 */
 	PMessage * GetLogMessage(const QModelIndex &index) const;
 
+	/**
+	 * Retrieves the message handler holding the messages of the model.
+	 * @return
+	 *   The message handler.
+	 */
+	PMessageHandler * GetHandler() const;
+
 private slots:
 
 	/**
-	 * Slot called when a new message is read by the log scanner.
-	 * @param[in] msg
-	 *   The new message.
+	 * Slot called when a batch of messages is added by the message handler.
+	 * @param[in] first
+	 *   The index of the first message that was added.
+	 * @param[in] last
+	 *   The index of the last message that was added.
+	 */
+	void OnMessagesAppended(int first, int last);
+
+	/**
+	 * Slot called when the message handler merges messages in among the loaded ones.
+	 */
+	void OnMessagesReset();
+
+private:
+
+	/**
+	 * The message handler holding the messages.
+	 */
+	PMessageHandler *_Handler = nullptr;
+
+	/**
+	 * The number of rows in the model.
+	 * This is tracked separately from the number of messages so the rows only change when the model says so.
 	 */
-	void OnNewMessage(PMessage *msg);
+	int _RowCount = 0;
 };
@@ -0,0 +1,79 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PMockInputInjector.h"
+
+PMockInputInjector::PMockInputInjector()
+{
+	_Clock.start();
+}
+
+PMockInputInjector::~PMockInputInjector()
+{
+}
+
+bool PMockInputInjector::SendChatLine(const QString &text)
+{
+	if (!_GameAvailable) return false;
+	_Lines.append(text);
+	_SendTimes.append(_Clock.elapsed());
+	_KeyStrokes += GetChatScript();
+	return true;
+}
+
+void PMockInputInjector::EndBurst(bool restoreFocus)
+{
+	++_Bursts;
+	if (restoreFocus) ++_FocusRestores;
+}
+
+void PMockInputInjector::SetGameAvailable(bool available)
+{
+	_GameAvailable = available;
+}
+
+QStringList PMockInputInjector::GetLines() const
+{
+	return _Lines;
+}
+
+QVector<qint64> PMockInputInjector::GetSendTimes() const
+{
+	return _SendTimes;
+}
+
+PInputInjector::Script PMockInputInjector::GetKeyStrokes() const
+{
+	return _KeyStrokes;
+}
+
+int PMockInputInjector::GetBurstCount() const
+{
+	return _Bursts;
+}
+
+int PMockInputInjector::GetFocusRestoreCount() const
+{
+	return _FocusRestores;
+}
+
+void PMockInputInjector::Clear()
+{
+	_Lines.clear();
+	_SendTimes.clear();
+	_KeyStrokes.clear();
+	_Bursts = 0;
+	_FocusRestores = 0;
+}
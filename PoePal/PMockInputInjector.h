@@ -0,0 +1,140 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "PInputInjector.h"
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * Records the chat lines and keystrokes that would have been sent to the game, so command scripts and the command
+ * queue can be exercised and timed without the game or a Windows desktop.
+ */
+class PMockInputInjector : public PInputInjector
+{
+public:
+
+	/**
+	 * Creates a new injector.
+	 */
+	PMockInputInjector();
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~PMockInputInjector();
+
+	/**
+	 * Records a line as sent.
+	 * @param[in] text
+	 *   The complete line, including any channel prefix.
+	 * @return
+	 *   true if the simulated game is available, false otherwise.
+	 */
+	virtual bool SendChatLine(const QString &text) override;
+
+	/**
+	 * Records the end of a burst.
+	 * @param[in] restoreFocus
+	 *   true if focus would be given back, false otherwise.
+	 */
+	virtual void EndBurst(bool restoreFocus) override;
+
+	/**
+	 * Sets whether the simulated game is available. Lines sent while it isn't fail.
+	 * @param[in] available
+	 *   true if the game is available, false otherwise.
+	 */
+	void SetGameAvailable(bool available);
+
+	/**
+	 * Retrieves the lines that were sent.
+	 * @return
+	 *   The lines, oldest first.
+	 */
+	QStringList GetLines() const;
+
+	/**
+	 * Retrieves when each line was sent.
+	 * @return
+	 *   The time of each line in milliseconds since the injector was created, matching the lines.
+	 */
+	QVector<qint64> GetSendTimes() const;
+
+	/**
+	 * Retrieves the keystrokes that were played, in the order they would have reached the game.
+	 * @return
+	 *   The keystrokes.
+	 */
+	Script GetKeyStrokes() const;
+
+	/**
+	 * Retrieves the number of bursts that were ended.
+	 * @return
+	 *   The number of bursts.
+	 */
+	int GetBurstCount() const;
+
+	/**
+	 * Retrieves the number of times focus was given back.
+	 * @return
+	 *   The number of focus restores.
+	 */
+	int GetFocusRestoreCount() const;
+
+	/**
+	 * Forgets everything that was recorded.
+	 */
+	void Clear();
+
+private:
+
+	/**
+	 * Indicates whether the simulated game is available.
+	 */
+	bool _GameAvailable = true;
+
+	/**
+	 * The lines that were sent.
+	 */
+	QStringList _Lines;
+
+	/**
+	 * When each line was sent.
+	 */
+	QVector<qint64> _SendTimes;
+
+	/**
+	 * The keystrokes that were played.
+	 */
+	Script _KeyStrokes;
+
+	/**
+	 * The number of bursts that were ended.
+	 */
+	int _Bursts = 0;
+
+	/**
+	 * The number of focus restores.
+	 */
+	int _FocusRestores = 0;
+
+	/**
+	 * The clock the send times are measured with.
+	 */
+	QElapsedTimer _Clock;
+};
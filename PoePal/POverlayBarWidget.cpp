@@ -17,22 +17,23 @@
 #include "PApplication.h"
 #include "PMessageHandler.h"
 #include "POverlayController.h"
+#include <QLabel>
 #include <QPropertyAnimation>
 #include <QSettings>
 #include "windows.h"
 
-POverlayBarWidget::POverlayBarWidget(QWidget* parent /*= nullptr*/):
+POverlayBarWidget::POverlayBarWidget(POverlayController* controller, QWidget* parent /*= nullptr*/):
 	QWidget(parent)
 {
 	setupUi(this);
+	Q_ASSERT(controller);
 
-	// Get the style sheet and apply it here.
-	auto app = qobject_cast<PApplication*>(qApp);
-	auto controller = app->GetOverlayController();
-	setStyleSheet(controller->GetStyleSheet());
+	// The style comes from the overlay controller's style host, which is the parent of this widget.
 
 	setWindowFlags(Qt::Tool | Qt::WindowStaysOnTopHint);
 	setWindowFlags(windowFlags() & ~Qt::WindowCloseButtonHint);
+	// Growing the bar then only paints the newly exposed strip.
+	setAttribute(Qt::WA_StaticContents);
 
 	// Build the config menu.
 	QIcon lockIcon;
@@ -44,6 +45,9 @@ POverlayBarWidget::POverlayBarWidget(QWidget* parent /*= nullptr*/):
 		QIcon::Normal, QIcon::Off);
 	_UnlockAction = _ConfigMenu.addAction(unlockIcon, tr("Unlock"));
 	_UnlockAction->setVisible(false);
+	_ClickThroughAction = _ConfigMenu.addAction(tr("Click Through Chat When Locked"));
+	_ClickThroughAction->setCheckable(true);
+	_ClickThroughAction->setChecked(controller->IsClickThrough());
 	QIcon exitIcon;
 	exitIcon.addFile(QString::fromUtf8(":/PoePal/Resources/32x32/cross.png"), QSize(),
 		QIcon::Normal, QIcon::Off);
@@ -52,6 +56,8 @@ POverlayBarWidget::POverlayBarWidget(QWidget* parent /*= nullptr*/):
 	connect(_LockAction, &QAction::triggered, controller, &POverlayController::Lock);
 	connect(_UnlockAction, &QAction::triggered, controller, &POverlayController::Unlock);
 	connect(_ExitAction, &QAction::triggered, qApp, &QCoreApplication::quit);
+	connect(_ClickThroughAction, &QAction::toggled, controller, &POverlayController::SetClickThrough);
+	connect(controller, &POverlayController::ClickThroughChanged, _ClickThroughAction, &QAction::setChecked);
 	connect(controller, &POverlayController::LockStateChanged, _LockAction, 
 		[this](POverlayController::LockState state) {
 			_LockAction->setVisible(state == POverlayController::OverlayUnlocked || 
@@ -76,6 +82,10 @@ POverlayBarWidget::POverlayBarWidget(QWidget* parent /*= nullptr*/):
 
 	_CollapseAnimation = new QPropertyAnimation(this, "size");
 	_CollapseAnimation->setDuration(100);
+	connect(_CollapseAnimation, &QPropertyAnimation::finished, this, 
+		&POverlayBarWidget::OnCollapseAnimationFinished);
+	_CollapseSnapshot = new QLabel(this);
+	_CollapseSnapshot->hide();
 
 	// Restore the bar widget settings.
 	QSettings settings;
@@ -99,23 +109,31 @@ POverlayBarWidget::~POverlayBarWidget()
 	settings.endGroup(); // Overlay
 }
 
+void POverlayBarWidget::changeEvent(QEvent* evt)
+{
+	// Anything that changes how the buttons look makes the cached rendering stale.
+	switch (evt->type())
+	{
+	case QEvent::StyleChange:
+	case QEvent::PaletteChange:
+	case QEvent::FontChange:
+	case QEvent::LanguageChange:
+		_CollapsePixmap = QPixmap();
+		break;
+	default:
+		break;
+	}
+	QWidget::changeEvent(evt);
+}
+
 void POverlayBarWidget::enterEvent(QEvent* evt)
 {
-	auto collapseSize = _CollapseArea->sizeHint();
-	auto fullSize = sizeHint();
-	fullSize.setWidth(fullSize.width() + collapseSize.width());
-	_CollapseAnimation->setStartValue(size());
-	_CollapseAnimation->setEndValue(fullSize);
-	_CollapseAnimation->start();
+	AnimateCollapse(true);
 }
 
 void POverlayBarWidget::leaveEvent(QEvent* evt)
 {
-	auto collapseSize = _CollapseArea->sizeHint();
-	auto fullSize = sizeHint();
-	_CollapseAnimation->setStartValue(size());
-	_CollapseAnimation->setEndValue(fullSize);
-	_CollapseAnimation->start();
+	AnimateCollapse(false);
 }
 
 void POverlayBarWidget::OnButtonClicked()
@@ -132,3 +150,40 @@ void POverlayBarWidget::OnButtonClicked()
 	else if (button == _DelveBtn) handler->SendAction(PMessageHandler::Delve, QString(), false);
 	else if (button == _OptionsBtn) _ConfigMenu.popup(QCursor::pos());
 }
+
+void POverlayBarWidget::OnCollapseAnimationFinished()
+{
+	// Put the real buttons back and lay the bar out once for its final size.
+	_CollapseArea->show();
+	_CollapseSnapshot->hide();
+	layout()->setEnabled(true);
+	layout()->activate();
+}
+
+void POverlayBarWidget::AnimateCollapse(bool expand)
+{
+	if (_CollapseAnimation->state() == QAbstractAnimation::Running) _CollapseAnimation->stop();
+	else
+	{
+		// The sizes are taken while the real buttons are still part of the layout.
+		_CollapsedSize = sizeHint();
+		_ExpandedSize = _CollapsedSize;
+		_ExpandedSize.setWidth(_ExpandedSize.width() + _CollapseArea->sizeHint().width());
+		// Lay the bar out at its expanded size once and freeze it there, so the animation steps only clip it.
+		layout()->setGeometry(QRect(QPoint(0, 0), _ExpandedSize));
+		layout()->setEnabled(false);
+		if (_CollapsePixmap.isNull() || _CollapsePixmap.devicePixelRatioF() != devicePixelRatioF())
+		{
+			_CollapseArea->widget()->layout()->activate();
+			_CollapsePixmap = _CollapseArea->grab();
+		}
+		_CollapseSnapshot->setGeometry(_CollapseArea->geometry());
+		_CollapseSnapshot->setPixmap(_CollapsePixmap);
+		_CollapseSnapshot->show();
+		_CollapseSnapshot->raise();
+		_CollapseArea->hide();
+	}
+	_CollapseAnimation->setStartValue(size());
+	_CollapseAnimation->setEndValue(expand ? _ExpandedSize : _CollapsedSize);
+	_CollapseAnimation->start();
+}
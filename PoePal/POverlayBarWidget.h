@@ -16,17 +16,23 @@
 #pragma once
 
 #include <QMenu>
+#include <QPixmap>
 #include <QPointer>
 #include <QTimer>
 #include <QWidget>
 #include "ui_POverlayBarWidget.h"
 
 class POverlayChatWidget;
+class POverlayController;
 class POverlayTradeWidget;
+class QLabel;
 class QPropertyAnimation;
 
 /**
  * Class provides a bar UI that overlays the game and serves as the main UI for the user in-game.
+ * The bar expands when hovered. While it animates, its layout is frozen at the expanded size so each step only
+ * clips the window, and the collapsible buttons are shown as a cached pixmap instead of being restyled and
+ * repainted for every step.
  */
 class POverlayBarWidget : public QWidget, public Ui::POverlayBarWidget
 {
@@ -36,10 +42,12 @@ public:
 
 	/**
 	 * Creates a new instance of this widget.
+	 * @param[in] controller
+	 *   The overlay controller that the bar locks, unlocks and configures.
 	 * @param[in] parent
 	 *   The parent of this widget.
 	 */
-	POverlayBarWidget(QWidget* parent = nullptr);
+	POverlayBarWidget(POverlayController* controller, QWidget* parent = nullptr);
 
 	/**
 	 * Destructor.
@@ -48,6 +56,11 @@ public:
 
 protected:
 
+	/**
+	 * Overrides QWidget#changeEvent.
+	 */
+	virtual void changeEvent(QEvent* evt) override;
+
 	/**
 	 * Overrides QWidget#enterEvent.
 	 */
@@ -65,13 +78,45 @@ private slots:
 	 */
 	void OnButtonClicked();
 
+	/**
+	 * Slot called when the collapse animation finishes.
+	 */
+	void OnCollapseAnimationFinished();
+
 private:
 
+	/**
+	 * Animates the bar to its expanded or collapsed size.
+	 * @param[in] expand
+	 *   true to expand the bar, false to collapse it.
+	 */
+	void AnimateCollapse(bool expand);
+
 	/**
 	 * The animation for the collapsible frame width.
 	 */
 	QPointer<QPropertyAnimation> _CollapseAnimation;
 
+	/**
+	 * The label standing in for the collapsible frame while it animates.
+	 */
+	QPointer<QLabel> _CollapseSnapshot;
+
+	/**
+	 * The cached rendering of the expanded collapsible frame, or null if it needs to be rendered again.
+	 */
+	QPixmap _CollapsePixmap;
+
+	/**
+	 * The size of the bar when it is collapsed, taken when the animation started.
+	 */
+	QSize _CollapsedSize;
+
+	/**
+	 * The size of the bar when it is expanded, taken when the animation started.
+	 */
+	QSize _ExpandedSize;
+
 	/**
 	 * The configuration menu.
 	 */
@@ -87,6 +132,11 @@ private:
 	 */
 	QPointer<QAction> _UnlockAction;
 
+	/**
+	 * The action that lets clicks go through the chat widget while the overlay is locked.
+	 */
+	QPointer<QAction> _ClickThroughAction;
+
 	/**
 	 * The action that handles closing the application.
 	 */
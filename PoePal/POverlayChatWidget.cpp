@@ -19,7 +19,7 @@
 #include "POverlayController.h"
 #include <QDebug>
 #include <QLabel>
-#include <QListWidget>
+#include <QListView>
 #include <QSettings>
 #include <QScrollBar>
 #include <QTimer>
@@ -30,16 +30,10 @@ PChatWidget(PMessage::Whisper, parent)
 	setWindowFlags(Qt::Tool | Qt::WindowStaysOnTopHint);
 
 	setWindowFlags(windowFlags() & ~Qt::WindowCloseButtonHint);
-	auto app = qobject_cast<PApplication*>(qApp);
-	auto controller = app->GetOverlayController();
 
-	// Fix the tab bar widget border on the right.
-	auto tabBar = _WhisperTabs->tabBar();
-	tabBar->setStyleSheet(controller->GetStyleSheet());
-	tabBar->GetListWidget()->verticalScrollBar()->setStyleSheet(controller->GetStyleSheet());
-
-	// Get the style sheet and apply it here.
-	setStyleSheet(controller->GetStyleSheet());
+	// The style comes from the overlay controller's style host, which is the parent of this widget. The tab bar
+	// brings its own style sheet for the main window, which would override the overlay rules, so drop it.
+	_WhisperTabs->tabBar()->setStyleSheet(QString());
 
 	// Restore the chat widget settings.
 	QSettings settings;
@@ -14,12 +14,15 @@
  * <https://www.gnu.org/licenses/>.
  */
 #include "POverlayController.h"
+#include "PFocusSource.h"
 #include "POverlayBarWidget.h"
 #include "POverlayChatWidget.h"
+#include "POverlayLayout.h"
+#include "PWin32FocusSource.h"
 #include <QDebug>
-#include <QScreen>
+#include <QElapsedTimer>
 #include <QSettings>
-#include "windows.h"
+#include <QWindow>
 
 POverlayController::POverlayController(QObject* parent):
 QObject(parent)
@@ -29,18 +32,23 @@ QObject(parent)
 
 POverlayController::~POverlayController()
 {
-	if (_BarWidget) _BarWidget->deleteLater();
-	if (_ChatWidget) _ChatWidget->deleteLater();
+	// Positions are otherwise only stored when the overlay is locked, so keep any unlocked arrangement.
+	if (_Layout && _LockState != OverlayLocked) StorePositions();
+	// The overlay widgets are owned by the style host.
+	if (_StyleHost) _StyleHost->deleteLater();
 	QSettings settings;
 	settings.beginGroup(QStringLiteral("Overlay"));
 	settings.setValue(QStringLiteral("Locked"), 
 		_LockState == OverlayLocked || _LockState == OverlayLockPending);
 	settings.setValue(QStringLiteral("ChatVisible"), _ChatVisible);
+	settings.setValue(QStringLiteral("ClickThrough"), _ClickThrough);
 	settings.endGroup(); // Overlay
 }
 
 void POverlayController::Initialize()
 {
+	QElapsedTimer timer;
+	timer.start();
 	// Load the style sheet so we can apply it to the new widgets.
 	QFile styleFile(":/PoePal/Resources/OverlayStylesheet.qss");
 	if (!styleFile.open(QIODevice::ReadOnly))
@@ -48,26 +56,59 @@ void POverlayController::Initialize()
 		qFatal("Could not load overlay stylesheet.");
 	}
 	_OverlayStyle = QString::fromLatin1(styleFile.readAll());
+	// The overlay windows are children of a hidden host holding the style sheet, so it is parsed once and every
+	// overlay window shares the same style rather than each parsing its own copy.
+	_StyleHost = new QWidget();
+	_StyleHost->setStyleSheet(_OverlayStyle);
+
+	// The bar widget shows the click-through setting, so it has to be known before the widgets are created.
+	QSettings settings;
+	settings.beginGroup(QStringLiteral("Overlay"));
+	_ClickThrough = settings.value(QStringLiteral("ClickThrough"), false).toBool();
 
 	// Initialize the chat widgets.
-	_BarWidget = new POverlayBarWidget();
+	_BarWidget = new POverlayBarWidget(this, _StyleHost);
 	_BarWidget->hide();
 	InstallArrowFilter(_BarWidget);
-	_ChatWidget = new POverlayChatWidget();
+	_ChatWidget = new POverlayChatWidget(_StyleHost);
 	_ChatWidget->hide();
 	InstallArrowFilter(_ChatWidget);
 
-	// Set up the timer that checks for the game being active.
-	_GameCheckTimer.setInterval(100);
-	_GameCheckTimer.start();
-	connect(&_GameCheckTimer, &QTimer::timeout, this, &POverlayController::OnCheckGameActive);
+	// Put the widgets where they were last locked on this screen configuration, and again whenever it changes.
+	_Layout = new POverlayLayout(this);
+	connect(_Layout, &POverlayLayout::ScreensChanged, this, &POverlayController::OnScreensChanged);
+	PlaceWidget(_BarWidget);
+	PlaceWidget(_ChatWidget);
 
-	// Load the settings.
-	QSettings settings;
-	settings.beginGroup(QStringLiteral("Overlay"));
+	// Follow the foreground window so the overlay is shown and hidden as soon as focus changes.
+	if (!_FocusSource) _FocusSource = new PWin32FocusSource(this);
+	connect(_FocusSource, &PFocusSource::ForegroundChanged, this, &POverlayController::OnForegroundChanged);
+	_FocusSource->Start();
+
+	// Load the rest of the settings.
 	if (settings.value(QStringLiteral("Locked")).toBool()) Lock();
 	SetChatVisibility(settings.value(QStringLiteral("ChatVisible"), false).toBool());
 	settings.endGroup(); // Overlay
+	qDebug() << "Created overlay widgets in" << timer.elapsed() << "ms";
+}
+
+PFocusSource* POverlayController::GetFocusSource() const
+{
+	return _FocusSource;
+}
+
+void POverlayController::SetFocusSource(PFocusSource* source)
+{
+	Q_ASSERT(!_BarWidget);
+	if (source == _FocusSource) return;
+	delete _FocusSource;
+	_FocusSource = source;
+	_FocusSource->setParent(this);
+}
+
+POverlayLayout* POverlayController::GetLayout() const
+{
+	return _Layout;
 }
 
 POverlayBarWidget* POverlayController::GetBarWidget() const
@@ -95,17 +136,30 @@ bool POverlayController::IsGameActive() const
 	return _GameActive;
 }
 
+bool POverlayController::IsClickThrough() const
+{
+	return _ClickThrough;
+}
+
 QString POverlayController::GetStyleSheet() const
 {
 	return _OverlayStyle;
 }
 
+void POverlayController::SetStyleSheet(const QString& styleSheet)
+{
+	if (styleSheet == _OverlayStyle) return;
+	_OverlayStyle = styleSheet;
+	if (_StyleHost) _StyleHost->setStyleSheet(_OverlayStyle);
+}
+
 void POverlayController::Lock()
 {
 	// If the lock state was already set to OverlayLocked or OverlayLockPending, we don't need to do anything.
 	if (_LockState == OverlayLocked || _LockState == OverlayLockPending) return;
 	// Otherwise, setting the state will cause it to be locked the next time the overlay is shown.
-	else SetLockState(OverlayLockPending);
+	SetLockState(OverlayLockPending);
+	ApplyPendingLockState();
 }
 
 void POverlayController::Unlock()
@@ -113,8 +167,9 @@ void POverlayController::Unlock()
 	// If the lock state was already set to OverlayUnlocked or OverlayUnlockPending, we don't need to do 
 	// anything.
 	if (_LockState == OverlayUnlocked || _LockState == OverlayUnlockPending) return;
-	// Otherwise, setting the state will cause it to be locked the next time the overlay is shown.
-	else SetLockState(OverlayUnlockPending);
+	// Otherwise, setting the state will cause it to be unlocked the next time the overlay is shown.
+	SetLockState(OverlayUnlockPending);
+	ApplyPendingLockState();
 }
 
 void POverlayController::SetLocked(bool locked)
@@ -143,55 +198,60 @@ void POverlayController::SetChatVisibility(bool visible)
 	}
 }
 
+void POverlayController::SetClickThrough(bool clickThrough)
+{
+	if (clickThrough == _ClickThrough) return;
+	_ClickThrough = clickThrough;
+	// Unlocked widgets pick the setting up when they are locked.
+	if (_LockState == OverlayLocked && _ChatWidget)
+	{
+		SetNativeWindowFlags(_ChatWidget, GetLockedWindowFlags(_ChatWidget));
+	}
+	emit ClickThroughChanged(clickThrough);
+}
+
 bool POverlayController::eventFilter(QObject* watched, QEvent* event)
 {
 	// Determine which overlay widget is being acted upon.
 	auto rootWidget = FindRootWidget(qobject_cast<QWidget*>(watched));
 	if (!rootWidget || event->type() != QEvent::KeyPress) return false;
 	auto keyPressEvent = static_cast<QKeyEvent*>(event);
-	auto newPos = rootWidget->pos();
-	auto screen = qApp->screenAt(rootWidget->geometry().topLeft());
-	auto screenRect = screen->geometry();
 	auto increment = keyPressEvent->modifiers().testFlag(Qt::ControlModifier) ? 1 : 5;
-	bool arrowKey = true;
+	QPoint delta;
 	switch (keyPressEvent->key())
 	{
 	case Qt::Key_Up:
-		newPos.setY(qMax(newPos.y() - increment, screenRect.top() - rootWidget->geometry().top() +
-			rootWidget->frameGeometry().top()));
+		delta.setY(-increment);
 		break;
 	case Qt::Key_Right:
-		newPos.setX(qMin(newPos.x() + increment, screenRect.right() - rootWidget->geometry().right() + 
-			rootWidget->frameGeometry().left()));
+		delta.setX(increment);
 		break;
 	case Qt::Key_Down:
-		newPos.setY(qMin(newPos.y() + increment, screenRect.bottom() - rootWidget->geometry().bottom() +
-			rootWidget->frameGeometry().top()));
+		delta.setY(increment);
 		break;
 	case Qt::Key_Left:
-		newPos.setX(qMax(newPos.x() - increment, screenRect.left() - rootWidget->geometry().left() +
-			rootWidget->frameGeometry().left()));
+		delta.setX(-increment);
 		break;
 	default:
-		arrowKey = false;
-		break;
-	}
-	if (arrowKey)
-	{
-		rootWidget->move(newPos);
-		return true;
+		return false;
 	}
-	return false;
+	// The layout clamps the move against its cached screen geometry.
+	MoveWidget(rootWidget, _Layout->MoveBy(rootWidget->geometry(), delta));
+	return true;
 
 }
 
-void POverlayController::OnCheckGameActive()
+void POverlayController::OnForegroundChanged(WId window, qint64 processId, bool game)
 {
-	// Update the state of whether or not the game is active.
-	SetGameActive(IsGameOrOverlayActive());
-	// Trigger the timer to apply lock or unlock appearance if they're pending. This can only be done
-	// after windows are shown and the event loop has run to successfully handle position changes due to
-	// hide/show of the title bar of the windows.
+	// The overlay stays up while the game or one of the overlay windows is in the foreground.
+	SetGameActive(game || (processId == QCoreApplication::applicationPid() && IsOverlayWindow(window)));
+	ApplyPendingLockState();
+}
+
+void POverlayController::ApplyPendingLockState()
+{
+	// Trigger the timer to apply lock or unlock appearance if they're pending. This is done after the
+	// windows are shown and the event loop has run, so they have their native windows and final geometry.
 	if (_GameActive)
 	{
 		if (_LockState == OverlayLockPending)
@@ -208,6 +268,8 @@ void POverlayController::OnCheckGameActive()
 void POverlayController::OnApplyLockAppaerance()
 {
 	if (_LockState != OverlayLockPending) return;
+	// Locking commits the arrangement made while the overlay was unlocked.
+	StorePositions();
 	ApplyLockAppearance(_ChatWidget);
 	ApplyLockAppearance(_BarWidget);
 	SetLockState(OverlayLocked);
@@ -221,6 +283,12 @@ void POverlayController::OnApplyUnlockAppearance()
 	SetLockState(OverlayUnlocked);
 }
 
+void POverlayController::OnScreensChanged()
+{
+	PlaceWidget(_BarWidget);
+	PlaceWidget(_ChatWidget);
+}
+
 void POverlayController::SetLockState(LockState state)
 {
 	if (state != _LockState)
@@ -232,59 +300,73 @@ void POverlayController::SetLockState(LockState state)
 	}
 }
 
-bool POverlayController::IsGameOrOverlayActive() const
+bool POverlayController::IsOverlayWindow(WId window) const
 {
-	// We're looking for the title of the foreground window to see if it's Path of Exile or one of the overlay
-	// windows.
-	auto windowHwnd = GetForegroundWindow();
-	if (!windowHwnd) return false;
-	WCHAR title[33];
-	title[32] = '\0]';
-	auto len = GetWindowTextW(windowHwnd, title, 32);
-	bool show = false;
-	auto titleStr = QString::fromStdWString(title);
-	titleStr.remove(" - PoePal");
-	return titleStr == L"Path of Exile" || titleStr == _BarWidget->windowTitle() ||
-		(_ChatWidget && titleStr == _ChatWidget->windowTitle());
+	// Only compare windows that already have a native handle; asking for one would create it.
+	if (!window) return false;
+	return (_BarWidget && _BarWidget->internalWinId() == window) || 
+		(_ChatWidget && _ChatWidget->internalWinId() == window);
 }
 
 void POverlayController::ApplyLockAppearance(QWidget* widget)
 {
-	// Record the original corner location. We'll use this to move the window once the frame and title are
-	// hidden.
-	auto origCornerPos = widget->geometry().topLeft();
-	bool visible = widget->isVisible();
-	if (visible) widget->hide();
-	widget->setWindowFlags(widget->windowFlags() | Qt::FramelessWindowHint);
-	if (visible) widget->show();
-	// Move the window back so that the corner is in the original location.
-	auto newCornerPos = widget->geometry().topLeft();
-	auto newWindowPos = widget->pos();
-	widget->move(newWindowPos.x() + origCornerPos.x() - newCornerPos.x(),
-		newWindowPos.y() + origCornerPos.y() - newCornerPos.y());
+	SetNativeWindowFlags(widget, GetLockedWindowFlags(widget));
 	// Remove the event filter so arrows are no longer captured.
 	UninstallArrowFilter(widget);
 }
 
 void POverlayController::ApplyUnlockAppearance(QWidget* widget)
 {
-	// Record the original corner location. We'll use this to move the window once the frame and title are
-	// shown.
-	auto origCornerPos = widget->geometry().topLeft();
-	auto origWindowPos = widget->pos();
-	bool visible = widget->isVisible();
-	if (visible) widget->hide();
-	widget->setWindowFlags(widget->windowFlags() & ~Qt::FramelessWindowHint);
-	if (visible) widget->show();
-	// Move the window back so that the corner is in the original location.
-	auto newCornerPos = widget->geometry().topLeft();
-	widget->move(origWindowPos.x() + origCornerPos.x() - newCornerPos.x(),
-		origWindowPos.y() + origCornerPos.y() - newCornerPos.y());
+	SetNativeWindowFlags(widget, widget->windowFlags() & 
+		~(Qt::FramelessWindowHint | Qt::WindowTransparentForInput));
 	// Install an event filter on all of the child widgets. We'll use this to be able to move the widget 
 	// around with keys while the UI is unlocked.
 	InstallArrowFilter(widget);
 }
 
+Qt::WindowFlags POverlayController::GetLockedWindowFlags(QWidget* widget) const
+{
+	auto flags = widget->windowFlags() | Qt::FramelessWindowHint;
+	// Only the chat widget lets clicks through; the bar has to stay usable to unlock the overlay.
+	if (_ClickThrough && widget == _ChatWidget) flags |= Qt::WindowTransparentForInput;
+	else flags &= ~Qt::WindowTransparentForInput;
+	return flags;
+}
+
+void POverlayController::SetNativeWindowFlags(QWidget* widget, Qt::WindowFlags flags)
+{
+	// QWidget::setWindowFlags destroys and recreates the native window. Instead, the widget is only told about
+	// the new flags and the existing native window restyles itself in place.
+	auto rect = widget->geometry();
+	widget->overrideWindowFlags(flags);
+	if (auto window = widget->windowHandle()) window->setFlags(flags);
+	// Keep the contents where they were while the frame and title appear or disappear around them.
+	widget->setGeometry(rect);
+}
+
+void POverlayController::PlaceWidget(QWidget* widget)
+{
+	if (!widget) return;
+	MoveWidget(widget, _Layout->PlaceWindow(GetLayoutName(widget), widget->geometry()));
+}
+
+void POverlayController::MoveWidget(QWidget* widget, const QRect& rect)
+{
+	// The layout works with the contents, but the widget is moved by its frame.
+	widget->move(widget->pos() + rect.topLeft() - widget->geometry().topLeft());
+}
+
+void POverlayController::StorePositions()
+{
+	if (_BarWidget) _Layout->StorePosition(GetLayoutName(_BarWidget), _BarWidget->geometry());
+	if (_ChatWidget) _Layout->StorePosition(GetLayoutName(_ChatWidget), _ChatWidget->geometry());
+}
+
+QString POverlayController::GetLayoutName(QWidget* widget) const
+{
+	return widget == _BarWidget ? QStringLiteral("BarWidget") : QStringLiteral("ChatWidget");
+}
+
 void POverlayController::InstallArrowFilter(QWidget* widget)
 {
 	for (const auto& child : widget->findChildren<QWidget*>()) child->installEventFilter(this);
@@ -18,9 +18,12 @@
 #include <QObject>
 #include <QPointer>
 #include <QTimer>
+#include <QWindowDefs>
 
+class PFocusSource;
 class POverlayBarWidget;
 class POverlayChatWidget;
+class POverlayLayout;
 
 /**
  * Class handles the behavior of the in-game overlay.
@@ -46,6 +49,11 @@ class POverlayController : public QObject
 	 */
 	Q_PROPERTY(bool gameActive READ IsGameActive NOTIFY GameActiveChanged)
 
+	/**
+	 * Indicates whether clicks go through the chat widget to the game while the overlay is locked.
+	 */
+	Q_PROPERTY(bool clickThrough READ IsClickThrough WRITE SetClickThrough NOTIFY ClickThroughChanged)
+
 public:
 
 	/**
@@ -77,6 +85,27 @@ public:
 	 */
 	void Initialize();
 
+	/**
+	 * Retrieves the source of foreground window changes.
+	 * @return
+	 *   The focus source.
+	 */
+	PFocusSource* GetFocusSource() const;
+
+	/**
+	 * Replaces the source of foreground window changes. This must be called before the controller is initialized.
+	 * @param[in] source
+	 *   The new focus source. The controller takes ownership of it.
+	 */
+	void SetFocusSource(PFocusSource* source);
+
+	/**
+	 * Retrieves the layout that positions the overlay widgets on the screens.
+	 * @return
+	 *   The overlay layout.
+	 */
+	POverlayLayout* GetLayout() const;
+
 	/**
 	 * Retrieves the overlay bar widget.
 	 * @return
@@ -112,6 +141,13 @@ public:
 	 */
 	bool IsGameActive() const;
 
+	/**
+	 * Indicates whether clicks go through the chat widget to the game while the overlay is locked.
+	 * @return
+	 *   true if the chat widget lets clicks through when locked, false otherwise.
+	 */
+	bool IsClickThrough() const;
+
 	/**
 	 * Retrieves the overlay style sheet.
 	 * @return
@@ -119,6 +155,13 @@ public:
 	 */
 	QString GetStyleSheet() const;
 
+	/**
+	 * Replaces the overlay style sheet. It is parsed once and applies to every overlay widget.
+	 * @param[in] styleSheet
+	 *   The new style sheet.
+	 */
+	void SetStyleSheet(const QString& styleSheet);
+
 signals:
 
 	/**
@@ -152,6 +195,13 @@ signals:
 	 */
 	bool GameActiveChanged(bool active);
 
+	/**
+	 * Signal sent when the click-through setting changes.
+	 * @param[in] clickThrough
+	 *   true if the chat widget now lets clicks through when locked, false otherwise.
+	 */
+	void ClickThroughChanged(bool clickThrough);
+
 public slots:
 
 	/**
@@ -188,6 +238,13 @@ public slots:
 	 */
 	void SetChatVisibility(bool visible);
 
+	/**
+	 * Sets whether clicks go through the chat widget to the game while the overlay is locked.
+	 * @param[in] clickThrough
+	 *   true if the chat widget should let clicks through when locked, false otherwise.
+	 */
+	void SetClickThrough(bool clickThrough);
+
 protected:
 
 	/**
@@ -200,9 +257,15 @@ protected:
 private slots:
 
 	/**
-	 * Slot called when the timer is triggered to check whether the game is the active window.
+	 * Slot called when another window comes to the foreground.
+	 * @param[in] window
+	 *   The native handle of the window.
+	 * @param[in] processId
+	 *   The ID of the process owning the window.
+	 * @param[in] game
+	 *   true if the window belongs to the game, false otherwise.
 	 */
-	void OnCheckGameActive();
+	void OnForegroundChanged(WId window, qint64 processId, bool game);
 
 	/**
 	 * Slot called to apply the lock appearance to all widgets.
@@ -214,6 +277,11 @@ private slots:
 	 */
 	void OnApplyUnlockAppearance();
 
+	/**
+	 * Slot called when the screen configuration changes. This moves the widgets to where they belong on it.
+	 */
+	void OnScreensChanged();
+
 private:
 
 	/**
@@ -224,11 +292,18 @@ private:
 	void SetLockState(LockState state);
 
 	/**
-	 * Checks whether the active window is either an overlay window or the game.
+	 * Checks whether a window is one of the overlay windows.
+	 * @param[in] window
+	 *   The native handle of the window.
 	 * @return
-	 *   true if the active window is an overlay window or the game, false otherwise.
+	 *   true if the window is an overlay window, false otherwise.
 	 */
-	bool IsGameOrOverlayActive() const;
+	bool IsOverlayWindow(WId window) const;
+
+	/**
+	 * Applies a pending lock or unlock appearance if the game is active.
+	 */
+	void ApplyPendingLockState();
 
 	/**
 	 * Change the appearance of a widget to show as locked.
@@ -244,6 +319,55 @@ private:
 	 */
 	void ApplyUnlockAppearance(QWidget* widget);
 
+	/**
+	 * Retrieves the window flags a widget should have while the overlay is locked.
+	 * @param[in] widget
+	 *   The widget.
+	 * @return
+	 *   The window flags.
+	 */
+	Qt::WindowFlags GetLockedWindowFlags(QWidget* widget) const;
+
+	/**
+	 * Changes the window flags of a widget without recreating its native window. The contents of the widget stay
+	 * in place.
+	 * @param[in] widget
+	 *   The widget.
+	 * @param[in] flags
+	 *   The new window flags.
+	 */
+	void SetNativeWindowFlags(QWidget* widget, Qt::WindowFlags flags);
+
+	/**
+	 * Moves a widget to where the layout says it belongs on the current screen configuration.
+	 * @param[in] widget
+	 *   The widget.
+	 */
+	void PlaceWidget(QWidget* widget);
+
+	/**
+	 * Moves a widget so its contents have the given position.
+	 * @param[in] widget
+	 *   The widget.
+	 * @param[in] rect
+	 *   The new geometry of the contents of the widget.
+	 */
+	void MoveWidget(QWidget* widget, const QRect& rect);
+
+	/**
+	 * Stores the positions of the widgets in the layout for the current screen configuration.
+	 */
+	void StorePositions();
+
+	/**
+	 * Retrieves the name the layout knows a widget by.
+	 * @param[in] widget
+	 *   The widget.
+	 * @return
+	 *   The name of the widget.
+	 */
+	QString GetLayoutName(QWidget* widget) const;
+
 	/**
 	 * Installs the arrow event filter for the given widget and all of its children.
 	 * @param[in] widget
@@ -295,9 +419,14 @@ private:
 	QPointer<POverlayChatWidget> _ChatWidget;
 
 	/**
-	 * Timer to check the whether the game is the foreground window.
+	 * The layout that positions the overlay widgets on the screens.
+	 */
+	POverlayLayout* _Layout = nullptr;
+
+	/**
+	 * The source of foreground window changes.
 	 */
-	QTimer _GameCheckTimer;
+	PFocusSource* _FocusSource = nullptr;
 
 	/**
 	 * Indicates whether or not the game is active.
@@ -309,9 +438,19 @@ private:
 	 */
 	bool _ChatVisible = false;
 
+	/**
+	 * Indicates whether clicks go through the chat widget while the overlay is locked.
+	 */
+	bool _ClickThrough = false;
+
 	/**
 	 * The stylesheet shared for the overlay widgets.
 	 */
 	QString _OverlayStyle;
 
+	/**
+	 * The hidden widget that holds the overlay style sheet and owns the overlay widgets.
+	 */
+	QPointer<QWidget> _StyleHost;
+
 };
\ No newline at end of file
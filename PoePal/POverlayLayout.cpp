@@ -0,0 +1,254 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "POverlayLayout.h"
+#include <QGuiApplication>
+#include <QScreen>
+#include <QSettings>
+#include <algorithm>
+
+namespace
+{
+	/**
+	 * The settings group holding the stored positions.
+	 */
+	const QString _SettingsGroup = QStringLiteral("Overlay/Layouts");
+}
+
+POverlayLayout::POverlayLayout(QObject* parent):
+QObject(parent)
+{
+	// Without a GUI application there are no screens to follow; SetScreens is the only source of screens then.
+	auto app = qobject_cast<QGuiApplication*>(QCoreApplication::instance());
+	if (app)
+	{
+		connect(app, &QGuiApplication::screenAdded, this, &POverlayLayout::OnScreenAdded);
+		connect(app, &QGuiApplication::screenRemoved, this, &POverlayLayout::OnScreensChanged);
+		connect(app, &QGuiApplication::primaryScreenChanged, this, &POverlayLayout::OnScreensChanged);
+		for (const auto& screen : app->screens()) WatchScreen(screen);
+	}
+	LoadSettings();
+}
+
+POverlayLayout::~POverlayLayout()
+{
+	SaveSettings();
+}
+
+const QVector<POverlayLayout::ScreenInfo>& POverlayLayout::GetScreens() const
+{
+	if (!_ScreensValid)
+	{
+		_Screens.clear();
+		if (qobject_cast<QGuiApplication*>(QCoreApplication::instance()))
+		{
+			// The primary screen comes first and the others are sorted by position, so the index of a screen
+			// doesn't depend on the order the platform happens to list them in.
+			auto primary = QGuiApplication::primaryScreen();
+			auto screens = QGuiApplication::screens();
+			std::stable_sort(screens.begin(), screens.end(), [primary](QScreen* left, QScreen* right) {
+				if ((left == primary) != (right == primary)) return left == primary;
+				auto leftPos = left->geometry().topLeft();
+				auto rightPos = right->geometry().topLeft();
+				return leftPos.x() < rightPos.x() || (leftPos.x() == rightPos.x() && leftPos.y() < rightPos.y());
+			});
+			for (const auto& screen : screens)
+			{
+				ScreenInfo info;
+				info._Geometry = screen->geometry();
+				info._DevicePixelRatio = screen->devicePixelRatio();
+				_Screens.append(info);
+			}
+		}
+		_ConfigurationKey = MakeConfigurationKey(_Screens);
+		_ScreensValid = true;
+	}
+	return _Screens;
+}
+
+void POverlayLayout::SetScreens(const QVector<ScreenInfo>& screens)
+{
+	_Screens = screens;
+	_ConfigurationKey = MakeConfigurationKey(_Screens);
+	_ScreensValid = true;
+	emit ScreensChanged();
+}
+
+QString POverlayLayout::GetConfigurationKey() const
+{
+	GetScreens();
+	return _ConfigurationKey;
+}
+
+QRect POverlayLayout::MoveBy(const QRect& rect, const QPoint& delta) const
+{
+	// The window stays on the screen it started on.
+	const auto& screens = GetScreens();
+	auto index = FindScreen(screens, rect);
+	if (index < 0) return rect.translated(delta);
+	return ClampToScreen(rect.translated(delta), screens[index]._Geometry);
+}
+
+void POverlayLayout::StorePosition(const QString& name, const QRect& rect)
+{
+	const auto& screens = GetScreens();
+	auto index = FindScreen(screens, rect);
+	if (index < 0) return;
+	_Positions[_ConfigurationKey][name] = MakeAnchor(rect, screens[index]._Geometry, index);
+}
+
+QRect POverlayLayout::PlaceWindow(const QString& name, const QRect& rect) const
+{
+	const auto& screens = GetScreens();
+	auto positions = _Positions.constFind(_ConfigurationKey);
+	if (positions != _Positions.constEnd())
+	{
+		auto anchor = positions->constFind(name);
+		if (anchor != positions->constEnd() && anchor->_Screen >= 0 && anchor->_Screen < screens.size())
+		{
+			return ResolveAnchor(*anchor, rect.size(), screens[anchor->_Screen]._Geometry);
+		}
+	}
+	auto index = FindScreen(screens, rect);
+	if (index < 0) return rect;
+	return ClampToScreen(rect, screens[index]._Geometry);
+}
+
+QString POverlayLayout::MakeConfigurationKey(const QVector<ScreenInfo>& screens)
+{
+	QStringList parts;
+	for (const auto& screen : screens)
+	{
+		const auto& geometry = screen._Geometry;
+		parts.append(QString::asprintf("%dx%d%+d%+d@%g", geometry.width(), geometry.height(), geometry.x(),
+			geometry.y(), screen._DevicePixelRatio));
+	}
+	return parts.join(QLatin1Char('_'));
+}
+
+int POverlayLayout::FindScreen(const QVector<ScreenInfo>& screens, const QRect& rect)
+{
+	int bestIndex = screens.isEmpty() ? -1 : 0;
+	qint64 bestArea = 0;
+	for (int i = 0; i < screens.size(); ++i)
+	{
+		const auto& geometry = screens[i]._Geometry;
+		if (geometry.contains(rect.center())) return i;
+		auto overlap = geometry.intersected(rect);
+		qint64 area = qint64(overlap.width()) * overlap.height();
+		if (area > bestArea)
+		{
+			bestArea = area;
+			bestIndex = i;
+		}
+	}
+	return bestIndex;
+}
+
+QRect POverlayLayout::ClampToScreen(const QRect& rect, const QRect& screen)
+{
+	QRect clamped(rect);
+	if (clamped.right() > screen.right()) clamped.moveRight(screen.right());
+	if (clamped.bottom() > screen.bottom()) clamped.moveBottom(screen.bottom());
+	if (clamped.left() < screen.left()) clamped.moveLeft(screen.left());
+	if (clamped.top() < screen.top()) clamped.moveTop(screen.top());
+	return clamped;
+}
+
+POverlayLayout::Anchor POverlayLayout::MakeAnchor(const QRect& rect, const QRect& screen, int screenIndex)
+{
+	Anchor anchor;
+	anchor._Screen = screenIndex;
+	bool right = rect.center().x() > screen.center().x();
+	bool bottom = rect.center().y() > screen.center().y();
+	if (bottom) anchor._Corner = right ? Qt::BottomRightCorner : Qt::BottomLeftCorner;
+	else anchor._Corner = right ? Qt::TopRightCorner : Qt::TopLeftCorner;
+	anchor._Offset.setX(right ? screen.right() - rect.right() : rect.left() - screen.left());
+	anchor._Offset.setY(bottom ? screen.bottom() - rect.bottom() : rect.top() - screen.top());
+	return anchor;
+}
+
+QRect POverlayLayout::ResolveAnchor(const Anchor& anchor, const QSize& size, const QRect& screen)
+{
+	QRect rect(QPoint(0, 0), size);
+	bool right = anchor._Corner == Qt::TopRightCorner || anchor._Corner == Qt::BottomRightCorner;
+	bool bottom = anchor._Corner == Qt::BottomLeftCorner || anchor._Corner == Qt::BottomRightCorner;
+	if (right) rect.moveRight(screen.right() - anchor._Offset.x());
+	else rect.moveLeft(screen.left() + anchor._Offset.x());
+	if (bottom) rect.moveBottom(screen.bottom() - anchor._Offset.y());
+	else rect.moveTop(screen.top() + anchor._Offset.y());
+	return ClampToScreen(rect, screen);
+}
+
+void POverlayLayout::OnScreenAdded(QScreen* screen)
+{
+	WatchScreen(screen);
+	OnScreensChanged();
+}
+
+void POverlayLayout::OnScreensChanged()
+{
+	_ScreensValid = false;
+	emit ScreensChanged();
+}
+
+void POverlayLayout::WatchScreen(QScreen* screen)
+{
+	connect(screen, &QScreen::geometryChanged, this, &POverlayLayout::OnScreensChanged);
+	connect(screen, &QScreen::logicalDotsPerInchChanged, this, &POverlayLayout::OnScreensChanged);
+}
+
+void POverlayLayout::LoadSettings()
+{
+	QSettings settings;
+	settings.beginGroup(_SettingsGroup);
+	for (const auto& key : settings.childGroups())
+	{
+		settings.beginGroup(key);
+		auto& positions = _Positions[key];
+		for (const auto& name : settings.childGroups())
+		{
+			settings.beginGroup(name);
+			Anchor anchor;
+			anchor._Screen = settings.value(QStringLiteral("Screen"), 0).toInt();
+			anchor._Corner = static_cast<Qt::Corner>(settings.value(QStringLiteral("Corner"), 0).toInt());
+			anchor._Offset = settings.value(QStringLiteral("Offset")).toPoint();
+			positions.insert(name, anchor);
+			settings.endGroup(); // name
+		}
+		settings.endGroup(); // key
+	}
+	settings.endGroup(); // Overlay/Layouts
+}
+
+void POverlayLayout::SaveSettings() const
+{
+	QSettings settings;
+	settings.beginGroup(_SettingsGroup);
+	for (auto config = _Positions.constBegin(); config != _Positions.constEnd(); ++config)
+	{
+		settings.beginGroup(config.key());
+		for (auto position = config->constBegin(); position != config->constEnd(); ++position)
+		{
+			settings.beginGroup(position.key());
+			settings.setValue(QStringLiteral("Screen"), position->_Screen);
+			settings.setValue(QStringLiteral("Corner"), static_cast<int>(position->_Corner));
+			settings.setValue(QStringLiteral("Offset"), position->_Offset);
+			settings.endGroup(); // name
+		}
+		settings.endGroup(); // key
+	}
+	settings.endGroup(); // Overlay/Layouts
+}
@@ -0,0 +1,260 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QRect>
+#include <QVector>
+
+class QScreen;
+
+/**
+ * Class keeps track of where the overlay windows belong on the attached screens.
+ * Positions are stored relative to the nearest corner of a screen, separately for every screen configuration, so
+ * a window returns to the same spot whenever the same monitors, resolutions and scale factors are in use. The
+ * screen geometry is cached until the application reports a screen change. All of the geometry math is exposed as
+ * static functions that don't need a native window or screen.
+ */
+class POverlayLayout : public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * The geometry of a screen.
+	 */
+	struct ScreenInfo
+	{
+		/**
+		 * The geometry of the screen, in device-independent pixels.
+		 */
+		QRect _Geometry;
+
+		/**
+		 * The ratio between physical and device-independent pixels.
+		 */
+		qreal _DevicePixelRatio = 1.0;
+	};
+
+	/**
+	 * A position relative to a corner of a screen.
+	 */
+	struct Anchor
+	{
+		/**
+		 * The index of the screen within the screen configuration.
+		 */
+		int _Screen = 0;
+
+		/**
+		 * The corner of the screen the window is attached to.
+		 */
+		Qt::Corner _Corner = Qt::TopLeftCorner;
+
+		/**
+		 * The distance between the corner of the screen and the same corner of the window, measured towards the
+		 * middle of the screen.
+		 */
+		QPoint _Offset;
+	};
+
+	/**
+	 * Creates a new layout and loads the stored positions.
+	 * @param[in] parent
+	 *   The parent of the layout.
+	 */
+	POverlayLayout(QObject* parent);
+
+	/**
+	 * Destructor saves the stored positions.
+	 */
+	virtual ~POverlayLayout();
+
+	/**
+	 * Retrieves the attached screens. The primary screen comes first.
+	 * @return
+	 *   The cached geometry of the screens.
+	 */
+	const QVector<ScreenInfo>& GetScreens() const;
+
+	/**
+	 * Replaces the cached screens until the next screen change is reported. This allows layouts to be computed
+	 * for screens other than the attached ones.
+	 * @param[in] screens
+	 *   The geometry of the screens.
+	 */
+	void SetScreens(const QVector<ScreenInfo>& screens);
+
+	/**
+	 * Retrieves the key identifying the current screen configuration.
+	 * @return
+	 *   The key of the screen configuration.
+	 */
+	QString GetConfigurationKey() const;
+
+	/**
+	 * Moves a window without leaving the screen it is on.
+	 * @param[in] rect
+	 *   The current geometry of the window.
+	 * @param[in] delta
+	 *   The distance to move the window.
+	 * @return
+	 *   The new geometry of the window.
+	 */
+	QRect MoveBy(const QRect& rect, const QPoint& delta) const;
+
+	/**
+	 * Stores the position of a window for the current screen configuration.
+	 * @param[in] name
+	 *   The name of the window.
+	 * @param[in] rect
+	 *   The geometry of the window.
+	 */
+	void StorePosition(const QString& name, const QRect& rect);
+
+	/**
+	 * Determines where a window belongs on the current screen configuration. The stored position is used if there
+	 * is one, otherwise the window is kept where it is but moved onto the screen if it is partly off of it.
+	 * @param[in] name
+	 *   The name of the window.
+	 * @param[in] rect
+	 *   The current geometry of the window.
+	 * @return
+	 *   The geometry the window should have.
+	 */
+	QRect PlaceWindow(const QString& name, const QRect& rect) const;
+
+	/**
+	 * Builds the key identifying a screen configuration.
+	 * @param[in] screens
+	 *   The geometry of the screens.
+	 * @return
+	 *   The key of the screen configuration.
+	 */
+	static QString MakeConfigurationKey(const QVector<ScreenInfo>& screens);
+
+	/**
+	 * Finds the screen a window is on. This is the screen containing the center of the window or, failing that,
+	 * the screen overlapping the window the most.
+	 * @param[in] screens
+	 *   The geometry of the screens.
+	 * @param[in] rect
+	 *   The geometry of the window.
+	 * @return
+	 *   The index of the screen or -1 if there are no screens.
+	 */
+	static int FindScreen(const QVector<ScreenInfo>& screens, const QRect& rect);
+
+	/**
+	 * Moves a rectangle so it is inside of a screen. A rectangle larger than the screen is aligned with the top
+	 * left corner of the screen.
+	 * @param[in] rect
+	 *   The rectangle.
+	 * @param[in] screen
+	 *   The geometry of the screen.
+	 * @return
+	 *   The moved rectangle.
+	 */
+	static QRect ClampToScreen(const QRect& rect, const QRect& screen);
+
+	/**
+	 * Builds the anchor of a window relative to the screen corner nearest to its center.
+	 * @param[in] rect
+	 *   The geometry of the window.
+	 * @param[in] screen
+	 *   The geometry of the screen.
+	 * @param[in] screenIndex
+	 *   The index of the screen within the screen configuration.
+	 * @return
+	 *   The anchor of the window.
+	 */
+	static Anchor MakeAnchor(const QRect& rect, const QRect& screen, int screenIndex);
+
+	/**
+	 * Computes the geometry of a window from its anchor.
+	 * @param[in] anchor
+	 *   The anchor of the window.
+	 * @param[in] size
+	 *   The size of the window.
+	 * @param[in] screen
+	 *   The geometry of the screen the anchor refers to.
+	 * @return
+	 *   The geometry of the window, kept inside of the screen.
+	 */
+	static QRect ResolveAnchor(const Anchor& anchor, const QSize& size, const QRect& screen);
+
+signals:
+
+	/**
+	 * Signal sent when a screen is added, removed or changes its geometry or scale factor.
+	 */
+	void ScreensChanged();
+
+private slots:
+
+	/**
+	 * Slot called when a screen is attached.
+	 * @param[in] screen
+	 *   The new screen.
+	 */
+	void OnScreenAdded(QScreen* screen);
+
+	/**
+	 * Slot called when anything about the attached screens changes. This drops the cached screen geometry.
+	 */
+	void OnScreensChanged();
+
+private:
+
+	/**
+	 * Starts listening for changes to a screen.
+	 * @param[in] screen
+	 *   The screen.
+	 */
+	void WatchScreen(QScreen* screen);
+
+	/**
+	 * Loads the stored positions from the settings.
+	 */
+	void LoadSettings();
+
+	/**
+	 * Saves the stored positions to the settings.
+	 */
+	void SaveSettings() const;
+
+	/**
+	 * The cached geometry of the screens.
+	 */
+	mutable QVector<ScreenInfo> _Screens;
+
+	/**
+	 * The key of the cached screen configuration.
+	 */
+	mutable QString _ConfigurationKey;
+
+	/**
+	 * Indicates whether the cached screens are up to date.
+	 */
+	mutable bool _ScreensValid = false;
+
+	/**
+	 * The stored positions, mapped by screen configuration key and then by window name.
+	 */
+	QHash<QString, QHash<QString, Anchor>> _Positions;
+};
@@ -15,6 +15,7 @@
  */
 #include "PPassivesWindow.h"
 #include "PApplication.h"
+#include "PMessageBus.h"
 #include "PMessageHandler.h"
 #include <QRegularExpression>
 
@@ -35,7 +36,10 @@ PPassivesWindow::PPassivesWindow(QWidget *parent)
 	Q_ASSERT(app);
 	auto handler = app->GetMessageHandler();
 	Q_ASSERT(handler);
-	connect(handler, &PMessageHandler::NewMessage, this, &PPassivesWindow::OnNewMessage);
+	// Only the game's notices matter here, not chat.
+	PMessageBus::Subscription subscription;
+	subscription._Subtypes = {PMessage::Event, PMessage::Log};
+	handler->GetMessageBus()->Subscribe(subscription, this, [this](PMessage *message) { OnNewMessage(message); });
 	connect(ui._RefreshBtn, &QPushButton::clicked, this, &PPassivesWindow::Refresh);
 }
 
@@ -0,0 +1,56 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "PFocusSource.h"
+
+/**
+ * Reports foreground changes that are made by hand, so the overlay logic can be driven without a Windows desktop.
+ */
+class PSimulatedFocusSource : public PFocusSource
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * Creates a new focus source.
+	 * @param[in] parent
+	 *   The parent of the focus source.
+	 */
+	PSimulatedFocusSource(QObject *parent = nullptr);
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~PSimulatedFocusSource();
+
+	/**
+	 * Reports that no window is in the foreground.
+	 */
+	virtual void Start() override;
+
+	/**
+	 * Brings a simulated window to the foreground.
+	 * @param[in] window
+	 *   The native handle of the window.
+	 * @param[in] processId
+	 *   The ID of the process owning the window.
+	 * @param[in] game
+	 *   true if the window belongs to the game, false otherwise.
+	 */
+	void Activate(WId window, qint64 processId, bool game);
+};
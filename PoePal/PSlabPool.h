@@ -0,0 +1,267 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QtGlobal>
+#include <new>
+
+/**
+ * Allocates fixed size objects from contiguous slabs rather than individually from the heap.
+ * Each slab holds a batch of objects so a burst of messages shares a few allocations. Every slab keeps its own
+ * free list, and a slab goes back to the heap in one piece as soon as all of its objects are released. One empty
+ * slab is kept in reserve so a pool hovering around a slab boundary doesn't allocate and free a slab each time.
+ * The pool is not thread safe; callers that share one across threads must serialize access to it.
+ */
+template<typename T, int SlabSize = 256>
+class PSlabPool
+{
+public:
+
+	/**
+	 * Creates an empty pool.
+	 */
+	PSlabPool() = default;
+
+	/**
+	 * Destructor returns all of the slabs to the heap.
+	 */
+	~PSlabPool()
+	{
+		while (_Slabs) DestroySlab(_Slabs);
+	}
+
+	PSlabPool(const PSlabPool &) = delete;
+	PSlabPool & operator=(const PSlabPool &) = delete;
+
+	/**
+	 * Allocates storage for one object.
+	 * @return
+	 *   Uninitialized storage suitably sized and aligned for T.
+	 */
+	void * Allocate()
+	{
+		if (!_Partial)
+		{
+			auto slab = _Spare ? _Spare : CreateSlab();
+			_Spare = nullptr;
+			Link(slab, &_Partial);
+		}
+		auto slab = _Partial;
+		auto block = slab->_FreeList;
+		slab->_FreeList = block->_Data._Next;
+		++slab->_Used;
+		++_Used;
+		// A full slab has nothing left to give, so it leaves the list of slabs with free blocks.
+		if (!slab->_FreeList) Unlink(slab, &_Partial);
+		return &block->_Data;
+	}
+
+	/**
+	 * Returns storage allocated by this pool so it can be reused.
+	 * @param[in] ptr
+	 *   The storage to release. The object in it must already be destroyed.
+	 */
+	void Release(void *ptr)
+	{
+		if (!ptr) return;
+		// The data is the first member of the block, so the block starts at the same address.
+		auto block = reinterpret_cast<Block *>(ptr);
+		auto slab = block->_Slab;
+		if (!slab->_FreeList) Link(slab, &_Partial);
+		block->_Data._Next = slab->_FreeList;
+		slab->_FreeList = block;
+		--slab->_Used;
+		--_Used;
+		if (slab->_Used > 0) return;
+		// The whole slab is free, so it goes back to the heap unless it becomes the reserve.
+		Unlink(slab, &_Partial);
+		if (_Spare) DestroySlab(slab);
+		else _Spare = slab;
+	}
+
+	/**
+	 * Retrieves the number of objects currently allocated from the pool.
+	 * @return
+	 *   The number of allocated objects.
+	 */
+	int GetUsedCount() const
+	{
+		return _Used;
+	}
+
+	/**
+	 * Retrieves the number of slabs the pool currently holds from the heap.
+	 * @return
+	 *   The number of slabs.
+	 */
+	int GetSlabCount() const
+	{
+		return _SlabCount;
+	}
+
+private:
+
+	struct Slab;
+
+	/**
+	 * A block of storage within a slab.
+	 */
+	struct Block
+	{
+		/**
+		 * The storage for the object, which links to the next free block of the slab while it is unused.
+		 */
+		union Data
+		{
+			/**
+			 * The next free block.
+			 */
+			Block *_Next;
+
+			/**
+			 * The storage for the object.
+			 */
+			alignas(T) char _Storage[sizeof(T)];
+		} _Data;
+
+		/**
+		 * The slab the block belongs to.
+		 */
+		Slab *_Slab;
+	};
+
+	/**
+	 * A batch of blocks taken from the heap in one allocation.
+	 */
+	struct Slab
+	{
+		/**
+		 * The blocks of the slab.
+		 */
+		Block _Blocks[SlabSize];
+
+		/**
+		 * The first free block of the slab.
+		 */
+		Block *_FreeList = nullptr;
+
+		/**
+		 * The number of blocks currently allocated from the slab.
+		 */
+		int _Used = 0;
+
+		/**
+		 * The neighbors in the list of slabs with free blocks.
+		 */
+		Slab *_PrevPartial = nullptr, *_NextPartial = nullptr;
+
+		/**
+		 * The neighbors in the list of all slabs.
+		 */
+		Slab *_PrevSlab = nullptr, *_NextSlab = nullptr;
+	};
+
+	/**
+	 * Takes a new slab from the heap with all of its blocks free.
+	 * @return
+	 *   The new slab.
+	 */
+	Slab * CreateSlab()
+	{
+		auto slab = new Slab;
+		for (int b = SlabSize - 1; b >= 0; --b)
+		{
+			slab->_Blocks[b]._Slab = slab;
+			slab->_Blocks[b]._Data._Next = slab->_FreeList;
+			slab->_FreeList = &slab->_Blocks[b];
+		}
+		slab->_NextSlab = _Slabs;
+		if (_Slabs) _Slabs->_PrevSlab = slab;
+		_Slabs = slab;
+		++_SlabCount;
+		return slab;
+	}
+
+	/**
+	 * Returns a slab to the heap. It must not be in the list of slabs with free blocks.
+	 * @param[in] slab
+	 *   The slab.
+	 */
+	void DestroySlab(Slab *slab)
+	{
+		if (slab->_PrevSlab) slab->_PrevSlab->_NextSlab = slab->_NextSlab;
+		else _Slabs = slab->_NextSlab;
+		if (slab->_NextSlab) slab->_NextSlab->_PrevSlab = slab->_PrevSlab;
+		if (slab == _Spare) _Spare = nullptr;
+		--_SlabCount;
+		delete slab;
+	}
+
+	/**
+	 * Adds a slab to the front of the list of slabs with free blocks.
+	 * @param[in] slab
+	 *   The slab.
+	 * @param[in,out] head
+	 *   The first slab of the list.
+	 */
+	static void Link(Slab *slab, Slab **head)
+	{
+		slab->_PrevPartial = nullptr;
+		slab->_NextPartial = *head;
+		if (*head) (*head)->_PrevPartial = slab;
+		*head = slab;
+	}
+
+	/**
+	 * Removes a slab from the list of slabs with free blocks.
+	 * @param[in] slab
+	 *   The slab.
+	 * @param[in,out] head
+	 *   The first slab of the list.
+	 */
+	static void Unlink(Slab *slab, Slab **head)
+	{
+		if (slab->_PrevPartial) slab->_PrevPartial->_NextPartial = slab->_NextPartial;
+		else *head = slab->_NextPartial;
+		if (slab->_NextPartial) slab->_NextPartial->_PrevPartial = slab->_PrevPartial;
+		slab->_PrevPartial = slab->_NextPartial = nullptr;
+	}
+
+	/**
+	 * All of the slabs taken from the heap, including full ones and the reserve.
+	 */
+	Slab *_Slabs = nullptr;
+
+	/**
+	 * The slabs that have free blocks and at least one allocated block.
+	 */
+	Slab *_Partial = nullptr;
+
+	/**
+	 * An empty slab kept in reserve.
+	 */
+	Slab *_Spare = nullptr;
+
+	/**
+	 * The number of slabs taken from the heap.
+	 */
+	int _SlabCount = 0;
+
+	/**
+	 * The number of blocks currently allocated.
+	 */
+	int _Used = 0;
+};
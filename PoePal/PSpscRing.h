@@ -0,0 +1,153 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QtGlobal>
+#include <atomic>
+#include <vector>
+
+/**
+ * A bounded queue that hands items from one producer thread to one consumer thread without locking.
+ * The producer only writes the tail and the consumer only writes the head, so each side needs a single atomic
+ * store per item and nothing is allocated once the ring exists. The capacity is rounded up to a power of two
+ * so positions wrap with a mask.
+ */
+template<typename T>
+class PSpscRing
+{
+public:
+
+	/**
+	 * Creates an empty ring.
+	 * @param[in] capacity
+	 *   The minimum number of items the ring can hold.
+	 * @param[in] highWater
+	 *   The number of items above which the producer should ask the consumer to drain the ring.
+	 */
+	explicit PSpscRing(int capacity, int highWater)
+	{
+		int size = 2;
+		while (size < capacity) size <<= 1;
+		_Items.resize(size);
+		_Mask = size - 1;
+		_HighWater = qBound(1, highWater, size);
+	}
+
+	PSpscRing(const PSpscRing &) = delete;
+	PSpscRing & operator=(const PSpscRing &) = delete;
+
+	/**
+	 * Adds an item to the ring. Only the producer thread may call this.
+	 * @param[in] item
+	 *   The item to add.
+	 * @return
+	 *   true if the item was added, false if the ring is full.
+	 */
+	bool TryPush(const T &item)
+	{
+		auto tail = _Tail.load(std::memory_order_relaxed);
+		if (tail - _Head.load(std::memory_order_acquire) > _Mask) return false;
+		_Items[tail & _Mask] = item;
+		_Tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Removes the oldest item from the ring. Only the consumer thread may call this.
+	 * @param[out] item
+	 *   Receives the item.
+	 * @return
+	 *   true if an item was removed, false if the ring is empty.
+	 */
+	bool TryPop(T &item)
+	{
+		auto head = _Head.load(std::memory_order_relaxed);
+		if (head == _Tail.load(std::memory_order_acquire)) return false;
+		item = _Items[head & _Mask];
+		_Head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Retrieves the number of items in the ring. This is only a snapshot when the other thread is active.
+	 * @return
+	 *   The number of items.
+	 */
+	int GetSize() const
+	{
+		return static_cast<int>(_Tail.load(std::memory_order_acquire) - _Head.load(std::memory_order_acquire));
+	}
+
+	/**
+	 * Indicates whether the ring holds more items than the high-water mark.
+	 * @return
+	 *   true if the consumer should drain the ring, false otherwise.
+	 */
+	bool IsAboveHighWater() const
+	{
+		return GetSize() > _HighWater;
+	}
+
+	/**
+	 * Claims the request to drain the ring, so the producer only asks once until the consumer has drained it.
+	 * @return
+	 *   true if the caller should ask the consumer to drain, false if it has already been asked.
+	 */
+	bool RequestDrain()
+	{
+		return !_DrainRequested.exchange(true, std::memory_order_acq_rel);
+	}
+
+	/**
+	 * Clears the request to drain the ring. The consumer calls this before draining.
+	 */
+	void ClearDrainRequest()
+	{
+		_DrainRequested.store(false, std::memory_order_release);
+	}
+
+private:
+
+	/**
+	 * The storage for the items.
+	 */
+	std::vector<T> _Items;
+
+	/**
+	 * The mask that wraps a position into the storage.
+	 */
+	quint64 _Mask = 0;
+
+	/**
+	 * The number of items above which the consumer should drain the ring.
+	 */
+	int _HighWater = 0;
+
+	/**
+	 * The position of the next item to remove. Only the consumer writes this.
+	 */
+	alignas(64) std::atomic<quint64> _Head{0};
+
+	/**
+	 * The position of the next item to add. Only the producer writes this.
+	 */
+	alignas(64) std::atomic<quint64> _Tail{0};
+
+	/**
+	 * Indicates whether the consumer has been asked to drain the ring.
+	 */
+	alignas(64) std::atomic<bool> _DrainRequested{false};
+};
@@ -15,6 +15,7 @@
  */
 #include "PStatusWidget.h"
 #include "PApplication.h"
+#include "PMessageBus.h"
 #include "PMessageHandler.h"
 #include <QKeyEvent>
 
@@ -37,7 +38,10 @@ PStatusWidget::PStatusWidget(QWidget *parent)
 	Q_ASSERT(app);
 	auto msgHandler = app->GetMessageHandler();
 	Q_ASSERT(msgHandler);
-	connect(msgHandler, &PMessageHandler::NewMessage, this, &PStatusWidget::OnNewMessage);
+	// Only the game's notices matter here, not chat.
+	PMessageBus::Subscription subscription;
+	subscription._Subtypes = {PMessage::Event, PMessage::Log};
+	msgHandler->GetMessageBus()->Subscribe(subscription, this, [this](PMessage *message) { OnNewMessage(message); });
 }
 
 PStatusWidget::~PStatusWidget()
@@ -14,18 +14,24 @@
  * <https://www.gnu.org/licenses/>.
  */
 #include "PVerticalTabBar.h"
-#include "PVerticalTabBarWidget.h"
-#include <QListWidget>
+#include <QAbstractListModel>
+#include <QApplication>
+#include <QListView>
+#include <QMouseEvent>
+#include <QPainter>
 #include <QScrollBar>
+#include <QStyledItemDelegate>
+#include <QTimer>
+#include <QVBoxLayout>
 
 namespace {
 	static QString _ListStylesheet(
-		"QListWidget {"
+		"QListView {"
 		"	background: transparent;"
 		"	border-right: 1px solid gray;"
 		"}"
 
-		".QListWidget::item{"
+		".QListView::item{"
 		"	background: transparent;"
 		"	margin-left: 4px;"
 		"	paddingt: 4px;"
@@ -34,7 +40,7 @@ namespace {
 		"	border-bottom: 1px solid #CCC;"
 		"}"
 
-		".QListWidget::item:selected{"
+		".QListView::item:selected{"
 		"	margin-left: 1px;"
 		"	margin-right: -1px;"
 		"	background: white;"
@@ -42,12 +48,293 @@ namespace {
 		"}"
 
 	);
+
+	/**
+	 * The size of the close icon on a tab, in pixels.
+	 */
+	const int _CloseIconSize = 12;
+
+	/**
+	 * The space around the contents of a tab, in pixels.
+	 */
+	const int _TabMargin = 4;
+
+	/**
+	 * Retrieves the icon for the close button on a tab.
+	 */
+	const QIcon & GetCloseIcon()
+	{
+		static QIcon icon(QStringLiteral(":/PoePal/Resources/32x32/cross.png"));
+		return icon;
+	}
+
+	/**
+	 * Retrieves the area of the close button on a tab.
+	 * @param[in] rect
+	 *   The area of the tab.
+	 * @return
+	 *   The area of the close button.
+	 */
+	QRect GetCloseRect(const QRect& rect)
+	{
+		return QRect(rect.left() + _TabMargin, rect.top() + (rect.height() - _CloseIconSize) / 2, 
+			_CloseIconSize, _CloseIconSize);
+	}
 }
 
+class PVerticalTabBar::TabModel : public QAbstractListModel
+{
+public:
+
+	/**
+	 * A tab in the tab bar.
+	 */
+	struct Tab
+	{
+		/**
+		 * The text on the tab.
+		 */
+		QString _Text;
+
+		/**
+		 * The color of the text or an invalid color to use the color of the view.
+		 */
+		QColor _TextColor;
+
+		/**
+		 * The tool tip for the tab.
+		 */
+		QString _ToolTip;
+
+		/**
+		 * The data associated to the tab.
+		 */
+		QVariant _Data;
+
+		/**
+		 * Indicates whether the tab is enabled.
+		 */
+		bool _Enabled = true;
+	};
+
+	/**
+	 * Creates a new model.
+	 * @param[in] parent
+	 *   The parent of the model.
+	 */
+	TabModel(QObject* parent):
+	QAbstractListModel(parent)
+	{
+	}
+
+	/**
+	 * Overrides QAbstractListModel#rowCount
+	 */
+	virtual int rowCount(const QModelIndex& parent = QModelIndex()) const override
+	{
+		return parent.isValid() ? 0 : _Tabs.length();
+	}
+
+	/**
+	 * Overrides QAbstractListModel#data
+	 */
+	virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override
+	{
+		auto tab = GetTab(index.row());
+		if (!index.isValid() || !tab) return QVariant();
+		switch (role)
+		{
+		case Qt::DisplayRole:
+			return tab->_Text;
+		case Qt::ForegroundRole:
+			return tab->_TextColor.isValid() ? QVariant(QBrush(tab->_TextColor)) : QVariant();
+		case Qt::ToolTipRole:
+			return tab->_ToolTip.isEmpty() ? QVariant() : QVariant(tab->_ToolTip);
+		case Qt::TextAlignmentRole:
+			return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+		case Qt::UserRole:
+			return tab->_Data;
+		}
+		return QVariant();
+	}
+
+	/**
+	 * Overrides QAbstractListModel#flags
+	 */
+	virtual Qt::ItemFlags flags(const QModelIndex& index) const override
+	{
+		auto tab = GetTab(index.row());
+		if (!index.isValid() || !tab || !tab->_Enabled) return Qt::NoItemFlags;
+		return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+	}
+
+	/**
+	 * Retrieves a tab.
+	 * @param[in] index
+	 *   The index of the tab.
+	 * @return
+	 *   The tab or null if the index is out of range.
+	 */
+	const Tab* GetTab(int index) const
+	{
+		return index >= 0 && index < _Tabs.length() ? &_Tabs.at(index) : nullptr;
+	}
+
+	/**
+	 * Changes a tab.
+	 * @param[in] index
+	 *   The index of the tab.
+	 * @param[in] change
+	 *   The function changing the tab.
+	 */
+	template<typename Change>
+	void ChangeTab(int index, Change change)
+	{
+		if (index < 0 || index >= _Tabs.length()) return;
+		change(_Tabs[index]);
+		auto modelIndex = this->index(index);
+		emit dataChanged(modelIndex, modelIndex);
+	}
+
+	/**
+	 * Inserts a tab.
+	 * @param[in] index
+	 *   The index of the new tab.
+	 * @param[in] text
+	 *   The text on the new tab.
+	 */
+	void InsertTab(int index, const QString& text)
+	{
+		beginInsertRows(QModelIndex(), index, index);
+		Tab tab;
+		tab._Text = text;
+		_Tabs.insert(index, tab);
+		endInsertRows();
+	}
+
+	/**
+	 * Moves a tab.
+	 * @param[in] from
+	 *   The index where the tab is currently located.
+	 * @param[in] to
+	 *   The new index for the tab.
+	 */
+	void MoveTab(int from, int to)
+	{
+		// The destination is the row the tab goes before, which is one further when moving down.
+		if (!beginMoveRows(QModelIndex(), from, from, QModelIndex(), to > from ? to + 1 : to)) return;
+		_Tabs.move(from, to);
+		endMoveRows();
+	}
+
+	/**
+	 * Removes a tab.
+	 * @param[in] index
+	 *   The index of the tab to remove.
+	 */
+	void RemoveTab(int index)
+	{
+		beginRemoveRows(QModelIndex(), index, index);
+		_Tabs.remove(index);
+		endRemoveRows();
+	}
+
+private:
+
+	/**
+	 * The tabs.
+	 */
+	QVector<Tab> _Tabs;
+};
+
+class PVerticalTabBar::TabDelegate : public QStyledItemDelegate
+{
+public:
+
+	/**
+	 * Creates a new delegate.
+	 * @param[in] bar
+	 *   The tab bar the delegate paints.
+	 */
+	TabDelegate(PVerticalTabBar* bar):
+	QStyledItemDelegate(bar),
+	_Bar(bar)
+	{
+	}
+
+	/**
+	 * Overrides QStyledItemDelegate#paint
+	 */
+	virtual void paint(QPainter* painter, const QStyleOptionViewItem& option, 
+		const QModelIndex& index) const override
+	{
+		QStyleOptionViewItem opt(option);
+		initStyleOption(&opt, index);
+		// The list is right to left to put the scroll bar on the left, but the tabs read left to right.
+		opt.direction = Qt::LeftToRight;
+		auto style = opt.widget ? opt.widget->style() : QApplication::style();
+		style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, opt.widget);
+		if (_Bar->tabsClosable()) GetCloseIcon().paint(painter, GetCloseRect(opt.rect));
+	}
+
+	/**
+	 * Overrides QStyledItemDelegate#sizeHint
+	 */
+	virtual QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override
+	{
+		auto size = QStyledItemDelegate::sizeHint(option, index);
+		size.rwidth() += _TabMargin * 2;
+		if (_Bar->tabsClosable()) size.rwidth() += _CloseIconSize + _TabMargin;
+		size.setHeight(qMax(size.height(), _CloseIconSize + _TabMargin));
+		return size;
+	}
+
+	/**
+	 * Overrides QStyledItemDelegate#editorEvent
+	 */
+	virtual bool editorEvent(QEvent* evt, QAbstractItemModel* model, const QStyleOptionViewItem& option, 
+		const QModelIndex& index) override
+	{
+		if (_Bar->tabsClosable() && (evt->type() == QEvent::MouseButtonPress || 
+			evt->type() == QEvent::MouseButtonRelease))
+		{
+			auto mouseEvt = static_cast<QMouseEvent*>(evt);
+			if (mouseEvt->button() == Qt::LeftButton && GetCloseRect(option.rect).contains(mouseEvt->pos()))
+			{
+				// Clicking the close button shouldn't select the tab. Closing removes the row, so wait until the 
+				// view is done with the event.
+				if (evt->type() == QEvent::MouseButtonRelease)
+				{
+					QPersistentModelIndex tab(index);
+					auto bar = _Bar;
+					QTimer::singleShot(0, bar, [bar, tab]()
+					{
+						if (tab.isValid()) bar->OnTabClose(tab.row());
+					});
+				}
+				return true;
+			}
+		}
+		return QStyledItemDelegate::editorEvent(evt, model, option, index);
+	}
+
+private:
+
+	/**
+	 * The tab bar the delegate paints.
+	 */
+	PVerticalTabBar* _Bar = nullptr;
+};
+
 PVerticalTabBar::PVerticalTabBar(QWidget* parent /*= nullptr*/):
 QWidget(parent)
 {
-	_List = new QListWidget(this);
+	_List = new QListView(this);
+	_Model = new TabModel(this);
+	_List->setModel(_Model);
+	_List->setItemDelegate(new TabDelegate(this));
+	_List->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	_List->setSelectionMode(QAbstractItemView::SingleSelection);
 	setStyleSheet(_ListStylesheet);
 	_List->setFrameShape(QFrame::NoFrame);
 	_List->setFocusPolicy(Qt::NoFocus);
@@ -62,10 +349,14 @@ QWidget(parent)
 	layout->addWidget(_List);
 	layout->setContentsMargins(0, 0, 0, 0);
 	setLayout(layout);
-	connect(_List, &QListWidget::currentRowChanged, this, &PVerticalTabBar::currentChanged);
+	connect(_List->selectionModel(), &QItemSelectionModel::currentRowChanged, this, 
+		[this](const QModelIndex& current)
+	{
+		emit currentChanged(current.row());
+	});
 }
 
-QListWidget* PVerticalTabBar::GetListWidget() const
+QListView* PVerticalTabBar::GetListView() const
 {
 	return _List;
 }
@@ -77,25 +368,19 @@ int PVerticalTabBar::addTab(const QString& text)
 
 int PVerticalTabBar::count() const
 {
-	return _List->count();
+	return _Model->rowCount();
 }
 
 int PVerticalTabBar::currentIndex() const
 {
-	return _List->currentRow();
+	return _List->currentIndex().row();
 }
 
 int PVerticalTabBar::insertTab(int index, const QString& text)
 {
 	if (index >= 0 && index <= count())
 	{
-		auto itemWidget = new PVerticalTabBarWidget();
-		itemWidget->SetText(text);
-		itemWidget->SetClosable(_TabsClosable);
-		auto item = new QListWidgetItem();
-		_List->insertItem(index, item);
-		_List->setItemWidget(item, itemWidget);
-		connect(itemWidget, &PVerticalTabBarWidget::Closed, this, &PVerticalTabBar::OnTabClose);
+		_Model->InsertTab(index, text);
 		_List->setMinimumSize(_List->sizeHint());
 		UpdateMinimumSize();
 	}
@@ -105,138 +390,93 @@ int PVerticalTabBar::insertTab(int index, const QString& text)
 
 bool PVerticalTabBar::isTabEnabled(int index) const
 {
-	auto item = _List->item(index);
-	if (item) return item->flags().testFlag(Qt::ItemIsEnabled);
-	return false;
+	auto tab = _Model->GetTab(index);
+	return tab && tab->_Enabled;
 }
 
 void PVerticalTabBar::moveTab(int from, int to)
 {
-	if (from == to) return;
-	auto text = tabText(from);
-	auto color = tabTextColor(from);
-	auto item = _List->takeItem(from);
-	if (item)
-	{
-		auto itemWidget = new PVerticalTabBarWidget();
-		itemWidget->SetText(text);
-		itemWidget->SetTextColor(color);
-		itemWidget->SetClosable(_TabsClosable);
-		_List->insertItem(to, item);
-		_List->setItemWidget(item, itemWidget);
-		connect(itemWidget, &PVerticalTabBarWidget::Closed, this, &PVerticalTabBar::OnTabClose);
-	}
+	if (from == to || !_Model->GetTab(from) || !_Model->GetTab(to)) return;
+	// This is a row move in the model, so the view only repaints; nothing is recreated.
+	_Model->MoveTab(from, to);
+	emit tabMoved(from, to);
 }
 
 void PVerticalTabBar::removeTab(int index)
 {
-	auto item = _List->takeItem(index);
-	if (item) delete item;
+	if (!_Model->GetTab(index)) return;
+	_Model->RemoveTab(index);
 	UpdateMinimumSize();
 }
 
 void PVerticalTabBar::setTabData(int index, const QVariant& data)
 {
-	auto item = _List->item(index);
-	if (item) item->setData(Qt::UserRole, data);
+	_Model->ChangeTab(index, [&data](TabModel::Tab& tab) { tab._Data = data; });
 }
 
 void PVerticalTabBar::setTabEnabled(int index, bool state)
 {
-	auto item = _List->item(index);
-	if (item) item->setFlags(item->flags() | Qt::ItemIsEnabled);
+	_Model->ChangeTab(index, [state](TabModel::Tab& tab) { tab._Enabled = state; });
 }
 
 void PVerticalTabBar::setTabText(int index, const QString& text)
 {
-	auto item = _List->item(index);
-	if (item)
-	{
-		auto widget = qobject_cast<PVerticalTabBarWidget*>(_List->itemWidget(item));
-		if (widget) widget->SetText(text);
-		setMinimumWidth(_List->sizeHintForColumn(0) + 16);
-	}
+	_Model->ChangeTab(index, [&text](TabModel::Tab& tab) { tab._Text = text; });
+	UpdateMinimumSize();
 }
 
 void PVerticalTabBar::setTabTextColor(int index, const QColor& color)
 {
-	auto item = _List->item(index);
-	if (item)
-	{
-		auto widget = qobject_cast<PVerticalTabBarWidget*>(_List->itemWidget(item));
-		if (widget) widget->SetTextColor(color);
-	}
+	_Model->ChangeTab(index, [&color](TabModel::Tab& tab) { tab._TextColor = color; });
 }
 
 void PVerticalTabBar::setTabToolTip(int index, const QString& toolTip)
 {
-	auto item = _List->item(index);
-	if (item) item->setToolTip(toolTip);
+	_Model->ChangeTab(index, [&toolTip](TabModel::Tab& tab) { tab._ToolTip = toolTip; });
 }
 
 void PVerticalTabBar::setTabsClosable(bool state)
 {
 	if (_TabsClosable == state) return;
 	_TabsClosable = state;
-	int numTabs = count();
-	for (int t = 0; t < numTabs; ++t)
-	{
-		auto item = _List->item(t);
-		if (!item) continue;
-		auto widget = qobject_cast<PVerticalTabBarWidget*>(_List->itemWidget(item));
-		if (!widget) continue;
-		widget->SetClosable(state);
-	}
+	// The size of the tabs depends on whether they have a close button.
+	_List->doItemsLayout();
+	UpdateMinimumSize();
 }
 
 int PVerticalTabBar::tabAt(const QPoint& pos) const
 {
-	auto item = _List->itemAt(pos);
-	if (item) return _List->row(item);
-	return -1;
+	return _List->indexAt(pos).row();
 }
 
 QVariant PVerticalTabBar::tabData(int index) const
 {
-	auto item = _List->item(index);
-	if (item) return item->data(Qt::UserRole);
-	return QVariant();
+	auto tab = _Model->GetTab(index);
+	return tab ? tab->_Data : QVariant();
 }
 
 QRect PVerticalTabBar::tabRect(int index) const
 {
-	auto item = _List->item(index);
-	if (item) return _List->visualItemRect(item);
-	return QRect();
+	if (!_Model->GetTab(index)) return QRect();
+	return _List->visualRect(_Model->index(index));
 }
 
 QString PVerticalTabBar::tabText(int index) const
 {
-	auto item = _List->item(index);
-	if (item)
-	{
-		auto widget = qobject_cast<PVerticalTabBarWidget*>(_List->itemWidget(item));
-		if (widget) return widget->GetText();
-	}
-	return QString();
+	auto tab = _Model->GetTab(index);
+	return tab ? tab->_Text : QString();
 }
 
 QColor PVerticalTabBar::tabTextColor(int index) const
 {
-	auto item = _List->item(index);
-	if (item)
-	{
-		auto widget = qobject_cast<PVerticalTabBarWidget*>(_List->itemWidget(item));
-		if (widget) widget->GetTextColor();
-	}
-	return QColor();
+	auto tab = _Model->GetTab(index);
+	return tab ? tab->_TextColor : QColor();
 }
 
 QString PVerticalTabBar::tabToolTip(int index) const
 {
-	auto item = _List->item(index);
-	if (item) return item->toolTip();
-	return QString();
+	auto tab = _Model->GetTab(index);
+	return tab ? tab->_ToolTip : QString();
 }
 
 bool PVerticalTabBar::tabsClosable() const
@@ -246,7 +486,7 @@ bool PVerticalTabBar::tabsClosable() const
 
 void PVerticalTabBar::setCurrentIndex(int index)
 {
-	_List->setCurrentRow(index);
+	_List->setCurrentIndex(_Model->index(index));
 }
 
 void PVerticalTabBar::resizeEvent(QResizeEvent* event)
@@ -255,20 +495,10 @@ void PVerticalTabBar::resizeEvent(QResizeEvent* event)
 	QWidget::resizeEvent(event);
 }
 
-void PVerticalTabBar::OnTabClose()
+void PVerticalTabBar::OnTabClose(int index)
 {
-	auto tab = sender();
-	int numTabs = count();
-	for (int t = 0; t < numTabs; ++t)
-	{
-		auto item = _List->item(t);
-		if (item && _List->itemWidget(item) == tab)
-		{
-			emit tabCloseRequested(t);
-			removeTab(t);
-			return;
-		}
-	}
+	emit tabCloseRequested(index);
+	removeTab(index);
 }
 
 void PVerticalTabBar::UpdateMinimumSize()
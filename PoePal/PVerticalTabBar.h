@@ -17,7 +17,7 @@
 
 #include <QWidget>
 
-class QListWidget;
+class QListView;
 
 /**
  * The tab bar for vertical tab widgets.
@@ -54,11 +54,11 @@ public:
 	PVerticalTabBar(QWidget* parent = nullptr);
 
 	/**
-	 * Retrieves the list widget containing the tabs.
+	 * Retrieves the list view showing the tabs.
 	 * @return
-	 *   The list widget containing the tabs.
+	 *   The list view showing the tabs.
 	 */
-	QListWidget* GetListWidget() const;
+	QListView* GetListView() const;
 
 	/**
 	 * Adds a tab to the tab bar.
@@ -276,21 +276,40 @@ protected:
 private slots:
 
 	/**
-	 * Slot called when a close button is clicked.
+	 * Slot called when the close button of a tab is clicked.
+	 * @param[in] index
+	 *   The index of the tab to close.
 	 */
-	void OnTabClose();
+	void OnTabClose(int index);
 
 private:
 
+	/**
+	 * The model holding the tabs.
+	 */
+	class TabModel;
+
+	/**
+	 * The delegate painting the tabs.
+	 */
+	class TabDelegate;
+
 	/**
 	 * Updates the minimum size to account for tab length.
 	 */
 	void UpdateMinimumSize();
 
 	/**
-	 * The list widget providing the contents of the tabs.
+	 * The list view showing the tabs.
+	 * The tabs are painted by a delegate rather than being widgets, so adding or moving a tab only changes the
+	 * model.
+	 */
+	QListView* _List = nullptr;
+
+	/**
+	 * The model holding the tabs.
 	 */
-	QListWidget* _List = nullptr;
+	TabModel* _Model = nullptr;
 
 	/**
 	 * Indicates whether tabs are closable.
@@ -14,7 +14,6 @@
  * <https://www.gnu.org/licenses/>.
  */
 #include "PVerticalTabWidget.h"
-#include "PVerticalTabBarWidget.h"
 
 PVerticalTabWidget::PVerticalTabWidget(QWidget* parent /*= nullptr*/):
 QWidget(parent)
@@ -23,6 +22,7 @@ QWidget(parent)
 	connect(_TabBar, &PVerticalTabBar::currentChanged, _Pages, &QStackedWidget::setCurrentIndex);
 	connect(_Pages, &QStackedWidget::currentChanged, this, &PVerticalTabWidget::currentChanged);
 	connect(_TabBar, &PVerticalTabBar::tabCloseRequested, this, &PVerticalTabWidget::OnTabClosed);
+	connect(_TabBar, &PVerticalTabBar::tabMoved, this, &PVerticalTabWidget::OnTabMoved);
 }
 
 int PVerticalTabWidget::addTab(QWidget* page, const QString& label)
@@ -103,3 +103,14 @@ void PVerticalTabWidget::OnTabClosed(int index)
 	auto widget = _Pages->widget(index);
 	if (widget) _Pages->removeWidget(widget);
 }
+
+void PVerticalTabWidget::OnTabMoved(int from, int to)
+{
+	auto page = _Pages->widget(from);
+	if (!page) return;
+	// The current tab follows the move in the tab bar, so only the page has to be put back in sync.
+	QSignalBlocker blocker(_Pages);
+	_Pages->removeWidget(page);
+	_Pages->insertWidget(to, page);
+	_Pages->setCurrentIndex(_TabBar->currentIndex());
+}
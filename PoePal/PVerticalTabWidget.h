@@ -187,4 +187,13 @@ private slots:
 	 */
 	void OnTabClosed(int index);
 
+	/**
+	 * Slot called when a tab is moved in the tab bar.
+	 * @param[in] from
+	 *   The original index of the tab.
+	 * @param[in] to
+	 *   The new index of the tab.
+	 */
+	void OnTabMoved(int from, int to);
+
 };
\ No newline at end of file
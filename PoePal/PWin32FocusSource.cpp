@@ -0,0 +1,88 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PWin32FocusSource.h"
+#include <QDebug>
+#include "windows.h"
+
+namespace
+{
+	/**
+	 * The class of the game's main window.
+	 */
+	const wchar_t *_GameWindowClass = L"POEWindowClass";
+
+	/**
+	 * The started focus source. Event hooks carry no user data, so the callback finds it here.
+	 */
+	PWin32FocusSource *_Instance = nullptr;
+
+	/**
+	 * Called by the system when another window comes to the foreground.
+	 */
+	void CALLBACK OnWinEvent(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG idObject, LONG idChild, 
+		DWORD idEventThread, DWORD time)
+	{
+		Q_UNUSED(hook);
+		Q_UNUSED(idChild);
+		Q_UNUSED(idEventThread);
+		Q_UNUSED(time);
+		if (event != EVENT_SYSTEM_FOREGROUND || idObject != OBJID_WINDOW || !_Instance) return;
+		_Instance->Update(reinterpret_cast<WId>(hwnd));
+	}
+}
+
+PWin32FocusSource::PWin32FocusSource(QObject *parent):
+PFocusSource(parent)
+{
+}
+
+PWin32FocusSource::~PWin32FocusSource()
+{
+	if (_Hook) UnhookWinEvent(static_cast<HWINEVENTHOOK>(_Hook));
+	if (_Instance == this) _Instance = nullptr;
+}
+
+void PWin32FocusSource::Start()
+{
+	if (_Hook) return;
+	Q_ASSERT(!_Instance);
+	_Instance = this;
+	_Hook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, nullptr, OnWinEvent, 0, 0, 
+		WINEVENT_OUTOFCONTEXT);
+	if (!_Hook) qWarning("Could not install the foreground event hook.");
+	Update(reinterpret_cast<WId>(::GetForegroundWindow()));
+}
+
+void PWin32FocusSource::Update(WId window)
+{
+	auto hwnd = reinterpret_cast<HWND>(window);
+	DWORD processId = 0;
+	if (hwnd) GetWindowThreadProcessId(hwnd, &processId);
+	bool game = false;
+	if (processId != 0 && processId == _GameProcessId) game = true;
+	else if (hwnd)
+	{
+		// Only windows from processes other than the known game process need their class checked. This also
+		// picks up a restarted game.
+		wchar_t className[32];
+		if (GetClassNameW(hwnd, className, 32) > 0 && wcscmp(className, _GameWindowClass) == 0)
+		{
+			_GameProcessId = processId;
+			game = true;
+		}
+	}
+	SetForeground(window, processId, game);
+}
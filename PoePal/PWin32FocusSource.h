@@ -0,0 +1,67 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "PFocusSource.h"
+
+/**
+ * Reports foreground changes from the system's foreground events.
+ * The hook is an out-of-context one, so the events arrive through the GUI thread's message loop and are reported
+ * in the same event loop iteration. The game is recognized by the class of its main window, and its process ID is
+ * remembered after that so later changes only compare IDs.
+ */
+class PWin32FocusSource : public PFocusSource
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * Creates a new focus source. Only one can be started at a time.
+	 * @param[in] parent
+	 *   The parent of the focus source.
+	 */
+	PWin32FocusSource(QObject *parent = nullptr);
+
+	/**
+	 * Destructor removes the hook.
+	 */
+	virtual ~PWin32FocusSource();
+
+	/**
+	 * Installs the foreground event hook and reports the current foreground window.
+	 */
+	virtual void Start() override;
+
+	/**
+	 * Looks up the window and reports it as the new foreground window. This is called from the hook.
+	 * @param[in] window
+	 *   The native handle of the window.
+	 */
+	void Update(WId window);
+
+private:
+
+	/**
+	 * The installed hook, as a HWINEVENTHOOK.
+	 */
+	void *_Hook = nullptr;
+
+	/**
+	 * The ID of the game's process, or 0 if it hasn't been seen yet.
+	 */
+	qint64 _GameProcessId = 0;
+};
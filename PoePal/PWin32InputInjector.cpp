@@ -0,0 +1,120 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PWin32InputInjector.h"
+#include <QApplication>
+#include <QClipboard>
+#include <QDebug>
+#include <QMimeData>
+#include <QVarLengthArray>
+#include "windows.h"
+
+namespace
+{
+	/**
+	 * Retrieves the virtual key code of a key in the keystroke script.
+	 */
+	WORD GetVirtualKey(PInputInjector::Key key)
+	{
+		switch (key)
+		{
+		case PInputInjector::Return: return VK_RETURN;
+		case PInputInjector::Control: return VK_CONTROL;
+		case PInputInjector::Backspace: return VK_BACK;
+		case PInputInjector::A: return 'A';
+		case PInputInjector::V: return 'V';
+		}
+		return 0;
+	}
+}
+
+PWin32InputInjector::PWin32InputInjector()
+{
+}
+
+PWin32InputInjector::~PWin32InputInjector()
+{
+	delete _SavedClipboard;
+}
+
+bool PWin32InputInjector::SendChatLine(const QString &text)
+{
+	auto hwnd = FindWindow(NULL, L"Path of Exile");
+	if (!hwnd)
+	{
+		qWarning() << "Sending chat message, Path of Exile window not found";
+		return false;
+	}
+	// Only remember the window to go back to at the start of a burst. Later lines find the game already active.
+	auto thisWin = GetActiveWindow();
+	if (thisWin && thisWin != hwnd) _PreviousWindow = thisWin;
+	auto clipboard = QApplication::clipboard();
+	if (!_ClipboardSaved)
+	{
+		// Copy every format, since the clipboard's own data goes away as soon as the line is put on it.
+		auto current = clipboard->mimeData();
+		if (current && !current->formats().isEmpty())
+		{
+			_SavedClipboard = new QMimeData;
+			for (const auto &format : current->formats()) _SavedClipboard->setData(format, current->data(format));
+		}
+		_ClipboardSaved = true;
+	}
+	clipboard->setText(text);
+	auto threadId = GetWindowThreadProcessId(hwnd, nullptr);
+	auto currThread = GetCurrentThreadId();
+	AttachThreadInput(currThread, threadId, TRUE);
+	SetFocus(hwnd);
+	SetForegroundWindow(hwnd);
+	SetActiveWindow(hwnd);
+	const auto &script = GetChatScript();
+	QVarLengthArray<INPUT, 16> inputs(script.length());
+	for (int k = 0; k < script.length(); ++k)
+	{
+		auto &input = inputs[k];
+		ZeroMemory(&input, sizeof(INPUT));
+		input.type = INPUT_KEYBOARD;
+		input.ki.wVk = GetVirtualKey(script.at(k)._Key);
+		input.ki.dwFlags = script.at(k)._Release ? KEYEVENTF_KEYUP : 0;
+	}
+	auto sent = SendInput(static_cast<UINT>(inputs.size()), inputs.data(), sizeof(INPUT));
+	AttachThreadInput(currThread, threadId, FALSE);
+	if (sent != static_cast<UINT>(inputs.size()))
+	{
+		qWarning() << "Sending chat message, input was blocked after" << sent << "keystrokes";
+		return false;
+	}
+	return true;
+}
+
+void PWin32InputInjector::EndBurst(bool restoreFocus)
+{
+	if (_ClipboardSaved)
+	{
+		// The clipboard takes ownership of the saved data.
+		if (_SavedClipboard) QApplication::clipboard()->setMimeData(_SavedClipboard);
+		else QApplication::clipboard()->clear();
+		_SavedClipboard = nullptr;
+		_ClipboardSaved = false;
+	}
+	if (restoreFocus && _PreviousWindow)
+	{
+		auto thisWin = static_cast<HWND>(_PreviousWindow);
+		SetFocus(thisWin);
+		SetForegroundWindow(thisWin);
+		SetActiveWindow(thisWin);
+	}
+	_PreviousWindow = nullptr;
+}
@@ -0,0 +1,75 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "PInputInjector.h"
+
+class QMimeData;
+
+/**
+ * Sends chat lines to the game window with simulated keyboard input.
+ * The whole keystroke script is submitted in one SendInput call, so nothing else can slip input in between the
+ * keys. The line is pasted through the clipboard; what the user had on the clipboard is put back at the end of the
+ * burst.
+ */
+class PWin32InputInjector : public PInputInjector
+{
+public:
+
+	/**
+	 * Creates a new injector.
+	 */
+	PWin32InputInjector();
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~PWin32InputInjector();
+
+	/**
+	 * Types a line into the game's chat box and submits it.
+	 * @param[in] text
+	 *   The complete line, including any channel prefix.
+	 * @return
+	 *   true if the line was sent, false if the game window wasn't found or the input was blocked.
+	 */
+	virtual bool SendChatLine(const QString &text) override;
+
+	/**
+	 * Puts the user's clipboard back and optionally gives focus back to the previous window.
+	 * @param[in] restoreFocus
+	 *   true to give focus back to the window that had it before the first line of the burst was sent, false to
+	 *   leave the game in front.
+	 */
+	virtual void EndBurst(bool restoreFocus) override;
+
+private:
+
+	/**
+	 * The window that had focus before the game was activated, as a HWND.
+	 */
+	void *_PreviousWindow = nullptr;
+
+	/**
+	 * A copy of what was on the clipboard before the first line of the burst, or null if nothing was saved.
+	 */
+	QMimeData *_SavedClipboard = nullptr;
+
+	/**
+	 * Indicates whether the clipboard has been saved for the current burst.
+	 */
+	bool _ClipboardSaved = false;
+};
@@ -0,0 +1,368 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PChatBenchmark.h"
+#include "PApplication.h"
+#include "PChatView.h"
+#include "PChatWidget.h"
+#include "PLogWidget.h"
+#include "PMessageBus.h"
+#include "PMessageHandler.h"
+#include "PMessageModel.h"
+#include "PSyntheticLog.h"
+#include "PVerticalTabWidget.h"
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QRandomGenerator>
+#include <QScrollBar>
+#include <QTableView>
+#include <QtTest>
+
+namespace
+{
+	/**
+	 * The number of messages a chat widget is handed at a time, which is what a frame holds at 10000 lines a
+	 * second. This stays below the number of messages a chat widget lets wait.
+	 */
+	const int _FrameSize = 160;
+
+	/**
+	 * The number of lines a second of the replay.
+	 */
+	const int _ReplayRate = 10000;
+
+	/**
+	 * The number of messages in the history.
+	 */
+	const int _HistorySize = 1000000;
+
+	/**
+	 * Hands messages to a chat widget and displays them. A chat widget displays the messages it was handed as soon
+	 * as it is shown, so it is hidden while they go through the bus rather than waiting for its next frame.
+	 * @param[in] widget
+	 *   The chat widget. Its window must be shown.
+	 * @param[in] messages
+	 *   The messages.
+	 */
+	void Deliver(PChatWidget &widget, const QVector<PMessage *> &messages)
+	{
+		auto app = qobject_cast<PApplication *>(qApp);
+		Q_ASSERT(app);
+		auto bus = app->GetMessageHandler()->GetMessageBus();
+		for (int m = 0; m < messages.length(); m += _FrameSize)
+		{
+			widget.hide();
+			for (int i = m; i < qMin(m + _FrameSize, messages.length()); ++i) bus->Publish(messages.at(i));
+			bus->Flush();
+			widget.show();
+		}
+	}
+
+	/**
+	 * Builds lines of the synthetic log on some channels.
+	 * @param[in] channels
+	 *   The channels.
+	 * @param[in] count
+	 *   The number of lines.
+	 * @return
+	 *   The first lines of the synthetic log on the channels.
+	 */
+	QStringList MakeLines(PMessage::Channels channels, int count)
+	{
+		QStringList lines;
+		for (int i = 0; lines.length() < count; ++i)
+		{
+			auto line = PSyntheticLog::MakeLine(i);
+			QScopedPointer<PMessage> message(PMessage::FromString(line, nullptr));
+			if (message->GetSubtype() == PMessage::Chat && channels.testFlag(message->GetChannel()))
+			{
+				lines.append(line);
+			}
+		}
+		return lines;
+	}
+
+	/**
+	 * Builds whispers from trade partners that arrive in random order. The order is the same on every run.
+	 * @param[in] partners
+	 *   The number of trade partners.
+	 * @param[in] count
+	 *   The number of whispers.
+	 * @return
+	 *   The lines of the whispers.
+	 */
+	QStringList MakeWhisperLines(int partners, int count)
+	{
+		QRandomGenerator random(partners);
+		QStringList lines;
+		for (int i = 0; i < count; ++i)
+		{
+			// Every partner is heard from before any of them is picked at random.
+			int partner = i < partners ? i : random.bounded(partners);
+			lines.append(PSyntheticLog::MakeChatLine(i, PMessage::Whisper, QStringLiteral("Partner%1").arg(partner),
+				QStringLiteral("Hi, I would like to buy your Tabula Rasa listed for %1 chaos").arg(i)));
+		}
+		return lines;
+	}
+}
+
+void PChatBenchmark::initTestCase()
+{
+	QVERIFY(_Dir.isValid());
+	auto path = _Dir.filePath(QStringLiteral("history.ndjson"));
+	QVERIFY(PSyntheticLog::WriteImport(path, 0, _HistorySize));
+	auto app = qobject_cast<PApplication *>(qApp);
+	Q_ASSERT(app);
+	QCOMPARE(app->GetMessageHandler()->ImportMessages(path), qint64(_HistorySize));
+}
+
+void PChatBenchmark::BenchmarkCollapseRepeats_data()
+{
+	QTest::addColumn<bool>("collapse");
+	QTest::newRow("plain") << false;
+	QTest::newRow("collapse") << true;
+}
+
+void PChatBenchmark::BenchmarkCollapseRepeats()
+{
+	QFETCH(bool, collapse);
+	QObject store;
+	auto messages = PSyntheticLog::Parse(MakeLines(PMessage::Trade, 10000), &store);
+	QWidget window;
+	window.resize(600, 800);
+	auto chat = new PChatWidget(PMessage::Trade, &window);
+	chat->setGeometry(window.rect());
+	chat->SetCollapseRepeats(collapse);
+	window.show();
+	QVERIFY(QTest::qWaitForWindowExposed(&window));
+	auto view = chat->findChild<PChatView *>(QStringLiteral("_DisplayView"));
+	QVERIFY(view);
+	QBENCHMARK
+	{
+		Deliver(*chat, messages);
+	}
+	QVERIFY(view->GetRowCount() > 0);
+}
+
+void PChatBenchmark::BenchmarkReplayFrames()
+{
+	QStringList lines;
+	for (int i = 0; i < _ReplayRate; ++i) lines.append(PSyntheticLog::MakeLine(i));
+	QObject store;
+	auto messages = PSyntheticLog::Parse(lines, &store);
+	QWidget window;
+	auto layout = new QHBoxLayout(&window);
+	layout->addWidget(new PChatWidget(PMessage::Trade, &window));
+	layout->addWidget(new PChatWidget(PMessage::Global, &window));
+	auto custom = new PChatWidget(&window);
+	custom->SetChannels(PMessage::Trade | PMessage::Global | PMessage::Party);
+	layout->addWidget(custom);
+	layout->addWidget(new PChatWidget(PMessage::Whisper, &window));
+	window.resize(1600, 800);
+	window.show();
+	QVERIFY(QTest::qWaitForWindowExposed(&window));
+
+	auto app = qobject_cast<PApplication *>(qApp);
+	auto bus = app->GetMessageHandler()->GetMessageBus();
+	QElapsedTimer clock;
+	int published = 0;
+	// The log reader hands over whatever was written since the last drain, so publish what is due by now.
+	QTimer feed;
+	feed.setTimerType(Qt::PreciseTimer);
+	feed.setInterval(1);
+	connect(&feed, &QTimer::timeout, [&]() {
+		int due = qMin(messages.length(), static_cast<int>(clock.elapsed() * _ReplayRate / 1000));
+		while (published < due) bus->Publish(messages.at(published++));
+		bus->Flush();
+	});
+	// A timer that fires on every turn of the event loop sees how long each turn kept it busy.
+	qint64 lastTurn = 0, worstFrame = 0;
+	int slowFrames = 0;
+	QTimer turn;
+	turn.setInterval(0);
+	connect(&turn, &QTimer::timeout, [&]() {
+		auto now = clock.nsecsElapsed();
+		auto frame = now - lastTurn;
+		worstFrame = qMax(worstFrame, frame);
+		if (frame > 16000000) ++slowFrames;
+		lastTurn = now;
+	});
+	clock.start();
+	feed.start();
+	turn.start();
+	QTRY_COMPARE_WITH_TIMEOUT(published, messages.length(), 5000);
+	// Let the last frame be displayed.
+	QTest::qWait(50);
+	feed.stop();
+	turn.stop();
+	qDebug() << slowFrames << "frames took longer than 16 ms";
+	QTest::setBenchmarkResult(worstFrame / 1000000.0, QTest::WalltimeMilliseconds);
+}
+
+void PChatBenchmark::BenchmarkHistoryPage()
+{
+	PChatWidget chat(PMessage::Party);
+	chat.resize(600, 800);
+	chat.show();
+	QVERIFY(QTest::qWaitForWindowExposed(&chat));
+	auto view = chat.findChild<PChatView *>(QStringLiteral("_DisplayView"));
+	QVERIFY(view);
+	QVERIFY(view->GetRowCount() > 0);
+	// Party chat is sparse, so a page reaches far back through the store.
+	QBENCHMARK
+	{
+		emit view->ScrolledToTop();
+	}
+	QVERIFY(view->GetRowCount() > 100);
+}
+
+void PChatBenchmark::BenchmarkScrollback()
+{
+	const int scrollback = 1000;
+	QObject store;
+	auto messages = PSyntheticLog::Parse(MakeLines(PMessage::Global, 20 * scrollback), &store);
+	QWidget window;
+	window.resize(600, 800);
+	auto chat = new PChatWidget(PMessage::Global, &window);
+	chat->setGeometry(window.rect());
+	chat->SetScrollback(scrollback);
+	window.show();
+	QVERIFY(QTest::qWaitForWindowExposed(&window));
+	auto view = chat->findChild<PChatView *>(QStringLiteral("_DisplayView"));
+	QVERIFY(view);
+	view->ScrollToBottom();
+	QBENCHMARK_ONCE
+	{
+		Deliver(*chat, messages);
+	}
+	QVERIFY(view->GetRowCount() > 0);
+	QVERIFY(view->GetRowCount() <= scrollback);
+}
+
+void PChatBenchmark::BenchmarkRender_data()
+{
+	QTest::addColumn<int>("views");
+	QTest::newRow("1") << 1;
+	QTest::newRow("4") << 4;
+	QTest::newRow("12") << 12;
+}
+
+void PChatBenchmark::BenchmarkRender()
+{
+	QFETCH(int, views);
+	const int pageSize = 50;
+	// Far more messages than the views render and keep, so each page is new to them.
+	QObject store;
+	auto messages = PSyntheticLog::Parse(MakeLines(PMessage::Trade | PMessage::Global, 20000), &store);
+	QWidget window;
+	auto layout = new QGridLayout(&window);
+	QVector<PChatView *> chatViews;
+	for (int v = 0; v < views; ++v)
+	{
+		auto view = new PChatView(&window);
+		layout->addWidget(view, v / 4, v % 4);
+		chatViews.append(view);
+	}
+	window.resize(1600, 900);
+	window.show();
+	QVERIFY(QTest::qWaitForWindowExposed(&window));
+	int next = 0;
+	QBENCHMARK
+	{
+		if (next + pageSize > messages.length()) next = 0;
+		for (auto view : chatViews)
+		{
+			view->Clear();
+			view->BeginBatch();
+			for (int i = next; i < next + pageSize; ++i) view->AppendMessage(messages.at(i));
+			view->EndBatch();
+			view->viewport()->repaint();
+		}
+		next += pageSize;
+	}
+	for (auto view : chatViews) QCOMPARE(view->GetRowCount(), pageSize);
+}
+
+void PChatBenchmark::BenchmarkWhisperPartners()
+{
+	const int partners = 500;
+	QObject store;
+	auto messages = PSyntheticLog::Parse(MakeWhisperLines(partners, 10 * partners), &store);
+	QWidget window;
+	window.resize(800, 800);
+	auto chat = new PChatWidget(PMessage::Whisper, &window);
+	chat->setGeometry(window.rect());
+	window.show();
+	QVERIFY(QTest::qWaitForWindowExposed(&window));
+	auto tabs = chat->findChild<PVerticalTabWidget *>(QStringLiteral("_WhisperTabs"));
+	QVERIFY(tabs);
+	QBENCHMARK_ONCE
+	{
+		Deliver(*chat, messages);
+	}
+	QVERIFY(tabs->count() >= partners);
+}
+
+void PChatBenchmark::BenchmarkWhisperReplay()
+{
+	const int partners = 2000;
+	const int viewLimit = 20;
+	QObject store;
+	auto messages = PSyntheticLog::Parse(MakeWhisperLines(partners, 25 * partners), &store);
+	QWidget window;
+	window.resize(800, 800);
+	auto chat = new PChatWidget(PMessage::Whisper, &window);
+	chat->setGeometry(window.rect());
+	chat->SetWhisperViewLimit(viewLimit);
+	window.show();
+	QVERIFY(QTest::qWaitForWindowExposed(&window));
+	auto tabs = chat->findChild<PVerticalTabWidget *>(QStringLiteral("_WhisperTabs"));
+	QVERIFY(tabs);
+	QBENCHMARK_ONCE
+	{
+		Deliver(*chat, messages);
+	}
+	QVERIFY(tabs->count() >= partners);
+	int liveViews = 0;
+	for (int t = 0; t < tabs->count(); ++t)
+	{
+		auto view = qobject_cast<PChatView *>(tabs->widget(t));
+		QVERIFY(view);
+		if (view->GetRowCount() > 0) ++liveViews;
+	}
+	QVERIFY(liveViews > 0);
+	QVERIFY(liveViews <= viewLimit);
+}
+
+void PChatBenchmark::BenchmarkLogScroll()
+{
+	auto app = qobject_cast<PApplication *>(qApp);
+	Q_ASSERT(app);
+	QVERIFY(app->GetMessageModel()->rowCount() >= _HistorySize);
+	PLogWidget log;
+	log.resize(1200, 800);
+	log.show();
+	QVERIFY(QTest::qWaitForWindowExposed(&log));
+	auto table = log.findChild<QTableView *>(QStringLiteral("_TableView"));
+	QVERIFY(table);
+	auto scrollBar = table->verticalScrollBar();
+	scrollBar->setValue(scrollBar->maximum() / 2);
+	QBENCHMARK
+	{
+		int next = scrollBar->value() + scrollBar->pageStep();
+		scrollBar->setValue(next > scrollBar->maximum() ? 0 : next);
+		table->viewport()->repaint();
+	}
+}
@@ -0,0 +1,99 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+#include <QTemporaryDir>
+
+/**
+ * Measures the chat widgets and views on messages of the synthetic log, delivered through the message bus of the
+ * application's message handler like live messages are. The history of the chat widgets is imported into the
+ * application's message handler, which is also what the log widget shows.
+ */
+class PChatBenchmark : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	/**
+	 * Imports the history into the application's message handler.
+	 */
+	void initTestCase();
+
+	/**
+	 * Provides whether repeated trade offers are collapsed.
+	 */
+	void BenchmarkCollapseRepeats_data();
+
+	/**
+	 * Measures a trade chat widget displaying trade chat where sellers keep reposting their offers.
+	 */
+	void BenchmarkCollapseRepeats();
+
+	/**
+	 * Replays the synthetic log at 10000 lines a second into a few chat widgets and reports the longest time the
+	 * event loop was busy, which is the worst frame the user sees. The number of frames over 16 ms is logged.
+	 */
+	void BenchmarkReplayFrames();
+
+	/**
+	 * Measures a chat widget loading a page of its history when the user scrolls to the top.
+	 */
+	void BenchmarkHistoryPage();
+
+	/**
+	 * Measures a chat widget displaying far more messages than its scrollback and checks that it only keeps the
+	 * scrollback. The memory of the rows can't be measured here, so their number stands in for it.
+	 */
+	void BenchmarkScrollback();
+
+	/**
+	 * Provides the number of views that show the same messages.
+	 */
+	void BenchmarkRender_data();
+
+	/**
+	 * Measures views showing a page of messages they haven't shown before. The messages are only rendered once
+	 * for all of the views, so the time should grow by less than the number of views.
+	 */
+	void BenchmarkRender();
+
+	/**
+	 * Measures a whisper chat widget receiving whispers from 500 trade partners in random order, which moves the
+	 * partner's tab to the top for almost every whisper.
+	 */
+	void BenchmarkWhisperPartners();
+
+	/**
+	 * Measures a whisper chat widget over a long replay of whispers from thousands of trade partners and checks
+	 * that it only keeps the messages of as many conversations as its limit. The memory of the conversations can't
+	 * be measured here, so the number of conversations that hold messages stands in for it.
+	 */
+	void BenchmarkWhisperReplay();
+
+	/**
+	 * Measures the log widget scrolling through the history a page at a time and painting each page.
+	 */
+	void BenchmarkLogScroll();
+
+private:
+
+	/**
+	 * The directory of the imported history.
+	 */
+	QTemporaryDir _Dir;
+};
@@ -0,0 +1,99 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PCommandQueueTest.h"
+#include "PCommandQueue.h"
+#include "PMockInputInjector.h"
+#include <QtTest>
+
+namespace
+{
+	/**
+	 * Checks whether a command went through a state.
+	 * @param[in] spy
+	 *   The spy on PCommandQueue::CommandStateChanged.
+	 * @param[in] id
+	 *   The ID of the command.
+	 * @param[in] state
+	 *   The state.
+	 * @return
+	 *   true if the command was reported in the state, false otherwise.
+	 */
+	bool HasState(const QSignalSpy &spy, int id, PCommandQueue::State state)
+	{
+		for (const auto &args : spy)
+		{
+			if (args.at(0).toInt() == id && args.at(1).value<PCommandQueue::State>() == state) return true;
+		}
+		return false;
+	}
+}
+
+void PCommandQueueTest::TestTokenBucket()
+{
+	auto injector = new PMockInputInjector;
+	PCommandQueue queue(injector);
+	const int refillInterval = 200;
+	queue.SetRateLimit(2, refillInterval);
+	for (int i = 0; i < 4; ++i) queue.Enqueue(QStringLiteral("line %1").arg(i));
+	QCOMPARE(queue.GetPendingCount(), 4);
+	QTRY_COMPARE_WITH_TIMEOUT(injector->GetLines().length(), 4, 10 * refillInterval);
+	QCOMPARE(injector->GetLines(), QStringList({"line 0", "line 1", "line 2", "line 3"}));
+	auto times = injector->GetSendTimes();
+	// The burst is only spaced by the time the game needs to read the pasted line, while the others wait for a
+	// token each. The timer may fire a little early, so allow for some slack.
+	QVERIFY(times.at(1) - times.at(0) >= 40);
+	QVERIFY(times.at(1) - times.at(0) < refillInterval / 2);
+	QVERIFY(times.at(2) - times.at(0) >= refillInterval * 3 / 4);
+	QVERIFY(times.at(3) - times.at(2) >= refillInterval * 3 / 4);
+	QCOMPARE(queue.GetPendingCount(), 0);
+}
+
+void PCommandQueueTest::TestCoalescing()
+{
+	auto injector = new PMockInputInjector;
+	PCommandQueue queue(injector);
+	QSignalSpy states(&queue, &PCommandQueue::CommandStateChanged);
+	// Nothing is sent before the event loop runs, so all of these are still queued when the next one comes.
+	auto first = queue.Enqueue(QStringLiteral("/afk first"), QStringLiteral("afk"));
+	queue.Enqueue(QStringLiteral("hello"));
+	queue.Enqueue(QStringLiteral("hello"));
+	auto last = queue.Enqueue(QStringLiteral("/afk last"), QStringLiteral("afk"));
+	QCOMPARE(queue.GetPendingCount(), 3);
+	QVERIFY(HasState(states, first, PCommandQueue::Dropped));
+	QTRY_COMPARE(injector->GetLines().length(), 3);
+	QCOMPARE(injector->GetLines(), QStringList({"hello", "hello", "/afk last"}));
+	QVERIFY(HasState(states, last, PCommandQueue::Sent));
+}
+
+void PCommandQueueTest::TestFailureAndFocus()
+{
+	auto injector = new PMockInputInjector;
+	PCommandQueue queue(injector);
+	QSignalSpy failed(&queue, &PCommandQueue::CommandFailed);
+	injector->SetGameAvailable(false);
+	auto id = queue.Enqueue(QStringLiteral("lost"));
+	QTRY_COMPARE(failed.count(), 1);
+	QCOMPARE(failed.at(0).at(0).toInt(), id);
+	QTRY_COMPARE(injector->GetBurstCount(), 1);
+	QCOMPARE(injector->GetFocusRestoreCount(), 0);
+	injector->SetGameAvailable(true);
+	injector->Clear();
+	queue.Enqueue(QStringLiteral("one"));
+	queue.Enqueue(QStringLiteral("two"));
+	QTRY_COMPARE(injector->GetBurstCount(), 1);
+	QCOMPARE(injector->GetLines().length(), 2);
+	QCOMPARE(injector->GetFocusRestoreCount(), 1);
+}
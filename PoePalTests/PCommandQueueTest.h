@@ -0,0 +1,46 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+
+/**
+ * Tests the rate limit and coalescing of the outbound command queue against a mock injector.
+ */
+class PCommandQueueTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	/**
+	 * Checks that a burst goes out right away and that the rest of the lines follow at the refill rate, in
+	 * order.
+	 */
+	void TestTokenBucket();
+
+	/**
+	 * Checks that a queued line is replaced by a later line with the same key and that lines without a key are
+	 * kept.
+	 */
+	void TestCoalescing();
+
+	/**
+	 * Checks that a line the game can't take is reported as failed and that focus is only restored once per
+	 * burst.
+	 */
+	void TestFailureAndFocus();
+};
@@ -0,0 +1,80 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PCommandScriptTest.h"
+#include "PCommandQueue.h"
+#include "PMessageHandler.h"
+#include "PMockInputInjector.h"
+#include <QQmlEngine>
+#include <QtTest>
+
+namespace
+{
+	/**
+	 * Registers the enumerations of a class with a script engine as <class>.<value>, the way the application does.
+	 * @param[in] engine
+	 *   The script engine.
+	 */
+	template <class T>
+	void RegisterEnums(QJSEngine &engine)
+	{
+		auto classObj = engine.newObject();
+		for (int e = 0; e < T::staticMetaObject.enumeratorCount(); ++e)
+		{
+			auto metaEnum = T::staticMetaObject.enumerator(e);
+			for (int k = 0; k < metaEnum.keyCount(); ++k) classObj.setProperty(metaEnum.key(k), metaEnum.value(k));
+		}
+		engine.globalObject().setProperty(T::staticMetaObject.className(), classObj);
+	}
+}
+
+void PCommandScriptTest::TestScript()
+{
+	PMessageHandler handler;
+	auto injector = new PMockInputInjector;
+	auto queue = handler.GetCommandQueue();
+	queue->SetInjector(injector);
+	queue->SetRateLimit(10, 100);
+	QJSEngine engine;
+	QQmlEngine::setObjectOwnership(&handler, QQmlEngine::CppOwnership);
+	engine.globalObject().setProperty(QStringLiteral("handler"), engine.newQObject(&handler));
+	RegisterEnums<PMessage>(engine);
+	RegisterEnums<PMessageHandler>(engine);
+
+	// The status is set twice before the queue runs, so only the last one is sent.
+	auto result = engine.evaluate(QStringLiteral(
+		"handler.SendChatMessage(PMessage.Whisper, 'hi there', 'Bob');\n"
+		"handler.SendChatMessage(PMessage.Party, 'omw');\n"
+		"handler.SendAction(PMessageHandler.Passives);\n"
+		"handler.SendAction(PMessageHandler.Status, 'brb');\n"
+		"handler.SendAction(PMessageHandler.Status, 'back in 5');\n"));
+	QVERIFY2(!result.isError(), qPrintable(result.toString()));
+	QTRY_COMPARE(injector->GetLines().length(), 4);
+	QCOMPARE(injector->GetLines(), QStringList({"@Bob hi there", "%omw", "/passives", "/status back in 5"}));
+
+	// Every line is played as the same keystroke script.
+	PInputInjector::Script expected;
+	for (int l = 0; l < 4; ++l) expected += PInputInjector::GetChatScript();
+	auto strokes = injector->GetKeyStrokes();
+	QCOMPARE(strokes.length(), expected.length());
+	for (int s = 0; s < strokes.length(); ++s)
+	{
+		QCOMPARE(strokes.at(s)._Key, expected.at(s)._Key);
+		QCOMPARE(strokes.at(s)._Release, expected.at(s)._Release);
+	}
+	QTRY_COMPARE(injector->GetBurstCount(), 1);
+	QCOMPARE(injector->GetFocusRestoreCount(), 1);
+	QCOMPARE(queue->GetPendingCount(), 0);
+}
@@ -0,0 +1,35 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+
+/**
+ * Tests the chat lines and keystrokes a script produces through the message handler, with the mock injector in
+ * place of the game.
+ */
+class PCommandScriptTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	/**
+	 * Runs a script that sends chat messages and actions, and checks the lines the injector received, that each
+	 * line was played as the chat keystroke script, and that focus was given back after the burst.
+	 */
+	void TestScript();
+};
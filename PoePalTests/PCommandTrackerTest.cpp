@@ -0,0 +1,110 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PCommandTrackerTest.h"
+#include "PCommandQueue.h"
+#include "PCommandTracker.h"
+#include "PMessageBus.h"
+#include "PMockInputInjector.h"
+#include <QtTest>
+#include <numeric>
+
+namespace
+{
+	/**
+	 * Replays client log lines the way the log reader hands them over: each line is parsed, published on the
+	 * bus, and the batch is delivered at the end.
+	 * @param[in] bus
+	 *   The bus to publish the messages on.
+	 * @param[in] lines
+	 *   The contents of the log lines, without the time and client prefix.
+	 * @param[in] parent
+	 *   The object owning the parsed messages.
+	 * @return
+	 *   true if every line was parsed, false otherwise.
+	 */
+	bool Replay(PMessageBus &bus, const QStringList &lines, QObject *parent)
+	{
+		auto time = QDateTime::currentDateTime().toString(QStringLiteral("yyyy/MM/dd HH:mm:ss"));
+		for (const auto &line : lines)
+		{
+			auto message = PMessage::FromString(
+				QStringLiteral("%1 123456 abc [INFO Client 1234] %2").arg(time, line), parent);
+			if (!message) return false;
+			bus.Publish(message);
+		}
+		bus.Flush();
+		return true;
+	}
+}
+
+void PCommandTrackerTest::TestEchoes()
+{
+	auto injector = new PMockInputInjector;
+	PCommandQueue queue(injector);
+	queue.SetRateLimit(10, 100);
+	PMessageBus bus;
+	PCommandTracker tracker(&queue, &bus);
+	queue.Enqueue(QStringLiteral("@Bob hi there"));
+	queue.Enqueue(QStringLiteral("/hideout"));
+	queue.Enqueue(QStringLiteral("/passives"));
+	queue.Enqueue(QStringLiteral("/kick Bob"));
+	QTRY_COMPARE(injector->GetLines().length(), 4);
+	QCOMPARE(tracker.GetInFlightCount(), 3);
+	QCOMPARE(tracker.GetStatistics("kick")._Unconfirmed, 1);
+
+	// Lines that only look like the echoes confirm nothing.
+	QObject messages;
+	QVERIFY(Replay(bus, {
+		QStringLiteral("@From Bob: hi there"),
+		QStringLiteral("@To Alice: hi there"),
+		QStringLiteral(": You have entered Lioneye's Watch."),
+		QStringLiteral(": 8 total Ascendancy Skill Points (6 allocated)")
+	}, &messages));
+	QCOMPARE(tracker.GetInFlightCount(), 3);
+
+	QVERIFY(Replay(bus, {
+		QStringLiteral("@To Bob: hi there"),
+		QStringLiteral(": You have entered Celestial Hideout."),
+		QStringLiteral(": 95 total Passive Skill Points (93 allocated)")
+	}, &messages));
+	QCOMPARE(tracker.GetInFlightCount(), 0);
+	QCOMPARE(tracker.GetCommandTypes(), QStringList({"hideout", "kick", "passives", "whisper"}));
+	for (const auto &type : {"hideout", "passives", "whisper"})
+	{
+		auto stats = tracker.GetStatistics(type);
+		QCOMPARE(stats._Confirmed, 1);
+		QCOMPARE(stats._Unconfirmed, 0);
+		QCOMPARE(std::accumulate(stats._Buckets.begin(), stats._Buckets.end(), 0), 1);
+		QVERIFY(stats._Min <= stats._Max);
+	}
+}
+
+void PCommandTrackerTest::TestFailures()
+{
+	auto injector = new PMockInputInjector;
+	PCommandQueue queue(injector);
+	PMessageBus bus;
+	PCommandTracker tracker(&queue, &bus);
+	QSignalSpy failed(&queue, &PCommandQueue::CommandFailed);
+	injector->SetGameAvailable(false);
+	queue.Enqueue(QStringLiteral("/hideout"));
+	queue.Enqueue(QStringLiteral("#hello"));
+	QTRY_COMPARE(failed.count(), 2);
+	QCOMPARE(tracker.GetInFlightCount(), 0);
+	QCOMPARE(tracker.GetStatistics("hideout")._Failed, 1);
+	QCOMPARE(tracker.GetStatistics("chat")._Failed, 1);
+	QCOMPARE(tracker.GetStatistics("chat")._Confirmed, 0);
+}
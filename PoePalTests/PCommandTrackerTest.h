@@ -0,0 +1,39 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+
+/**
+ * Tests matching the commands sent through the command queue with their echo in a replayed client log.
+ */
+class PCommandTrackerTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	/**
+	 * Checks that whispers and commands are confirmed by their own echo and not by other lines, including the
+	 * summary printed for /passives, and that commands without a notice are counted as unconfirmed.
+	 */
+	void TestEchoes();
+
+	/**
+	 * Checks that lines that couldn't be sent to the game are counted as failures and never wait for an echo.
+	 */
+	void TestFailures();
+};
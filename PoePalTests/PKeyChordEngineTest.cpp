@@ -0,0 +1,117 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PKeyChordEngineTest.h"
+#include "PGlobalKeyBind.h"
+#include "PGlobalKeyBindManager.h"
+#include "PKeyChordEngine.h"
+#include <QtTest>
+
+namespace
+{
+	/**
+	 * Parses a single stroke.
+	 * @param[in] text
+	 *   The stroke, such as "Ctrl+K".
+	 * @return
+	 *   The key code and modifiers of the stroke.
+	 */
+	int Stroke(const QString &text)
+	{
+		return PKeyChordEngine::ParseSequence(text)[0];
+	}
+}
+
+void PKeyChordEngineTest::TestSequences()
+{
+	PKeyChordEngine engine(nullptr);
+	QSignalSpy triggered(&engine, &PKeyChordEngine::Triggered);
+	engine.SetBinding("short", PKeyChordEngine::ParseSequence("Ctrl+K"), PGlobalKeyBind::Anywhere);
+	engine.SetBinding("long", PKeyChordEngine::ParseSequence("Ctrl+K, H"), PGlobalKeyBind::Anywhere);
+	engine.SetBinding("other", PKeyChordEngine::ParseSequence("Ctrl+J"), PGlobalKeyBind::Anywhere);
+	QVERIFY(engine.GetExpectedStrokes().contains(Stroke("Ctrl+K")));
+	QVERIFY(!engine.GetExpectedStrokes().contains(Stroke("H")));
+
+	QCOMPARE(engine.Feed(Stroke("Ctrl+K")), PKeyChordEngine::Pending);
+	QVERIFY(engine.IsPending());
+	QVERIFY(engine.GetExpectedStrokes().contains(Stroke("H")));
+	QCOMPARE(triggered.count(), 0);
+	QCOMPARE(engine.Feed(Stroke("H")), PKeyChordEngine::Matched);
+	QCOMPARE(triggered.count(), 1);
+	QCOMPARE(triggered.takeFirst().at(0).toByteArray(), QByteArray("long"));
+
+	// Another key bind's stroke first finishes the shorter key bind, then matches itself.
+	QCOMPARE(engine.Feed(Stroke("Ctrl+K")), PKeyChordEngine::Pending);
+	QCOMPARE(engine.Feed(Stroke("Ctrl+J")), PKeyChordEngine::Matched);
+	QCOMPARE(triggered.count(), 2);
+	QCOMPARE(triggered.at(0).at(0).toByteArray(), QByteArray("short"));
+	QCOMPARE(triggered.at(1).at(0).toByteArray(), QByteArray("other"));
+	triggered.clear();
+
+	// A stroke that isn't bound still finishes the shorter key bind.
+	QCOMPARE(engine.Feed(Stroke("Ctrl+K")), PKeyChordEngine::Pending);
+	QCOMPARE(engine.Feed(Stroke("Ctrl+Q")), PKeyChordEngine::Unmatched);
+	QCOMPARE(triggered.count(), 1);
+	QCOMPARE(triggered.at(0).at(0).toByteArray(), QByteArray("short"));
+	QVERIFY(!engine.IsPending());
+}
+
+void PKeyChordEngineTest::TestTimeout()
+{
+	PKeyChordEngine engine(nullptr);
+	engine.SetTimeout(50);
+	QSignalSpy triggered(&engine, &PKeyChordEngine::Triggered);
+	engine.SetBinding("short", PKeyChordEngine::ParseSequence("Ctrl+K"), PGlobalKeyBind::Anywhere);
+	engine.SetBinding("long", PKeyChordEngine::ParseSequence("Ctrl+K, H"), PGlobalKeyBind::Anywhere);
+	QCOMPARE(engine.Feed(Stroke("Ctrl+K")), PKeyChordEngine::Pending);
+	QTRY_COMPARE(triggered.count(), 1);
+	QCOMPARE(triggered.at(0).at(0).toByteArray(), QByteArray("short"));
+	QVERIFY(!engine.IsPending());
+	// The sequence starts over after the timeout.
+	QCOMPARE(engine.Feed(Stroke("H")), PKeyChordEngine::Unmatched);
+}
+
+void PKeyChordEngineTest::TestContext()
+{
+	PKeyChordEngine engine(nullptr);
+	QSignalSpy triggered(&engine, &PKeyChordEngine::Triggered);
+	engine.SetBinding("game", PKeyChordEngine::ParseSequence("F5"), PGlobalKeyBind::GameFocused);
+	QCOMPARE(engine.Feed(Stroke("F5")), PKeyChordEngine::Unmatched);
+	QVERIFY(!engine.GetExpectedStrokes().contains(Stroke("F5")));
+	engine.SetGameFocused(true);
+	QVERIFY(engine.GetExpectedStrokes().contains(Stroke("F5")));
+	QCOMPARE(engine.Feed(Stroke("F5")), PKeyChordEngine::Matched);
+	QCOMPARE(triggered.count(), 1);
+}
+
+void PKeyChordEngineTest::TestSimulateStroke()
+{
+	// Strokes nobody uses, since the manager registers them as system hotkeys.
+	PGlobalKeyBindManager manager;
+	auto shortBind = manager.RegisterKeyBind("test.short", "Short", QString(), "Ctrl+Alt+Shift+F11");
+	auto longBind = manager.RegisterKeyBind("test.long", "Long", QString(), "Ctrl+Alt+Shift+F11, H");
+	QSignalSpy shortTriggered(shortBind, &PGlobalKeyBind::Triggered);
+	QSignalSpy longTriggered(longBind, &PGlobalKeyBind::Triggered);
+
+	QVERIFY(manager.SimulateStroke("Ctrl+Alt+Shift+F11"));
+	QVERIFY(manager.SimulateStroke("H"));
+	QCOMPARE(longTriggered.count(), 1);
+	QCOMPARE(shortTriggered.count(), 0);
+
+	QVERIFY(manager.SimulateStroke("Ctrl+Alt+Shift+F11"));
+	QVERIFY(!manager.SimulateStroke("Ctrl+Alt+Shift+F12"));
+	QCOMPARE(shortTriggered.count(), 1);
+	QCOMPARE(longTriggered.count(), 1);
+}
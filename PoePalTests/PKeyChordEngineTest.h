@@ -0,0 +1,49 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+
+/**
+ * Tests resolving strokes to key binds with the chord engine, on its own and through the key bind manager.
+ */
+class PKeyChordEngineTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	/**
+	 * Checks that a key sequence sharing its first stroke with a shorter one waits for the next stroke, and that
+	 * a stroke breaking the sequence triggers the shorter key bind before it is handled itself.
+	 */
+	void TestSequences();
+
+	/**
+	 * Checks that a pending shorter key bind is triggered when the next stroke doesn't come in time.
+	 */
+	void TestTimeout();
+
+	/**
+	 * Checks that key binds limited to the game only match while it is focused.
+	 */
+	void TestContext();
+
+	/**
+	 * Checks the same sequences through PGlobalKeyBindManager::SimulateStroke and the key binds' signals.
+	 */
+	void TestSimulateStroke();
+};
@@ -0,0 +1,296 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PMessageBenchmark.h"
+#include "PMessageBus.h"
+#include "PMessageFilterModel.h"
+#include "PMessageHandler.h"
+#include "PMessageModel.h"
+#include "PSyntheticLog.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QTableView>
+#include <QtTest>
+#include <algorithm>
+
+namespace
+{
+	/**
+	 * The number of messages in the store.
+	 */
+	const int _StoreSize = 1000000;
+
+	/**
+	 * The number of lines in a replayed batch.
+	 */
+	const int _ReplaySize = 100000;
+
+	/**
+	 * The number of messages in an appended batch.
+	 */
+	const int _AppendSize = 10000;
+
+	/**
+	 * The content filters of custom chat widgets. Most of them are keywords, which are found for all filters at
+	 * once.
+	 */
+	const QStringList _ContentFilters{
+		QStringLiteral("tabula"), QStringLiteral("item:\"Tabula Rasa\" price<10"), QStringLiteral("headhunter"),
+		QStringLiteral("\"PM me\" goldrim"), QStringLiteral("currency:chaos price>100"), QStringLiteral("map"),
+		QStringLiteral("/wts .* for \\d+ chaos/"), QStringLiteral("portal"), QStringLiteral("lifesprig"),
+		QStringLiteral("blackheart chaos"), QStringLiteral("item:wanderlust"), QStringLiteral("joined"),
+		QStringLiteral("karui"), QStringLiteral("foible"), QStringLiteral("/^gg$/"), QStringLiteral("invite"),
+		QStringLiteral("anyone map"), QStringLiteral("price>3"), QStringLiteral("wts"), QStringLiteral("hi")
+	};
+
+	/**
+	 * Creates a table on the message model with rows of the same height, like the log widget.
+	 * @param[in] model
+	 *   The message model.
+	 * @return
+	 *   The table, which is shown.
+	 */
+	QTableView * CreateTable(PMessageModel *model)
+	{
+		auto table = new QTableView;
+		table->setModel(model);
+		table->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+		table->resize(1000, 800);
+		table->show();
+		return table;
+	}
+}
+
+void PMessageBenchmark::initTestCase()
+{
+	QVERIFY(_Dir.isValid());
+	auto path = _Dir.filePath(QStringLiteral("store.ndjson"));
+	QVERIFY(PSyntheticLog::WriteImport(path, 0, _StoreSize));
+	_Handler.reset(new PMessageHandler);
+	QCOMPARE(_Handler->ImportMessages(path), qint64(_StoreSize));
+	_NextLine = _StoreSize;
+}
+
+void PMessageBenchmark::cleanupTestCase()
+{
+	_Handler.reset();
+}
+
+void PMessageBenchmark::BenchmarkChannelIndexes_data()
+{
+	QTest::addColumn<int>("channels");
+	QTest::addColumn<bool>("events");
+	QTest::newRow("party") << int(PMessage::Party) << false;
+	QTest::newRow("party+events") << int(PMessage::Party) << true;
+	QTest::newRow("whisper+events") << int(PMessage::Whisper) << true;
+	QTest::newRow("trade") << int(PMessage::Trade) << false;
+	QTest::newRow("trade+global") << int(PMessage::Trade | PMessage::Global) << false;
+	QTest::newRow("all+events") << int(PMessage::Global | PMessage::Trade | PMessage::Guild | PMessage::Party |
+		PMessage::Local | PMessage::Whisper) << true;
+}
+
+void PMessageBenchmark::BenchmarkChannelIndexes()
+{
+	QFETCH(int, channels);
+	QFETCH(bool, events);
+	auto filter = PMessage::Channels(static_cast<PMessage::Channel>(channels));
+	QVector<int> indexes;
+	QBENCHMARK
+	{
+		indexes = _Handler->GetMessageIndexes(filter, events);
+	}
+	QVERIFY(!indexes.isEmpty());
+	QVERIFY(std::is_sorted(indexes.cbegin(), indexes.cend()));
+}
+
+void PMessageBenchmark::BenchmarkSnapshotLoad()
+{
+	// This is the payload SaveSnapshot writes after the header.
+	QByteArray payload;
+	QDataStream out(&payload, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_5_12);
+	for (const auto &message : _Handler->GetLogMessages()) message->ToStream(out);
+	auto payloadHash = QCryptographicHash::hash(payload, QCryptographicHash::Md5);
+	// The messages are only released once the measurement is done, since that isn't part of starting up.
+	QScopedPointer<QObject> store(new QObject);
+	int count = 0;
+	QBENCHMARK_ONCE
+	{
+		QCOMPARE(QCryptographicHash::hash(payload, QCryptographicHash::Md5), payloadHash);
+		QDataStream in(payload);
+		in.setVersion(QDataStream::Qt_5_12);
+		while (count < _StoreSize && PMessage::FromStream(in, store.data())) ++count;
+	}
+	QCOMPARE(count, _StoreSize);
+}
+
+void PMessageBenchmark::BenchmarkReplay()
+{
+	QStringList lines;
+	for (int i = 0; i < _ReplaySize; ++i) lines.append(PSyntheticLog::MakeLine(i));
+	QBENCHMARK
+	{
+		QObject batch;
+		QCOMPARE(PSyntheticLog::Parse(lines, &batch).length(), _ReplaySize);
+	}
+}
+
+void PMessageBenchmark::BenchmarkExport_data()
+{
+	QTest::addColumn<PMessageHandler::ExportFormat>("format");
+	QTest::newRow("ndjson") << PMessageHandler::Ndjson;
+	QTest::newRow("csv") << PMessageHandler::Csv;
+}
+
+void PMessageBenchmark::BenchmarkExport()
+{
+	QFETCH(PMessageHandler::ExportFormat, format);
+	auto path = _Dir.filePath(QStringLiteral("export"));
+	qint64 count = 0;
+	QBENCHMARK
+	{
+		count = _Handler->ExportMessages(path, format);
+	}
+	QCOMPARE(count, qint64(_StoreSize));
+	qDebug() << "Exported" << QFileInfo(path).size() / (1 << 20) << "MB";
+}
+
+void PMessageBenchmark::BenchmarkModelAppend_data()
+{
+	QTest::addColumn<bool>("viewed");
+	QTest::newRow("store") << false;
+	QTest::newRow("model+view") << true;
+}
+
+void PMessageBenchmark::BenchmarkModelAppend()
+{
+	QFETCH(bool, viewed);
+	QScopedPointer<PMessageModel> model;
+	QScopedPointer<QTableView> table;
+	if (viewed)
+	{
+		model.reset(new PMessageModel(_Handler.data(), nullptr));
+		table.reset(CreateTable(model.data()));
+		QVERIFY(QTest::qWaitForWindowExposed(table.data()));
+	}
+	// Each batch is newer than the store, so it is appended rather than merged in.
+	auto path = _Dir.filePath(QStringLiteral("append.ndjson"));
+	QVERIFY(PSyntheticLog::WriteImport(path, _NextLine, _AppendSize));
+	_NextLine += _AppendSize;
+	QBENCHMARK_ONCE
+	{
+		QCOMPARE(_Handler->ImportMessages(path), qint64(_AppendSize));
+	}
+	if (viewed) QCOMPARE(model->rowCount(), _Handler->GetMessageCount());
+}
+
+void PMessageBenchmark::BenchmarkModelPaint()
+{
+	PMessageModel model(_Handler.data(), nullptr);
+	QScopedPointer<QTableView> table(CreateTable(&model));
+	QVERIFY(QTest::qWaitForWindowExposed(table.data()));
+	table->scrollTo(model.index(model.rowCount() / 2, 0), QAbstractItemView::PositionAtTop);
+	QBENCHMARK
+	{
+		table->viewport()->repaint();
+	}
+}
+
+void PMessageBenchmark::BenchmarkFilterChange_data()
+{
+	QTest::addColumn<int>("channels");
+	QTest::addColumn<QStringList>("subjects");
+	QTest::newRow("party") << int(PMessage::Party) << QStringList();
+	QTest::newRow("trade") << int(PMessage::Trade) << QStringList();
+	QTest::newRow("trade+global") << int(PMessage::Trade | PMessage::Global) << QStringList();
+	QTest::newRow("all") << int(PMessage::Global | PMessage::Trade | PMessage::Guild | PMessage::Party |
+		PMessage::Local | PMessage::Whisper) << QStringList();
+	QStringList sellers;
+	for (int s = 0; s < 10; ++s) sellers.append(QStringLiteral("Seller%1").arg(s));
+	QTest::newRow("trade+sellers") << int(PMessage::Trade) << sellers;
+}
+
+void PMessageBenchmark::BenchmarkFilterChange()
+{
+	QFETCH(int, channels);
+	QFETCH(QStringList, subjects);
+	PMessageModel model(_Handler.data(), nullptr);
+	PMessageFilterModel proxy(nullptr);
+	proxy.setSourceModel(&model);
+	proxy.SetChannels(PMessage::Channels(static_cast<PMessage::Channel>(channels)));
+	// Setting the senders finds the rows again every time, even if they are the same.
+	QBENCHMARK
+	{
+		proxy.SetSubjects(subjects);
+	}
+	QVERIFY(proxy.rowCount() > 0);
+}
+
+void PMessageBenchmark::BenchmarkContentFilters_data()
+{
+	QTest::addColumn<int>("filters");
+	for (int filters : {0, 1, 5, 10, 20}) QTest::newRow(qPrintable(QString::number(filters))) << filters;
+}
+
+void PMessageBenchmark::BenchmarkContentFilters()
+{
+	QFETCH(int, filters);
+	auto path = _Dir.filePath(QStringLiteral("filtered.ndjson"));
+	if (!QFile::exists(path)) QVERIFY(PSyntheticLog::WriteImport(path, 0, _ReplaySize));
+	PMessageHandler handler;
+	for (int f = 0; f < filters; ++f) QVERIFY(handler.AddFilter(_ContentFilters.at(f)) >= 0);
+	QBENCHMARK_ONCE
+	{
+		QCOMPARE(handler.ImportMessages(path), qint64(_ReplaySize));
+	}
+}
+
+void PMessageBenchmark::BenchmarkBusDispatch_data()
+{
+	QTest::addColumn<int>("subscribers");
+	for (int subscribers : {1, 4, 16, 64}) QTest::newRow(qPrintable(QString::number(subscribers))) << subscribers;
+}
+
+void PMessageBenchmark::BenchmarkBusDispatch()
+{
+	QFETCH(int, subscribers);
+	// The kinds of subscriptions the application makes, taken in turn.
+	QVector<PMessageBus::Subscription> kinds(4);
+	kinds[0]._Subtypes = {PMessage::Chat};
+	kinds[0]._Channels = PMessage::Trade;
+	kinds[1]._Subtypes = {PMessage::Chat};
+	kinds[1]._Channels = PMessage::Global | PMessage::Party | PMessage::Guild;
+	kinds[2]._Subtypes = {PMessage::Chat, PMessage::Event};
+	kinds[2]._Channels = PMessage::Whisper;
+	kinds[3]._Subtypes = {PMessage::Chat};
+	kinds[3]._Channels = PMessage::Trade | PMessage::Global;
+	kinds[3]._Senders = {QStringLiteral("Seller1"), QStringLiteral("Chatter2")};
+	PMessageBus bus;
+	QObject receiver;
+	qint64 delivered = 0;
+	for (int s = 0; s < subscribers; ++s)
+	{
+		bus.Subscribe(kinds.at(s % kinds.length()), &receiver, [&delivered](PMessage *) { ++delivered; });
+	}
+	auto messages = _Handler->GetLogMessages().mid(0, _AppendSize);
+	QBENCHMARK
+	{
+		for (auto message : messages) bus.Publish(message);
+		bus.Flush();
+	}
+	QVERIFY(delivered > 0);
+}
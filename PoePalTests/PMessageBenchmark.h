@@ -0,0 +1,142 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+
+class PMessageHandler;
+
+/**
+ * Measures the message store and the models and filters on top of it. The store is filled once with a million
+ * messages of the synthetic log, which is the history a long session leaves behind.
+ */
+class PMessageBenchmark : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	/**
+	 * Fills the store.
+	 */
+	void initTestCase();
+
+	/**
+	 * Releases the store.
+	 */
+	void cleanupTestCase();
+
+	/**
+	 * Provides the channel settings of typical chat widgets.
+	 */
+	void BenchmarkChannelIndexes_data();
+
+	/**
+	 * Measures finding the messages a chat widget or filter model shows, for each of the channel settings.
+	 */
+	void BenchmarkChannelIndexes();
+
+	/**
+	 * Measures reading the messages of the store back from a snapshot, which is most of the time to startup.
+	 */
+	void BenchmarkSnapshotLoad();
+
+	/**
+	 * Measures parsing a batch of log lines into messages and releasing them again, which is where the messages
+	 * are allocated and freed.
+	 */
+	void BenchmarkReplay();
+
+	/**
+	 * Provides the export formats.
+	 */
+	void BenchmarkExport_data();
+
+	/**
+	 * Measures exporting the whole store in each format. The size of the file is logged so the throughput can be
+	 * worked out.
+	 */
+	void BenchmarkExport();
+
+	/**
+	 * Provides whether a message model and a view are on the store.
+	 */
+	void BenchmarkModelAppend_data();
+
+	/**
+	 * Measures importing a batch of newer messages, with and without a message model and a view on the store, so
+	 * the difference is what the model and the view take to insert the batch.
+	 */
+	void BenchmarkModelAppend();
+
+	/**
+	 * Measures painting a table on the message model, scrolled to the middle of the store.
+	 */
+	void BenchmarkModelPaint();
+
+	/**
+	 * Provides the channels and senders of typical filter models.
+	 */
+	void BenchmarkFilterChange_data();
+
+	/**
+	 * Measures a filter model finding its rows again after its filter changed, for each of the filters. The goal
+	 * is less than 20 ms for each of them.
+	 */
+	void BenchmarkFilterChange();
+
+	/**
+	 * Provides the number of content filters.
+	 */
+	void BenchmarkContentFilters_data();
+
+	/**
+	 * Measures importing messages into a store with a number of content filters registered, like one for each
+	 * custom chat widget. The time should grow far slower than the number of filters.
+	 */
+	void BenchmarkContentFilters();
+
+	/**
+	 * Provides the number of subscribers.
+	 */
+	void BenchmarkBusDispatch_data();
+
+	/**
+	 * Measures publishing and delivering a batch of messages to subscribers of a few kinds, like the chat widgets,
+	 * status widget and message model. Each subscriber only sees the messages it wants, so the time should grow
+	 * with the number of deliveries rather than with the number of subscribers times the number of messages.
+	 */
+	void BenchmarkBusDispatch();
+
+private:
+
+	/**
+	 * The directory holding the files written for the benchmarks.
+	 */
+	QTemporaryDir _Dir;
+
+	/**
+	 * The message handler holding the store.
+	 */
+	QScopedPointer<PMessageHandler> _Handler;
+
+	/**
+	 * The index of the next line of the synthetic log to add to the store.
+	 */
+	int _NextLine = 0;
+};
@@ -0,0 +1,162 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PMessageFilterModelTest.h"
+#include "PMessageFilterModel.h"
+#include "PMessageHandler.h"
+#include "PMessageModel.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace
+{
+	/**
+	 * Imports chat messages into a message handler.
+	 * @param[in] handler
+	 *   The message handler.
+	 * @param[in] dir
+	 *   The directory to write the import file in.
+	 * @param[in] messages
+	 *   The time of each message, in seconds after a fixed time, with the name of its channel. The contents of
+	 *   each message are its time.
+	 * @return
+	 *   true if all of the messages were imported, false otherwise.
+	 */
+	bool ImportChat(PMessageHandler &handler, const QTemporaryDir &dir, 
+		const QVector<QPair<int, QString>> &messages)
+	{
+		const QDateTime baseTime(QDate(2020, 1, 1), QTime(10, 0));
+		auto path = dir.filePath(QStringLiteral("chat.ndjson"));
+		QFile file(path);
+		if (!file.open(QIODevice::WriteOnly)) return false;
+		for (const auto &message : messages)
+		{
+			QJsonObject object{
+				{QStringLiteral("time"), baseTime.addSecs(message.first).toString(Qt::ISODateWithMs)},
+				{QStringLiteral("type"), QStringLiteral("Info")},
+				{QStringLiteral("subtype"), QStringLiteral("Chat")},
+				{QStringLiteral("channel"), message.second},
+				{QStringLiteral("sender"), QStringLiteral("Someone")},
+				{QStringLiteral("contents"), QString::number(message.first)}
+			};
+			file.write(QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+		}
+		file.close();
+		return handler.ImportMessages(path) == messages.length();
+	}
+
+	/**
+	 * Retrieves the rows of the message model the rows of the filter model map to.
+	 * @param[in] proxy
+	 *   The filter model.
+	 * @return
+	 *   The source row of each row of the filter model.
+	 */
+	QVector<int> GetSourceRows(const PMessageFilterModel &proxy)
+	{
+		QVector<int> rows;
+		for (int r = 0; r < proxy.rowCount(); ++r) rows.append(proxy.mapToSource(proxy.index(r, 0)).row());
+		return rows;
+	}
+}
+
+void PMessageFilterModelTest::TestMapping()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	PMessageHandler handler;
+	QVERIFY(ImportChat(handler, dir, {{0, "Global"}, {1, "Trade"}, {2, "Global"}, {3, "Trade"}}));
+	PMessageModel model(&handler, nullptr);
+	PMessageFilterModel proxy(nullptr);
+	proxy.setSourceModel(&model);
+	proxy.SetChannels(PMessage::Channels(PMessage::Trade));
+
+	QCOMPARE(proxy.rowCount(), 2);
+	QCOMPARE(proxy.columnCount(), 1);
+	QVERIFY(!proxy.index(0, 1).isValid());
+	QCOMPARE(GetSourceRows(proxy), QVector<int>({1, 3}));
+	QCOMPARE(proxy.mapToSource(proxy.index(1, 0)).column(), 0);
+
+	auto mapped = proxy.mapFromSource(model.index(3, 0));
+	QCOMPARE(mapped.row(), 1);
+	QCOMPARE(mapped.column(), 0);
+	QVERIFY(!proxy.mapFromSource(model.index(3, PMessageModel::BodyColumn)).isValid());
+	QVERIFY(!proxy.mapFromSource(model.index(2, 0)).isValid());
+
+	QCOMPARE(proxy.GetMessage(proxy.index(0, 0)), handler.GetMessageAt(1));
+	QCOMPARE(proxy.data(proxy.index(0, 0)).toString(), handler.GetMessageAt(1)->ToString());
+	QCOMPARE(proxy.data(proxy.index(0, 0), PMessageModel::BodyRole), 
+		model.data(model.index(1, 0), PMessageModel::BodyRole));
+}
+
+void PMessageFilterModelTest::TestMappingAfterChanges()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	PMessageHandler handler;
+	QVERIFY(ImportChat(handler, dir, {{0, "Trade"}, {2, "Global"}, {4, "Trade"}}));
+	PMessageModel model(&handler, nullptr);
+	PMessageFilterModel proxy(nullptr);
+	proxy.setSourceModel(&model);
+	proxy.SetChannels(PMessage::Channels(PMessage::Trade));
+	QSignalSpy inserted(&proxy, &QAbstractItemModel::rowsInserted);
+	QSignalSpy reset(&proxy, &QAbstractItemModel::modelReset);
+	QCOMPARE(GetSourceRows(proxy), QVector<int>({0, 2}));
+
+	// Newer messages are inserted at the end without resetting the model.
+	QVERIFY(ImportChat(handler, dir, {{5, "Global"}, {6, "Trade"}}));
+	QCOMPARE(inserted.count(), 1);
+	QCOMPARE(reset.count(), 0);
+	QCOMPARE(GetSourceRows(proxy), QVector<int>({0, 2, 4}));
+
+	// Older messages shift the rows after them.
+	QVERIFY(ImportChat(handler, dir, {{1, "Trade"}}));
+	QCOMPARE(reset.count(), 1);
+	QCOMPARE(GetSourceRows(proxy), QVector<int>({0, 1, 3, 5}));
+	for (int r = 0; r < proxy.rowCount(); ++r)
+	{
+		auto message = proxy.GetMessage(proxy.index(r, 0));
+		QCOMPARE(message->GetChannel(), PMessage::Trade);
+		QCOMPARE(proxy.mapFromSource(model.index(message->GetStoreIndex(), 0)).row(), r);
+	}
+}
+
+void PMessageFilterModelTest::TestContentFilter()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	PMessageHandler handler;
+	QVERIFY(ImportChat(handler, dir, {{0, "Trade"}, {1, "Trade"}, {3, "Trade"}}));
+	PMessageModel model(&handler, nullptr);
+	PMessageFilterModel proxy(nullptr);
+	proxy.SetFilter(QStringLiteral("3"));
+	QCOMPARE(proxy.rowCount(), 0);
+	proxy.setSourceModel(&model);
+	QCOMPARE(GetSourceRows(proxy), QVector<int>({2}));
+	proxy.SetFilter(QString());
+	QCOMPARE(GetSourceRows(proxy), QVector<int>({0, 1, 2}));
+	proxy.SetFilter(QStringLiteral("1"));
+	QCOMPARE(GetSourceRows(proxy), QVector<int>({1}));
+
+	// A model on another handler brings its own messages, which the filter is evaluated on.
+	PMessageHandler otherHandler;
+	QVERIFY(ImportChat(otherHandler, dir, {{1, "Trade"}, {2, "Trade"}, {10, "Trade"}, {11, "Trade"}}));
+	PMessageModel otherModel(&otherHandler, nullptr);
+	proxy.setSourceModel(&otherModel);
+	QCOMPARE(GetSourceRows(proxy), QVector<int>({0, 2, 3}));
+	QCOMPARE(proxy.GetMessage(proxy.index(1, 0)), otherHandler.GetMessageAt(2));
+}
@@ -0,0 +1,45 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+
+/**
+ * Tests the mapping between the filter model and the message model it filters.
+ */
+class PMessageFilterModelTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	/**
+	 * Checks that the rows of the filter model map to the accepted messages and back, that only the first
+	 * column of the message model has a counterpart, and that the single column shows the whole message line.
+	 */
+	void TestMapping();
+
+	/**
+	 * Checks that the mapping follows messages appended to the store and messages merged in among them.
+	 */
+	void TestMappingAfterChanges();
+
+	/**
+	 * Checks that the content filter is registered with the message handler of the source model, including when
+	 * the filter is set before the source model or the source model is replaced.
+	 */
+	void TestContentFilter();
+};
@@ -0,0 +1,86 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PMessageFilterTest.h"
+#include "PMessage.h"
+#include "PMessageFilter.h"
+#include <QJsonObject>
+#include <QtTest>
+
+namespace
+{
+	/**
+	 * Creates a trade request.
+	 * @param[in] item
+	 *   The item requested.
+	 * @param[in] amount
+	 *   The amount offered.
+	 * @param[in] currency
+	 *   The currency offered.
+	 * @return
+	 *   The message, which the caller owns.
+	 */
+	PMessage * CreateTradeRequest(const QString &item, double amount, const QString &currency)
+	{
+		QJsonObject trade{
+			{QStringLiteral("item"), item},
+			{QStringLiteral("amount"), amount},
+			{QStringLiteral("currency"), currency},
+			{QStringLiteral("league"), QStringLiteral("Standard")}
+		};
+		QJsonObject object{
+			{QStringLiteral("time"), QDateTime(QDate(2020, 1, 1), QTime(10, 0)).toString(Qt::ISODateWithMs)},
+			{QStringLiteral("type"), QStringLiteral("Info")},
+			{QStringLiteral("subtype"), QStringLiteral("Chat")},
+			{QStringLiteral("channel"), QStringLiteral("Whisper")},
+			{QStringLiteral("sender"), QStringLiteral("Someone")},
+			{QStringLiteral("contents"), QStringLiteral("Hi, I would like to buy your %1").arg(item)},
+			{QStringLiteral("trade"), trade}
+		};
+		return PMessage::FromJson(object, nullptr);
+	}
+}
+
+void PMessageFilterTest::TestQuotedValues()
+{
+	QScopedPointer<PMessage> tabula(CreateTradeRequest(QStringLiteral("Tabula Rasa Simple Robe"), 5.0, 
+		QStringLiteral("divine orb")));
+	QScopedPointer<PMessage> other(CreateTradeRequest(QStringLiteral("Rasa Tabula Simple Robe"), 5.0, 
+		QStringLiteral("chaos orb")));
+	QVERIFY(tabula && tabula->IsTradeRequest());
+	QVERIFY(other && other->IsTradeRequest());
+
+	auto filter = PMessageFilter::Compile(QStringLiteral("item:\"Tabula Rasa\""));
+	QVERIFY(filter.IsValid());
+	QVERIFY(filter.GetKeywords().isEmpty());
+	QVERIFY(filter.Matches(tabula.data()));
+	QVERIFY(!filter.Matches(other.data()));
+
+	filter = PMessageFilter::Compile(QStringLiteral("currency:\"Divine Orb\" item:\"tabula rasa\" price>4"));
+	QVERIFY(filter.IsValid());
+	QVERIFY(filter.GetKeywords().isEmpty());
+	QVERIFY(filter.Matches(tabula.data()));
+	QVERIFY(!filter.Matches(other.data()));
+
+	// Quoted text on its own is still one keyword.
+	filter = PMessageFilter::Compile(QStringLiteral("\"your Tabula\" item:robe"));
+	QVERIFY(filter.IsValid());
+	QCOMPARE(filter.GetKeywords(), QStringList({QStringLiteral("your tabula")}));
+
+	QString error;
+	filter = PMessageFilter::Compile(QStringLiteral("item:\"Tabula Rasa"), &error);
+	QVERIFY(!filter.IsValid());
+	QVERIFY(!error.isEmpty());
+}
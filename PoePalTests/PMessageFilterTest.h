@@ -0,0 +1,34 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+
+/**
+ * Tests compiling and matching message filters.
+ */
+class PMessageFilterTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	/**
+	 * Checks that quoted item and currency names keep their spaces, that quoted text is a single keyword, and
+	 * that a quote that isn't closed makes the expression invalid.
+	 */
+	void TestQuotedValues();
+};
@@ -0,0 +1,214 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PMessageHandlerTest.h"
+#include "PChatView.h"
+#include "PMessageHandler.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace
+{
+	/**
+	 * The time the test messages are relative to.
+	 */
+	const QDateTime _BaseTime(QDate(2020, 1, 1), QTime(10, 0));
+
+	/**
+	 * Writes log messages to an NDJSON file for importing.
+	 * @param[in] path
+	 *   The path of the file.
+	 * @param[in] seconds
+	 *   The time of each message, in seconds after the base time. The contents of each message are its time.
+	 * @return
+	 *   true if the file was written, false otherwise.
+	 */
+	bool WriteImport(const QString &path, const QVector<int> &seconds)
+	{
+		QFile file(path);
+		if (!file.open(QIODevice::WriteOnly)) return false;
+		for (int second : seconds)
+		{
+			QJsonObject object{
+				{QStringLiteral("time"), _BaseTime.addSecs(second).toString(Qt::ISODateWithMs)},
+				{QStringLiteral("type"), QStringLiteral("Info")},
+				{QStringLiteral("subtype"), QStringLiteral("Log")},
+				{QStringLiteral("contents"), QString::number(second)}
+			};
+			file.write(QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+		}
+		return true;
+	}
+
+	/**
+	 * Creates a message to import.
+	 * @param[in] second
+	 *   The time of the message, in seconds after the base time.
+	 * @param[in] subtype
+	 *   The name of the subtype of the message.
+	 * @param[in] contents
+	 *   The contents of the message.
+	 * @param[in] partner
+	 *   The player whispered to or by, or an empty string if the message isn't a whisper.
+	 * @param[in] incoming
+	 *   true if the whisper was received, false if it was sent.
+	 * @return
+	 *   The message as it is written to an NDJSON file.
+	 */
+	QJsonObject CreateMessage(int second, const QString &subtype, const QString &contents, 
+		const QString &partner = QString(), bool incoming = true)
+	{
+		QJsonObject object{
+			{QStringLiteral("time"), _BaseTime.addSecs(second).toString(Qt::ISODateWithMs)},
+			{QStringLiteral("type"), QStringLiteral("Info")},
+			{QStringLiteral("subtype"), subtype},
+			{QStringLiteral("contents"), contents}
+		};
+		if (!partner.isEmpty())
+		{
+			object.insert(QStringLiteral("channel"), QStringLiteral("Whisper"));
+			object.insert(QStringLiteral("sender"), partner);
+			object.insert(QStringLiteral("incoming"), incoming);
+		}
+		return object;
+	}
+
+	/**
+	 * Writes messages to an NDJSON file for importing.
+	 * @param[in] path
+	 *   The path of the file.
+	 * @param[in] messages
+	 *   The messages to write.
+	 * @return
+	 *   true if the file was written, false otherwise.
+	 */
+	bool WriteMessages(const QString &path, const QVector<QJsonObject> &messages)
+	{
+		QFile file(path);
+		if (!file.open(QIODevice::WriteOnly)) return false;
+		for (const auto &object : messages) file.write(QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+		return true;
+	}
+}
+
+void PMessageHandlerTest::TestImportOrder()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	PMessageHandler handler;
+	QSignalSpy appended(&handler, &PMessageHandler::MessagesAppended);
+	QSignalSpy reset(&handler, &PMessageHandler::MessagesReset);
+	QSignalSpy published(&handler, &PMessageHandler::NewMessage);
+
+	QVERIFY(WriteImport(dir.filePath("first.ndjson"), {0, 2, 4}));
+	QCOMPARE(handler.ImportMessages(dir.filePath("first.ndjson")), Q_INT64_C(3));
+	QCOMPARE(appended.count(), 1);
+	QCOMPARE(reset.count(), 0);
+
+	// Older messages go in among the loaded ones.
+	QVERIFY(WriteImport(dir.filePath("older.ndjson"), {5, 1}));
+	QCOMPARE(handler.ImportMessages(dir.filePath("older.ndjson")), Q_INT64_C(2));
+	QCOMPARE(appended.count(), 1);
+	QCOMPARE(reset.count(), 1);
+	QCOMPARE(handler.GetMessageCount(), 5);
+	const QStringList expected{"0", "1", "2", "4", "5"};
+	for (int m = 0; m < expected.length(); ++m)
+	{
+		auto message = handler.GetMessageAt(m);
+		QCOMPARE(message->GetContents(), expected.at(m));
+		QCOMPARE(message->GetStoreIndex(), m);
+	}
+	QCOMPARE(handler.GetSubtypeIndexes(PMessage::Log), QVector<int>({0, 1, 2, 3, 4}));
+	QCOMPARE(handler.FindMessageAt(_BaseTime.addSecs(1)), 1);
+	QCOMPARE(handler.FindMessageAt(_BaseTime.addSecs(3)), 3);
+	QCOMPARE(handler.FindMessageAt(_BaseTime.addSecs(10)), 5);
+
+	// Newer messages are simply appended.
+	QVERIFY(WriteImport(dir.filePath("newer.ndjson"), {6}));
+	QCOMPARE(handler.ImportMessages(dir.filePath("newer.ndjson")), Q_INT64_C(1));
+	QCOMPARE(appended.count(), 2);
+	QCOMPARE(appended.last().at(0).toInt(), 5);
+	QCOMPARE(reset.count(), 1);
+	QCOMPARE(handler.FindMessageAt(_BaseTime.addSecs(6)), 5);
+	QCOMPARE(published.count(), 0);
+}
+
+void PMessageHandlerTest::TestRenderedTextAfterImport()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	auto getText = [](PChatView &view)
+	{
+		view.SelectAll();
+		return view.GetSelectedText();
+	};
+	{
+		PMessageHandler handler;
+		QVERIFY(WriteImport(dir.filePath("first.ndjson"), {0, 2, 4}));
+		QCOMPARE(handler.ImportMessages(dir.filePath("first.ndjson")), Q_INT64_C(3));
+		PChatView before;
+		before.AppendMessage(handler.GetMessageAt(1));
+		QCOMPARE(getText(before), QStringLiteral("2"));
+
+		// The older message takes the place of the one shown, which must keep its own text.
+		QVERIFY(WriteImport(dir.filePath("older.ndjson"), {1}));
+		QCOMPARE(handler.ImportMessages(dir.filePath("older.ndjson")), Q_INT64_C(1));
+		PChatView after;
+		after.AppendMessage(handler.GetMessageAt(1));
+		after.AppendMessage(handler.GetMessageAt(2));
+		QCOMPARE(getText(after), QStringLiteral("1\n2"));
+		QCOMPARE(getText(before), QStringLiteral("2"));
+	}
+
+	// The messages of a new handler may be allocated where the deleted ones were.
+	PMessageHandler handler;
+	QVERIFY(WriteImport(dir.filePath("other.ndjson"), {7, 8, 9}));
+	QCOMPARE(handler.ImportMessages(dir.filePath("other.ndjson")), Q_INT64_C(3));
+	PChatView view;
+	for (int m = 0; m < handler.GetMessageCount(); ++m) view.AppendMessage(handler.GetMessageAt(m));
+	QCOMPARE(getText(view), QStringLiteral("7\n8\n9"));
+}
+
+void PMessageHandlerTest::TestWhisperIndexes()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	PMessageHandler handler;
+	const auto notOnline = QStringLiteral("That character is not online.");
+	QVERIFY(WriteMessages(dir.filePath("whispers.ndjson"), {
+		CreateMessage(0, "Chat", "hi", "Alice"),
+		CreateMessage(2, "Chat", "wtb", "Bob", false),
+		CreateMessage(3, "Event", notOnline),
+		CreateMessage(4, "Event", "You have entered Lioneye's Watch."),
+		CreateMessage(6, "Chat", "ty", "Alice", false)
+	}));
+	QCOMPARE(handler.ImportMessages(dir.filePath("whispers.ndjson")), Q_INT64_C(5));
+	QCOMPARE(handler.GetWhisperIndexes("Alice"), QVector<int>({0, 4}));
+	QCOMPARE(handler.GetWhisperIndexes("Bob"), QVector<int>({1, 2}));
+	QVERIFY(handler.GetWhisperIndexes("Carol").isEmpty());
+
+	// An older import moves the later messages, and the notice now follows a whisper to someone else.
+	QVERIFY(WriteMessages(dir.filePath("older.ndjson"), {
+		CreateMessage(1, "Chat", "hello", "Carol"),
+		CreateMessage(2, "Chat", "still there?", "Alice", false)
+	}));
+	QCOMPARE(handler.ImportMessages(dir.filePath("older.ndjson")), Q_INT64_C(2));
+	QCOMPARE(handler.GetWhisperIndexes("Alice"), QVector<int>({0, 3, 4, 6}));
+	QCOMPARE(handler.GetWhisperIndexes("Bob"), QVector<int>({2}));
+	QCOMPARE(handler.GetWhisperIndexes("Carol"), QVector<int>({1}));
+	QVERIFY(handler.GetMessageAt(4)->IsWhisperFailure());
+}
@@ -0,0 +1,46 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+
+/**
+ * Tests the message store of the message handler.
+ */
+class PMessageHandlerTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	/**
+	 * Checks that imported messages are merged into the store in time order, that the store indexes and the
+	 * subtype index follow, and that FindMessageAt finds them. Imports are not published as new messages.
+	 */
+	void TestImportOrder();
+
+	/**
+	 * Checks that chat views show the text of the messages they were given after older messages are imported
+	 * and the store is reordered, and after the messages of a deleted handler are replaced.
+	 */
+	void TestRenderedTextAfterImport();
+
+	/**
+	 * Checks that each whisper conversation indexes its whispers and the notices about undelivered whispers,
+	 * including after older messages are imported.
+	 */
+	void TestWhisperIndexes();
+};
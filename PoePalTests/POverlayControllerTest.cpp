@@ -0,0 +1,176 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "POverlayControllerTest.h"
+#include "POverlayBarWidget.h"
+#include "POverlayChatWidget.h"
+#include "POverlayController.h"
+#include "PSimulatedFocusSource.h"
+#include <QImage>
+#include <QSettings>
+#include <QtTest>
+
+namespace
+{
+	/**
+	 * The ID of a process other than this one.
+	 */
+	const qint64 _OtherProcessId = 4;
+}
+
+void POverlayControllerTest::init()
+{
+	QSettings settings;
+	settings.remove(QStringLiteral("Overlay"));
+}
+
+void POverlayControllerTest::TestForeground()
+{
+	POverlayController controller(nullptr);
+	auto focus = new PSimulatedFocusSource;
+	controller.SetFocusSource(focus);
+	controller.Initialize();
+	QSignalSpy activeChanged(&controller, &POverlayController::GameActiveChanged);
+	auto bar = controller.GetBarWidget();
+	auto chat = controller.GetChatWidget();
+	QVERIFY(!controller.IsGameActive());
+	QVERIFY(!bar->isVisible());
+	QVERIFY(!chat->isVisible());
+
+	// The chat is shown along with the bar while the overlay is unlocked.
+	focus->Activate(1, _OtherProcessId, true);
+	QVERIFY(controller.IsGameActive());
+	QCOMPARE(activeChanged.count(), 1);
+	QVERIFY(bar->isVisible());
+	QVERIFY(chat->isVisible());
+
+	// Moving the focus to an overlay window keeps it up.
+	focus->Activate(bar->winId(), QCoreApplication::applicationPid(), false);
+	QVERIFY(controller.IsGameActive());
+	focus->Activate(chat->winId(), QCoreApplication::applicationPid(), false);
+	QVERIFY(controller.IsGameActive());
+	QCOMPARE(activeChanged.count(), 1);
+	QVERIFY(bar->isVisible());
+	QVERIFY(chat->isVisible());
+
+	// A window of another process is not an overlay window, even with the same handle.
+	focus->Activate(bar->winId(), _OtherProcessId, false);
+	QVERIFY(!controller.IsGameActive());
+	QCOMPARE(activeChanged.count(), 2);
+	QVERIFY(!bar->isVisible());
+	QVERIFY(!chat->isVisible());
+
+	focus->Activate(1, _OtherProcessId, true);
+	QVERIFY(controller.IsGameActive());
+	focus->Activate(2, _OtherProcessId, false);
+	QVERIFY(!controller.IsGameActive());
+	QCOMPARE(activeChanged.count(), 4);
+	QVERIFY(!bar->isVisible());
+	QVERIFY(!chat->isVisible());
+}
+
+void POverlayControllerTest::TestPendingLock()
+{
+	POverlayController controller(nullptr);
+	auto focus = new PSimulatedFocusSource;
+	controller.SetFocusSource(focus);
+	controller.Initialize();
+	QSignalSpy locked(&controller, &POverlayController::Locked);
+	QCOMPARE(controller.GetLockState(), POverlayController::OverlayUnlocked);
+
+	// Nothing can be locked while the overlay is down.
+	controller.Lock();
+	QCOMPARE(controller.GetLockState(), POverlayController::OverlayLockPending);
+	QTest::qWait(20);
+	QCOMPARE(controller.GetLockState(), POverlayController::OverlayLockPending);
+	QCOMPARE(locked.count(), 0);
+
+	// Once the game is up, only the bar is shown and the lock is applied after the windows are shown.
+	focus->Activate(1, _OtherProcessId, true);
+	QVERIFY(controller.GetBarWidget()->isVisible());
+	QVERIFY(!controller.GetChatWidget()->isVisible());
+	QTRY_COMPARE(controller.GetLockState(), POverlayController::OverlayLocked);
+	QCOMPARE(locked.count(), 1);
+
+	// The chat is then only shown on request.
+	controller.ShowChat();
+	QVERIFY(controller.GetChatWidget()->isVisible());
+	focus->Activate(2, _OtherProcessId, false);
+	QVERIFY(!controller.GetChatWidget()->isVisible());
+	QCOMPARE(controller.GetLockState(), POverlayController::OverlayLocked);
+}
+
+void POverlayControllerTest::BenchmarkPaint_data()
+{
+	QTest::addColumn<bool>("chat");
+	QTest::addColumn<bool>("locked");
+	QTest::newRow("bar") << false << false;
+	QTest::newRow("bar+locked") << false << true;
+	QTest::newRow("chat") << true << false;
+	QTest::newRow("chat+locked") << true << true;
+}
+
+void POverlayControllerTest::BenchmarkPaint()
+{
+	QFETCH(bool, chat);
+	QFETCH(bool, locked);
+	POverlayController controller(nullptr);
+	auto focus = new PSimulatedFocusSource;
+	controller.SetFocusSource(focus);
+	controller.Initialize();
+	focus->Activate(1, _OtherProcessId, true);
+	controller.ShowChat();
+	if (locked)
+	{
+		controller.Lock();
+		QTRY_COMPARE(controller.GetLockState(), POverlayController::OverlayLocked);
+	}
+	QWidget* widget = chat ? static_cast<QWidget*>(controller.GetChatWidget()) : controller.GetBarWidget();
+	QVERIFY(widget->isVisible());
+	QImage image(widget->size(), QImage::Format_ARGB32_Premultiplied);
+	QBENCHMARK
+	{
+		image.fill(Qt::transparent);
+		widget->render(&image);
+	}
+}
+
+void POverlayControllerTest::BenchmarkStartup()
+{
+	QBENCHMARK
+	{
+		POverlayController controller(nullptr);
+		controller.SetFocusSource(new PSimulatedFocusSource);
+		controller.Initialize();
+	}
+}
+
+void POverlayControllerTest::BenchmarkRetheme()
+{
+	POverlayController controller(nullptr);
+	auto focus = new PSimulatedFocusSource;
+	controller.SetFocusSource(focus);
+	controller.Initialize();
+	focus->Activate(1, _OtherProcessId, true);
+	controller.ShowChat();
+	// The controller ignores the stylesheet it already has, so switch between two that differ in a comment.
+	QStringList styleSheets{controller.GetStyleSheet(), controller.GetStyleSheet() + QStringLiteral("\n/**/")};
+	int next = 1;
+	QBENCHMARK
+	{
+		controller.SetStyleSheet(styleSheets.at(next));
+		next = 1 - next;
+	}
+}
@@ -0,0 +1,67 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+
+/**
+ * Tests how the overlay controller follows the foreground window, driven by a simulated focus source, and measures
+ * the overlay windows.
+ */
+class POverlayControllerTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	/**
+	 * Clears the overlay settings so every test starts unlocked with the chat hidden.
+	 */
+	void init();
+
+	/**
+	 * Checks that the overlay is up while the game or one of the overlay windows is in the foreground, and that
+	 * it is hidden for any other window, including one of another process with the same handle.
+	 */
+	void TestForeground();
+
+	/**
+	 * Checks that a lock requested while the game is in the background waits for the game, and is applied once
+	 * the game is in the foreground again.
+	 */
+	void TestPendingLock();
+
+	/**
+	 * Provides the overlay window to paint and whether the overlay is locked.
+	 */
+	void BenchmarkPaint_data();
+
+	/**
+	 * Measures painting an overlay window offscreen while the game is in the foreground, which is what the overlay
+	 * takes from each frame of the game.
+	 */
+	void BenchmarkPaint();
+
+	/**
+	 * Measures creating the overlay, which parses the overlay stylesheet and creates the overlay windows.
+	 */
+	void BenchmarkStartup();
+
+	/**
+	 * Measures changing the stylesheet of the overlay while its windows are up.
+	 */
+	void BenchmarkRetheme();
+};
@@ -0,0 +1,138 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "POverlayLayoutTest.h"
+#include "POverlayLayout.h"
+#include <QSettings>
+#include <QtTest>
+
+namespace
+{
+	/**
+	 * Builds the geometry of a screen.
+	 * @param[in] geometry
+	 *   The geometry of the screen.
+	 * @param[in] devicePixelRatio
+	 *   The ratio between physical and device-independent pixels.
+	 * @return
+	 *   The screen.
+	 */
+	POverlayLayout::ScreenInfo MakeScreen(const QRect &geometry, qreal devicePixelRatio = 1.0)
+	{
+		POverlayLayout::ScreenInfo screen;
+		screen._Geometry = geometry;
+		screen._DevicePixelRatio = devicePixelRatio;
+		return screen;
+	}
+
+	/**
+	 * Builds a configuration of a 1920x1080 primary screen with a 2560x1440 screen to the right of it.
+	 * @return
+	 *   The screens.
+	 */
+	QVector<POverlayLayout::ScreenInfo> MakeDualScreens()
+	{
+		return {MakeScreen(QRect(0, 0, 1920, 1080)), MakeScreen(QRect(1920, 0, 2560, 1440))};
+	}
+}
+
+void POverlayLayoutTest::init()
+{
+	QSettings settings;
+	settings.remove(QStringLiteral("Overlay/Layouts"));
+}
+
+void POverlayLayoutTest::TestPlaceWindow()
+{
+	POverlayLayout layout(nullptr);
+	layout.SetScreens(MakeDualScreens());
+
+	// Without a stored position, the window stays where it is if it fits.
+	QCOMPARE(layout.PlaceWindow(QStringLiteral("bar"), QRect(100, 100, 300, 40)), QRect(100, 100, 300, 40));
+	// Otherwise it is moved onto the screen holding its center.
+	QCOMPARE(layout.PlaceWindow(QStringLiteral("bar"), QRect(1700, 1060, 300, 40)), QRect(1620, 1040, 300, 40));
+	QCOMPARE(layout.PlaceWindow(QStringLiteral("bar"), QRect(1800, 1420, 300, 40)), QRect(1920, 1400, 300, 40));
+	// A window entirely off of the screens goes to the screen it overlaps most, or the primary one.
+	QCOMPARE(layout.PlaceWindow(QStringLiteral("bar"), QRect(-500, -500, 300, 40)), QRect(0, 0, 300, 40));
+
+	// A stored position keeps the distance to the nearest corner of the screen.
+	layout.StorePosition(QStringLiteral("chat"), QRect(4000, 1000, 400, 300));
+	QCOMPARE(layout.PlaceWindow(QStringLiteral("chat"), QRect(0, 0, 400, 300)), QRect(4000, 1000, 400, 300));
+	QCOMPARE(layout.PlaceWindow(QStringLiteral("chat"), QRect(0, 0, 200, 100)), QRect(4200, 1200, 200, 100));
+	// A window grown larger than the screen is aligned with the top left corner of the screen.
+	QCOMPARE(layout.PlaceWindow(QStringLiteral("chat"), QRect(0, 0, 3000, 2000)), QRect(1920, 0, 3000, 2000));
+}
+
+void POverlayLayoutTest::TestMoveBy()
+{
+	POverlayLayout layout(nullptr);
+	layout.SetScreens(MakeDualScreens());
+
+	QCOMPARE(layout.MoveBy(QRect(100, 100, 300, 40), QPoint(5, -5)), QRect(105, 95, 300, 40));
+	QCOMPARE(layout.MoveBy(QRect(2, 2, 300, 40), QPoint(-5, -5)), QRect(0, 0, 300, 40));
+	QCOMPARE(layout.MoveBy(QRect(1600, 1030, 300, 40), QPoint(5, 5)), QRect(1605, 1035, 300, 40));
+	QCOMPARE(layout.MoveBy(QRect(1618, 1038, 300, 40), QPoint(5, 5)), QRect(1620, 1040, 300, 40));
+	// The edge shared with the other screen stops the window as well, from either side.
+	QCOMPARE(layout.MoveBy(QRect(1620, 500, 300, 40), QPoint(1, 0)), QRect(1620, 500, 300, 40));
+	QCOMPARE(layout.MoveBy(QRect(1920, 500, 300, 40), QPoint(-1, 0)), QRect(1920, 500, 300, 40));
+	// The taller screen lets the window move below the bottom of the primary one.
+	QCOMPARE(layout.MoveBy(QRect(2000, 1038, 300, 40), QPoint(0, 5)), QRect(2000, 1043, 300, 40));
+	QCOMPARE(layout.MoveBy(QRect(4178, 1398, 300, 40), QPoint(5, 5)), QRect(4180, 1400, 300, 40));
+
+	// Without any screens there is nothing to stay on.
+	layout.SetScreens({});
+	QCOMPARE(layout.MoveBy(QRect(-2, -2, 300, 40), QPoint(-5, -5)), QRect(-7, -7, 300, 40));
+}
+
+void POverlayLayoutTest::TestStorePosition()
+{
+	const QVector<POverlayLayout::ScreenInfo> single = {MakeScreen(QRect(0, 0, 1920, 1080))};
+	const QVector<POverlayLayout::ScreenInfo> scaled = {MakeScreen(QRect(0, 0, 1920, 1080), 1.5)};
+	const auto dual = MakeDualScreens();
+	const QRect current(50, 50, 300, 40);
+	{
+		POverlayLayout layout(nullptr);
+		QSignalSpy changed(&layout, &POverlayLayout::ScreensChanged);
+		layout.SetScreens(single);
+		QCOMPARE(changed.count(), 1);
+		QCOMPARE(layout.GetConfigurationKey(), QStringLiteral("1920x1080+0+0@1"));
+		layout.StorePosition(QStringLiteral("bar"), QRect(1600, 1000, 300, 40));
+		layout.SetScreens(dual);
+		QCOMPARE(layout.GetConfigurationKey(), QStringLiteral("1920x1080+0+0@1_2560x1440+1920+0@1"));
+		layout.StorePosition(QStringLiteral("bar"), QRect(3000, 10, 300, 40));
+		layout.SetScreens(scaled);
+		QCOMPARE(layout.GetConfigurationKey(), QStringLiteral("1920x1080+0+0@1.5"));
+		QCOMPARE(layout.PlaceWindow(QStringLiteral("bar"), current), current);
+		layout.StorePosition(QStringLiteral("bar"), QRect(10, 1000, 300, 40));
+
+		layout.SetScreens(single);
+		QCOMPARE(layout.PlaceWindow(QStringLiteral("bar"), current), QRect(1600, 1000, 300, 40));
+		layout.SetScreens(dual);
+		QCOMPARE(layout.PlaceWindow(QStringLiteral("bar"), current), QRect(3000, 10, 300, 40));
+		QCOMPARE(layout.PlaceWindow(QStringLiteral("chat"), current), current);
+	}
+
+	// The positions are saved when the layout is destroyed and loaded by the next one.
+	POverlayLayout layout(nullptr);
+	layout.SetScreens(single);
+	QCOMPARE(layout.PlaceWindow(QStringLiteral("bar"), current), QRect(1600, 1000, 300, 40));
+	layout.SetScreens(dual);
+	QCOMPARE(layout.PlaceWindow(QStringLiteral("bar"), current), QRect(3000, 10, 300, 40));
+	layout.SetScreens(scaled);
+	QCOMPARE(layout.PlaceWindow(QStringLiteral("bar"), current), QRect(10, 1000, 300, 40));
+	// A screen configuration without any stored positions leaves the window where it is.
+	layout.SetScreens({MakeScreen(QRect(0, 0, 2560, 1440))});
+	QCOMPARE(layout.PlaceWindow(QStringLiteral("bar"), current), current);
+}
@@ -0,0 +1,51 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+
+/**
+ * Tests the placement of the overlay windows on screen configurations set up by hand, so no monitors are needed.
+ */
+class POverlayLayoutTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	/**
+	 * Clears the stored positions so every test starts without any.
+	 */
+	void init();
+
+	/**
+	 * Checks that a window without a stored position is moved onto the screen it is mostly on, and that a stored
+	 * position keeps the window at the same distance from its corner when the window changes size.
+	 */
+	void TestPlaceWindow();
+
+	/**
+	 * Checks that moving a window stops at the edges of the screen it started on, including the edges shared
+	 * with another screen.
+	 */
+	void TestMoveBy();
+
+	/**
+	 * Checks that the positions are stored separately for every screen configuration, including ones that only
+	 * differ by scale factor, and that they survive being saved and loaded again.
+	 */
+	void TestStorePosition();
+};
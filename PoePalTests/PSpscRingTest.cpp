@@ -0,0 +1,137 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PSpscRingTest.h"
+#include "PSpscRing.h"
+#include <QThread>
+#include <QtTest>
+#include <memory>
+
+namespace
+{
+	/**
+	 * The data handed over in the concurrent tests. It is written by the producer before the push and read by
+	 * the consumer after the pop.
+	 */
+	struct Payload
+	{
+		/**
+		 * The position of the item in the sequence.
+		 */
+		quint64 _Sequence = 0;
+
+		/**
+		 * A value derived from the sequence, to tell a torn or stale read from a correct one.
+		 */
+		quint64 _Check = 0;
+	};
+
+	/**
+	 * Derives the check value of a payload from its sequence.
+	 * @param[in] sequence
+	 *   The position of the item in the sequence.
+	 * @return
+	 *   The check value.
+	 */
+	quint64 MakeCheck(quint64 sequence)
+	{
+		return sequence * Q_UINT64_C(0x9e3779b97f4a7c15) ^ Q_UINT64_C(0x5bd1e995);
+	}
+
+	/**
+	 * Pushes a number of payloads into a ring from a new thread and pops them on the calling thread.
+	 * @param[in] ring
+	 *   The ring to hand the payloads over.
+	 * @param[in] count
+	 *   The number of payloads.
+	 * @return
+	 *   The number of payloads that came out intact and in order.
+	 */
+	quint64 HandOff(PSpscRing<Payload *> &ring, quint64 count)
+	{
+		std::unique_ptr<QThread> producer(QThread::create([&ring, count]() {
+			for (quint64 s = 0; s < count; ++s)
+			{
+				auto payload = new Payload;
+				payload->_Sequence = s;
+				payload->_Check = MakeCheck(s);
+				while (!ring.TryPush(payload)) QThread::yieldCurrentThread();
+			}
+		}));
+		producer->start();
+		quint64 intact = 0;
+		for (quint64 s = 0; s < count; ++s)
+		{
+			Payload *payload = nullptr;
+			while (!ring.TryPop(payload)) QThread::yieldCurrentThread();
+			if (payload->_Sequence == s && payload->_Check == MakeCheck(s)) ++intact;
+			delete payload;
+		}
+		producer->wait();
+		return intact;
+	}
+}
+
+void PSpscRingTest::TestPushPop()
+{
+	PSpscRing<int> ring(5, 4);
+	// The capacity is rounded up to a power of two.
+	int value = 0;
+	for (int round = 0; round < 5; ++round)
+	{
+		for (int i = 0; i < 8; ++i) QVERIFY(ring.TryPush(round * 8 + i));
+		QVERIFY(!ring.TryPush(-1));
+		QCOMPARE(ring.GetSize(), 8);
+		for (int i = 0; i < 8; ++i)
+		{
+			QVERIFY(ring.TryPop(value));
+			QCOMPARE(value, round * 8 + i);
+		}
+		QVERIFY(!ring.TryPop(value));
+		QCOMPARE(ring.GetSize(), 0);
+	}
+}
+
+void PSpscRingTest::TestDrainRequest()
+{
+	PSpscRing<int> ring(8, 2);
+	ring.TryPush(1);
+	ring.TryPush(2);
+	QVERIFY(!ring.IsAboveHighWater());
+	ring.TryPush(3);
+	QVERIFY(ring.IsAboveHighWater());
+	QVERIFY(ring.RequestDrain());
+	QVERIFY(!ring.RequestDrain());
+	ring.ClearDrainRequest();
+	QVERIFY(ring.RequestDrain());
+}
+
+void PSpscRingTest::TestConcurrentHandoff()
+{
+	const quint64 count = 1000000;
+	PSpscRing<Payload *> ring(16, 8);
+	QCOMPARE(HandOff(ring, count), count);
+	QCOMPARE(ring.GetSize(), 0);
+}
+
+void PSpscRingTest::BenchmarkHandoff()
+{
+	const quint64 count = 100000;
+	PSpscRing<Payload *> ring(4096, 3072);
+	QBENCHMARK
+	{
+		QCOMPARE(HandOff(ring, count), count);
+	}
+}
@@ -0,0 +1,53 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+
+/**
+ * Tests the ring that hands parsed messages from the log reader thread to the GUI thread.
+ * The concurrent tests are meant to also be run in a ThreadSanitizer build (-fsanitize=thread with clang or
+ * gcc). They hand over pointers to data written just before the push, so a missing release or acquire shows up
+ * as a race on that data, not only as a wrong value.
+ */
+class PSpscRingTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+
+	/**
+	 * Checks that items come out in the order they went in, across the wrap of the positions, and that a full
+	 * ring refuses more items.
+	 */
+	void TestPushPop();
+
+	/**
+	 * Checks the high water mark and that only the first drain request is reported until it is cleared.
+	 */
+	void TestDrainRequest();
+
+	/**
+	 * Hands a large number of items from a producer thread to a consumer thread through a small ring, so both
+	 * sides keep running into a full or empty ring, and checks that nothing is lost, duplicated or reordered.
+	 */
+	void TestConcurrentHandoff();
+
+	/**
+	 * Measures handing items from a producer thread to the consumer thread.
+	 */
+	void BenchmarkHandoff();
+};
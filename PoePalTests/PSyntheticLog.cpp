@@ -0,0 +1,116 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PSyntheticLog.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace
+{
+	/**
+	 * The number of sellers in trade chat. Each one reposts the same offer whenever it comes around again, which
+	 * is about every 30 seconds.
+	 */
+	const int _SellerCount = 150;
+
+	/**
+	 * The items offered in trade chat.
+	 */
+	const QStringList _Items{
+		QStringLiteral("Tabula Rasa"), QStringLiteral("Headhunter"), QStringLiteral("Goldrim"),
+		QStringLiteral("Wanderlust"), QStringLiteral("Lifesprig"), QStringLiteral("Blackheart"),
+		QStringLiteral("Karui Ward"), QStringLiteral("Atziri's Foible")
+	};
+}
+
+const QDateTime PSyntheticLog::BaseTime(QDate(2020, 1, 1), QTime(0, 0));
+
+QString PSyntheticLog::MakeLine(int index)
+{
+	int kind = index % 100;
+	if (kind < 55)
+	{
+		int seller = (index * 7) % _SellerCount;
+		return MakeChatLine(index, PMessage::Trade, QStringLiteral("Seller%1").arg(seller), 
+			QStringLiteral("WTS %1 for %2 chaos, PM me").arg(_Items.at(seller % _Items.length())).arg(seller));
+	}
+	if (kind < 90)
+	{
+		return MakeChatLine(index, PMessage::Global, QStringLiteral("Chatter%1").arg(index % 997),
+			QStringLiteral("anyone up for a map %1?").arg(index));
+	}
+	if (kind < 93) return MakeChatLine(index, PMessage::Local, QStringLiteral("Local%1").arg(index % 31), 
+		QStringLiteral("hi"));
+	if (kind < 95) return MakeChatLine(index, PMessage::Party, QStringLiteral("Friend%1").arg(index % 5), 
+		QStringLiteral("portal up"));
+	if (kind < 96) return MakeChatLine(index, PMessage::Guild, QStringLiteral("Member%1").arg(index % 17), 
+		QStringLiteral("gg"));
+	if (kind < 98)
+	{
+		bool incoming = kind == 96;
+		auto item = _Items.at((index / 100) % _Items.length());
+		auto contents = incoming ? QStringLiteral("Hi, I would like to buy your %1 listed for 5 chaos in Standard "
+			"(stash tab \"~price\"; position: left 3, top 7)").arg(item) : QStringLiteral("sure, invite sent");
+		return MakeChatLine(index, PMessage::Whisper, QStringLiteral("Buyer%1").arg((index / 100) % 50), contents,
+			incoming);
+	}
+	return MakeChatLine(index, PMessage::InvalidChannel, QString(), 
+		QStringLiteral("Chatter%1 has joined the area.").arg(index % 997));
+}
+
+QString PSyntheticLog::MakeChatLine(int index, PMessage::Channel channel, const QString &sender, 
+	const QString &contents, bool incoming /*= true*/)
+{
+	QString text;
+	// Local chat has no prefix, and events have neither a prefix nor a sender.
+	if (channel != PMessage::InvalidChannel && channel != PMessage::Local)
+	{
+		text += PMessage::GetPrefixFromChannel(channel);
+	}
+	if (channel == PMessage::Whisper) text += incoming ? QStringLiteral("From ") : QStringLiteral("To ");
+	if (channel == PMessage::Guild) text += QStringLiteral("<GLD> ");
+	text += sender + QStringLiteral(": ") + contents;
+	return QStringLiteral("%1 %2 %3 [INFO Client 1024] %4")
+		.arg(BaseTime.addSecs(index / 10).toString(QStringLiteral("yyyy/MM/dd HH:mm:ss")))
+		.arg(index)
+		.arg(index % 4096, 0, 16)
+		.arg(text);
+}
+
+QVector<PMessage *> PSyntheticLog::Parse(const QStringList &lines, QObject *parent)
+{
+	QVector<PMessage *> messages;
+	messages.reserve(lines.length());
+	for (const auto &line : lines)
+	{
+		auto message = PMessage::FromString(line, parent);
+		if (message) messages.append(message);
+	}
+	return messages;
+}
+
+bool PSyntheticLog::WriteImport(const QString &path, int first, int count)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly)) return false;
+	for (int i = first; i < first + count; ++i)
+	{
+		QScopedPointer<PMessage> message(PMessage::FromString(MakeLine(i), nullptr));
+		if (!message) return false;
+		file.write(QJsonDocument(message->ToJson()).toJson(QJsonDocument::Compact) + '\n');
+	}
+	return true;
+}
@@ -0,0 +1,87 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "PMessage.h"
+#include <QDateTime>
+#include <QVector>
+
+/**
+ * Builds the lines of a synthetic game log for the benchmarks. The mix of lines follows a busy league: trade and
+ * global chat make up 90% of it, the same sellers repost the same offers within a minute, and the rest is spread
+ * over the other channels, whispers and events. Line n is always the same and lines are written ten per second,
+ * so any range of lines can be generated on its own and is newer than the lines before it.
+ */
+class PSyntheticLog
+{
+public:
+
+	/**
+	 * The time of the first line.
+	 */
+	static const QDateTime BaseTime;
+
+	/**
+	 * Builds a line of the mix.
+	 * @param[in] index
+	 *   The index of the line.
+	 * @return
+	 *   The line, as written to Client.txt.
+	 */
+	static QString MakeLine(int index);
+
+	/**
+	 * Builds a chat line.
+	 * @param[in] index
+	 *   The index of the line, which gives its time.
+	 * @param[in] channel
+	 *   The channel of the message.
+	 * @param[in] sender
+	 *   The player who sent the message or, for an outgoing whisper, the player it was sent to.
+	 * @param[in] contents
+	 *   The contents of the message.
+	 * @param[in] incoming
+	 *   true if a whisper was received, false if it was sent.
+	 * @return
+	 *   The line, as written to Client.txt.
+	 */
+	static QString MakeChatLine(int index, PMessage::Channel channel, const QString &sender, 
+		const QString &contents, bool incoming = true);
+
+	/**
+	 * Parses lines into messages.
+	 * @param[in] lines
+	 *   The lines.
+	 * @param[in] parent
+	 *   The parent of the messages.
+	 * @return
+	 *   The messages.
+	 */
+	static QVector<PMessage *> Parse(const QStringList &lines, QObject *parent);
+
+	/**
+	 * Writes a range of lines of the mix to an NDJSON file for PMessageHandler::ImportMessages.
+	 * @param[in] path
+	 *   The path of the file.
+	 * @param[in] first
+	 *   The index of the first line.
+	 * @param[in] count
+	 *   The number of lines.
+	 * @return
+	 *   true if the file was written, false otherwise.
+	 */
+	static bool WriteImport(const QString &path, int first, int count);
+};
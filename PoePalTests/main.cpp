@@ -0,0 +1,70 @@
+/**
+ * PoePal - A companion application to Path of Exile.
+ * Copyright (C) 2019 Phillip Doup (https://github.com/douppc)
+ *
+ * PoePal is free software: you can redistribute it and/or modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation, either version 3 of the License, or (at your option) 
+ * any later version.
+ *
+ * PoePal is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the 
+ * implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with PeoPal.  If not, see 
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "PApplication.h"
+#include "PChatBenchmark.h"
+#include "PCommandQueueTest.h"
+#include "PCommandScriptTest.h"
+#include "PCommandTrackerTest.h"
+#include "PKeyChordEngineTest.h"
+#include "PMessageBenchmark.h"
+#include "PMessageFilterModelTest.h"
+#include "PMessageFilterTest.h"
+#include "PMessageHandlerTest.h"
+#include "POverlayControllerTest.h"
+#include "POverlayLayoutTest.h"
+#include "PSpscRingTest.h"
+#include <QStandardPaths>
+#include <QtTest>
+
+/**
+ * Runs every test class. The arguments are passed to each of them, so QtTest options like -o or -functions work
+ * as usual, and the exit code is non-zero if any of them failed.
+ */
+int main(int argc, char *argv[])
+{
+	PApplication app(argc, argv);
+	// Keep the settings and snapshots the tests write away from the user's.
+	app.setOrganizationName(QStringLiteral("PoePalTests"));
+	QStandardPaths::setTestModeEnabled(true);
+	// The widgets look up the application's services, but the tests create the windows they need themselves.
+	app.InitServices();
+	int failed = 0;
+	PSpscRingTest ringTest;
+	failed += QTest::qExec(&ringTest, argc, argv);
+	PCommandQueueTest queueTest;
+	failed += QTest::qExec(&queueTest, argc, argv);
+	PCommandScriptTest scriptTest;
+	failed += QTest::qExec(&scriptTest, argc, argv);
+	PCommandTrackerTest trackerTest;
+	failed += QTest::qExec(&trackerTest, argc, argv);
+	PMessageHandlerTest handlerTest;
+	failed += QTest::qExec(&handlerTest, argc, argv);
+	PKeyChordEngineTest chordTest;
+	failed += QTest::qExec(&chordTest, argc, argv);
+	PMessageFilterModelTest filterModelTest;
+	failed += QTest::qExec(&filterModelTest, argc, argv);
+	PMessageFilterTest filterTest;
+	failed += QTest::qExec(&filterTest, argc, argv);
+	POverlayControllerTest overlayTest;
+	failed += QTest::qExec(&overlayTest, argc, argv);
+	POverlayLayoutTest layoutTest;
+	failed += QTest::qExec(&layoutTest, argc, argv);
+	PMessageBenchmark messageBenchmark;
+	failed += QTest::qExec(&messageBenchmark, argc, argv);
+	PChatBenchmark chatBenchmark;
+	failed += QTest::qExec(&chatBenchmark, argc, argv);
+	return failed;
+}